@@ -0,0 +1,344 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2008-2020 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+// Headless replay of a recording made with nv::cloth::ClothRecorder.
+// Simulates every recorded frame on the CPU factory and prints per frame and per stage timings.
+// The solver stages are measured with a profiler callback that sums the time of each profile zone,
+// they are printed after every frame and averaged at the end unless -csv is given.
+//
+// usage: NvClothReplay <recording> [-csv] [-frames <count>] [-repeat <count>]
+
+#include <NvCloth/Callbacks.h>
+#include <NvCloth/Factory.h>
+#include <NvClothExt/ClothRecorder.h>
+#include <foundation/PxAllocatorCallback.h>
+#include <foundation/PxErrorCallback.h>
+#include <foundation/PxIO.h>
+#include <foundation/PxProfiler.h>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace
+{
+class Allocator : public physx::PxAllocatorCallback
+{
+  public:
+	virtual void* allocate(size_t size, const char*, const char*, int)
+	{
+		void* ptr;
+		if (posix_memalign(&ptr, 16, size))
+			ptr = 0;
+		return ptr;
+	}
+	virtual void deallocate(void* ptr)
+	{
+		free(ptr);
+	}
+};
+
+class ErrorCallback : public physx::PxErrorCallback
+{
+  public:
+	virtual void reportError(physx::PxErrorCode::Enum code, const char* message, const char* file, int line)
+	{
+		fprintf(stderr, "NvCloth error %d: %s (%s:%d)\n", int(code), message, file, line);
+	}
+};
+
+class AssertHandler : public nv::cloth::PxAssertHandler
+{
+  public:
+	virtual void operator()(const char* exp, const char* file, int line, bool& ignore)
+	{
+		fprintf(stderr, "NV_CLOTH_ASSERT(%s) from file:%s:%d Failed\n", exp, file, line);
+		ignore = true;
+	}
+};
+
+class FileInputStream : public physx::PxInputStream
+{
+  public:
+	FileInputStream(FILE* file) : mFile(file)
+	{
+	}
+	virtual uint32_t read(void* dest, uint32_t count)
+	{
+		return uint32_t(fread(dest, 1, count, mFile));
+	}
+
+  private:
+	FILE* mFile;
+};
+
+// sums the time spent in each NV_CLOTH_PROFILE_ZONE over a frame and over the whole replay
+// zones nest, e.g. computeBounds runs inside collideParticles, so the stages overlap
+// the replay simulates on a single thread, so the open zones form a stack
+class ZoneProfiler : public physx::PxProfilerCallback
+{
+	typedef std::chrono::high_resolution_clock Clock;
+
+  public:
+	ZoneProfiler() : mNumZones(0), mNumOpenZones(0), mNumFrames(0)
+	{
+	}
+
+	virtual void* zoneStart(const char* eventName, bool detached, uint64_t)
+	{
+		if (mNumOpenZones < sMaxOpenZones)
+		{
+			OpenZone& zone = mOpenZones[mNumOpenZones++];
+			zone.mName = eventName;
+			zone.mDetached = detached;
+			zone.mStart = Clock::now();
+		}
+		return nullptr;
+	}
+
+	virtual void zoneEnd(void*, const char* eventName, bool detached, uint64_t)
+	{
+		Clock::time_point end = Clock::now();
+
+		// innermost open zone of that name, cross thread zones like SwSolver::simulate don't nest
+		for (uint32_t i = mNumOpenZones; i--;)
+		{
+			if (mOpenZones[i].mName != eventName || mOpenZones[i].mDetached != detached)
+				continue;
+
+			if (Zone* zone = findZone(eventName))
+				zone->mFrameMs += std::chrono::duration<double, std::milli>(end - mOpenZones[i].mStart).count();
+
+			for (--mNumOpenZones; i < mNumOpenZones; ++i)
+				mOpenZones[i] = mOpenZones[i + 1];
+			return;
+		}
+	}
+
+	// prints the zones of the last frame and adds them to the totals
+	void endFrame(bool print)
+	{
+		if (print)
+			printf("      ");
+		for (uint32_t i = 0; i < mNumZones; ++i)
+		{
+			if (print && mZones[i].mFrameMs > 0.0)
+				printf("  %s %.3f", getShortName(mZones[i].mName), mZones[i].mFrameMs);
+			mZones[i].mTotalMs += mZones[i].mFrameMs;
+			mZones[i].mFrameMs = 0.0;
+		}
+		if (print)
+			printf(" ms\n");
+		++mNumFrames;
+	}
+
+	void printAverages() const
+	{
+		if (!mNumFrames || !mNumZones)
+			return;
+
+		printf("avg per profile zone (zones nest, so they overlap):\n");
+		for (uint32_t i = 0; i < mNumZones; ++i)
+			printf("  %-52s %8.3f ms\n", mZones[i].mName, mZones[i].mTotalMs / mNumFrames);
+	}
+
+  private:
+	struct Zone
+	{
+		const char* mName;
+		double mFrameMs;
+		double mTotalMs;
+	};
+
+	struct OpenZone
+	{
+		const char* mName;
+		bool mDetached;
+		Clock::time_point mStart;
+	};
+
+	Zone* findZone(const char* name)
+	{
+		for (uint32_t i = 0; i < mNumZones; ++i)
+			if (mZones[i].mName == name || !strcmp(mZones[i].mName, name))
+				return mZones + i;
+
+		if (mNumZones == sMaxZones)
+			return nullptr;
+
+		Zone& zone = mZones[mNumZones++];
+		zone.mName = name;
+		zone.mFrameMs = zone.mTotalMs = 0.0;
+		return &zone;
+	}
+
+	// "cloth::SwSolverKernel::solveFabric" -> "solveFabric"
+	static const char* getShortName(const char* name)
+	{
+		for (const char* it = name; *it; ++it)
+			if (it[0] == ':' && it[1] == ':')
+				name = it + 2;
+		return name;
+	}
+
+	static const uint32_t sMaxZones = 64;
+	static const uint32_t sMaxOpenZones = 32;
+
+	Zone mZones[sMaxZones];
+	uint32_t mNumZones;
+	OpenZone mOpenZones[sMaxOpenZones];
+	uint32_t mNumOpenZones;
+	uint32_t mNumFrames;
+};
+
+struct StageTotals
+{
+	StageTotals() : mNumFrames(0), mLoadMs(0.0), mBeginSimulationMs(0.0), mSimulateChunksMs(0.0), mEndSimulationMs(0.0),
+	  mMinFrameMs(1e30), mMaxFrameMs(0.0)
+	{
+	}
+
+	void add(const nv::cloth::ClothReplayTimings& timings)
+	{
+		double frameMs = timings.mBeginSimulationMs + timings.mSimulateChunksMs + timings.mEndSimulationMs;
+		++mNumFrames;
+		mLoadMs += timings.mLoadMs;
+		mBeginSimulationMs += timings.mBeginSimulationMs;
+		mSimulateChunksMs += timings.mSimulateChunksMs;
+		mEndSimulationMs += timings.mEndSimulationMs;
+		mMinFrameMs = frameMs < mMinFrameMs ? frameMs : mMinFrameMs;
+		mMaxFrameMs = frameMs > mMaxFrameMs ? frameMs : mMaxFrameMs;
+	}
+
+	uint32_t mNumFrames;
+	double mLoadMs;
+	double mBeginSimulationMs;
+	double mSimulateChunksMs;
+	double mEndSimulationMs;
+	double mMinFrameMs;
+	double mMaxFrameMs;
+};
+
+// replays the whole recording once, returns false if it is invalid
+bool replay(nv::cloth::Factory* factory, const char* path, bool csv, uint32_t maxFrames, StageTotals& totals,
+            ZoneProfiler& profiler)
+{
+	FILE* file = fopen(path, "rb");
+	if (!file)
+	{
+		fprintf(stderr, "Can't open %s\n", path);
+		return false;
+	}
+
+	FileInputStream stream(file);
+	nv::cloth::ClothReplay* replay = NvClothCreateReplay(factory, stream);
+	if (!replay)
+	{
+		fprintf(stderr, "%s is not a cloth recording\n", path);
+		fclose(file);
+		return false;
+	}
+
+	nv::cloth::ClothReplayTimings timings;
+	for (uint32_t frame = 0; frame < maxFrames && replay->simulateFrame(timings); ++frame)
+	{
+		totals.add(timings);
+		if (csv)
+			printf("%u,%f,%u,%u,%f,%f,%f,%f,%f\n", frame, timings.mDt, timings.mNumCloths, timings.mNumParticles, timings.mLoadMs,
+			       timings.mBeginSimulationMs, timings.mSimulateChunksMs, timings.mMaxChunkMs, timings.mEndSimulationMs);
+		else
+			printf("frame %5u  dt %.4f  cloths %4u  particles %7u  load %8.3f  begin %8.3f  chunks %8.3f (max %8.3f)  end %8.3f ms\n",
+			       frame, timings.mDt, timings.mNumCloths, timings.mNumParticles, timings.mLoadMs, timings.mBeginSimulationMs,
+			       timings.mSimulateChunksMs, timings.mMaxChunkMs, timings.mEndSimulationMs);
+		profiler.endFrame(!csv);
+	}
+
+	bool valid = !replay->hasError();
+	if (!valid)
+		fprintf(stderr, "%s is corrupt or was recorded with unsupported inputs\n", path);
+
+	NV_CLOTH_DELETE(replay);
+	fclose(file);
+	return valid;
+}
+}
+
+int main(int argc, char** argv)
+{
+	const char* path = nullptr;
+	bool csv = false;
+	uint32_t maxFrames = 0xffffffff;
+	uint32_t repeat = 1;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!strcmp(argv[i], "-csv"))
+			csv = true;
+		else if (!strcmp(argv[i], "-frames") && i + 1 < argc)
+			maxFrames = uint32_t(strtoul(argv[++i], nullptr, 0));
+		else if (!strcmp(argv[i], "-repeat") && i + 1 < argc)
+			repeat = uint32_t(strtoul(argv[++i], nullptr, 0));
+		else
+			path = argv[i];
+	}
+
+	if (!path || !repeat)
+	{
+		fprintf(stderr, "usage: %s <recording> [-csv] [-frames <count>] [-repeat <count>]\n", argv[0]);
+		return 1;
+	}
+
+	Allocator allocator;
+	ErrorCallback errorCallback;
+	AssertHandler assertHandler;
+	ZoneProfiler profiler;
+	nv::cloth::InitializeNvCloth(&allocator, &errorCallback, &assertHandler, &profiler);
+	nv::cloth::Factory* factory = NvClothCreateFactoryCPU();
+
+	if (csv)
+		printf("frame,dt,cloths,particles,load_ms,begin_ms,chunks_ms,max_chunk_ms,end_ms\n");
+
+	StageTotals totals;
+	bool valid = true;
+	for (uint32_t i = 0; i < repeat && valid; ++i)
+		valid = replay(factory, path, csv, maxFrames, totals, profiler);
+
+	if (totals.mNumFrames && !csv)
+	{
+		double n = totals.mNumFrames;
+		double frameMs = totals.mBeginSimulationMs + totals.mSimulateChunksMs + totals.mEndSimulationMs;
+		printf("%u frames, simulation per frame: avg %.3f min %.3f max %.3f ms\n", totals.mNumFrames, frameMs / n,
+		       totals.mMinFrameMs, totals.mMaxFrameMs);
+		printf("avg per stage: load %.3f  begin %.3f  chunks %.3f  end %.3f ms\n", totals.mLoadMs / n,
+		       totals.mBeginSimulationMs / n, totals.mSimulateChunksMs / n, totals.mEndSimulationMs / n);
+		profiler.printAverages();
+	}
+
+	NvClothDestroyFactory(factory);
+	return valid ? 0 : 1;
+}
@@ -13,11 +13,16 @@ SET( NV_CLOTH_SOURCE_LIST
 	${PROJECT_ROOT_DIR}/include/NvCloth/Allocator.h
 	${PROJECT_ROOT_DIR}/include/NvCloth/Callbacks.h
 	${PROJECT_ROOT_DIR}/include/NvCloth/Cloth.h
+	${PROJECT_ROOT_DIR}/include/NvCloth/CollisionShapeSet.h
 	${PROJECT_ROOT_DIR}/include/NvCloth/DxContextManagerCallback.h
 	${PROJECT_ROOT_DIR}/include/NvCloth/Fabric.h
 	${PROJECT_ROOT_DIR}/include/NvCloth/Factory.h
+	${PROJECT_ROOT_DIR}/include/NvCloth/HeightField.h
+	${PROJECT_ROOT_DIR}/include/NvCloth/LodConfig.h
+	${PROJECT_ROOT_DIR}/include/NvCloth/ParticleDataBuffer.h
 	${PROJECT_ROOT_DIR}/include/NvCloth/PhaseConfig.h
 	${PROJECT_ROOT_DIR}/include/NvCloth/Range.h
+	${PROJECT_ROOT_DIR}/include/NvCloth/SignedDistanceField.h
 	${PROJECT_ROOT_DIR}/include/NvCloth/Solver.h
 	
 	${PROJECT_ROOT_DIR}/include/NvCloth/ps/Ps.h
@@ -42,17 +47,20 @@ SET( NV_CLOTH_SOURCE_LIST
 	${PROJECT_ROOT_DIR}/src/ClothClone.h
 	${PROJECT_ROOT_DIR}/src/ClothImpl.h
 	${PROJECT_ROOT_DIR}/src/Factory.cpp
+	${PROJECT_ROOT_DIR}/src/HalfFloat.h
 	${PROJECT_ROOT_DIR}/src/IndexPair.h
 	${PROJECT_ROOT_DIR}/src/IterationState.h
 	${PROJECT_ROOT_DIR}/src/MovingAverage.h
 	${PROJECT_ROOT_DIR}/src/PhaseConfig.cpp
 	${PROJECT_ROOT_DIR}/src/PointInterpolator.h
+	${PROJECT_ROOT_DIR}/src/SharedArray.h
 	${PROJECT_ROOT_DIR}/src/Simd.h
 	${PROJECT_ROOT_DIR}/src/StackAllocator.h
 	${PROJECT_ROOT_DIR}/src/SwCloth.cpp
 	${PROJECT_ROOT_DIR}/src/SwCloth.h
 	${PROJECT_ROOT_DIR}/src/SwClothData.cpp
 	${PROJECT_ROOT_DIR}/src/SwClothData.h
+	${PROJECT_ROOT_DIR}/src/SwClothState.cpp
 	${PROJECT_ROOT_DIR}/src/SwCollision.cpp
 	${PROJECT_ROOT_DIR}/src/SwCollision.h
 	${PROJECT_ROOT_DIR}/src/SwCollisionHelpers.h
@@ -144,10 +152,12 @@ SET( NV_CLOTH_SOURCE_LIST
 	${PROJECT_ROOT_DIR}/extensions/include/NvClothExt/ClothFabricCooker.h
 	${PROJECT_ROOT_DIR}/extensions/include/NvClothExt/ClothMeshDesc.h
 	${PROJECT_ROOT_DIR}/extensions/include/NvClothExt/ClothMeshQuadifier.h
+	${PROJECT_ROOT_DIR}/extensions/include/NvClothExt/ClothRecorder.h
 	${PROJECT_ROOT_DIR}/extensions/include/NvClothExt/ClothTetherCooker.h
 	${PROJECT_ROOT_DIR}/extensions/src/ClothFabricCooker.cpp
 	${PROJECT_ROOT_DIR}/extensions/src/ClothGeodesicTetherCooker.cpp
 	${PROJECT_ROOT_DIR}/extensions/src/ClothMeshQuadifier.cpp
+	${PROJECT_ROOT_DIR}/extensions/src/ClothRecorder.cpp
 	${PROJECT_ROOT_DIR}/extensions/src/ClothSimpleTetherCooker.cpp
 )
 
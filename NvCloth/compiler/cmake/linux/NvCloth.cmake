@@ -14,6 +14,9 @@ ENDIF()
 IF(NOT DEFINED NV_CLOTH_ENABLE_DX11)
 SET(NV_CLOTH_ENABLE_DX11 0)
 ENDIF()
+IF(NOT DEFINED NV_CLOTH_BUILD_REPLAY_TOOL)
+SET(NV_CLOTH_BUILD_REPLAY_TOOL 1)
+ENDIF()
 
 MESSAGE("NV_CLOTH_ENABLE_CUDA = " ${NV_CLOTH_ENABLE_CUDA})
 
@@ -141,4 +144,25 @@ SET_TARGET_PROPERTIES(NvCloth PROPERTIES
 
 # enable -fPIC so we can link static libs with the editor
 SET_TARGET_PROPERTIES(NvCloth PROPERTIES POSITION_INDEPENDENT_CODE TRUE)
+
+# headless replay of ClothRecorder streams for profiling
+IF(${NV_CLOTH_BUILD_REPLAY_TOOL})
+ADD_EXECUTABLE(NvClothReplay ${PROJECT_ROOT_DIR}/Tools/ClothReplay/ClothReplay.cpp)
+
+TARGET_INCLUDE_DIRECTORIES(NvClothReplay
+	PRIVATE ${PXSHARED_ROOT_DIR}/include
+	PRIVATE ${PROJECT_ROOT_DIR}/include
+	PRIVATE ${PROJECT_ROOT_DIR}/extensions/include
+)
+
+TARGET_COMPILE_DEFINITIONS(NvClothReplay
+	PRIVATE ${PHYSX_LINUX_COMPILE_DEFS}
+	PRIVATE $<$<CONFIG:debug>:${PHYSX_LINUX_DEBUG_COMPILE_DEFS}>
+	PRIVATE $<$<CONFIG:checked>:${PHYSX_LINUX_CHECKED_COMPILE_DEFS}>
+	PRIVATE $<$<CONFIG:profile>:${PHYSX_LINUX_PROFILE_COMPILE_DEFS}>
+	PRIVATE $<$<CONFIG:release>:${PHYSX_LINUX_RELEASE_COMPILE_DEFS}>
+)
+
+TARGET_LINK_LIBRARIES(NvClothReplay NvCloth)
+ENDIF()
 MESSAGE("[NvCloth]cmake/linux/NvCloth.cmake END")
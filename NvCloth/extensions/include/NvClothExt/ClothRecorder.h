@@ -0,0 +1,145 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2008-2020 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#ifndef NV_CLOTH_EXTENSIONS_CLOTH_RECORDER_H
+#define NV_CLOTH_EXTENSIONS_CLOTH_RECORDER_H
+
+/** \addtogroup extensions
+  @{
+*/
+
+#include "NvCloth/Cloth.h"
+#include "NvCloth/Solver.h"
+#include "NvCloth/Factory.h"
+#include "NvCloth/Allocator.h"
+#include "foundation/PxIO.h"
+
+namespace nv
+{
+namespace cloth
+{
+
+/**
+\brief Records the simulation inputs of a solver to a stream, to replay them later with ClothReplay.
+
+The fabrics, particles and configuration of all cloths in the solver are recorded the first time they are
+simulated, followed by the configuration changes and a state snapshot of every cloth for each frame
+(see Cloth::saveState(), this includes the particle accelerations). Snapshots are delta encoded against the
+previous key frame. Self collision indices and rest positions are compared every frame and recorded when they change.
+
+Phase configs and virtual particles can't be read back from a cloth, use the record functions below when setting them.
+Not recorded are sparse constraint indices, particle collision masks, bone spheres, constraint compliances,
+user owned data (collision shape sets, signed distance fields, height fields, particle data buffers)
+and the inter collision filter. Recording is only supported for cloths of the CPU factory.
+
+Use NvClothCreateRecorder() to create an implemented instance.
+*/
+class NV_CLOTH_IMPORT ClothRecorder : public UserAllocated
+{
+public:
+	virtual ~ClothRecorder(){}
+
+	/** \brief Records the inputs of all cloths in the solver for the next frame.
+		Call right before Solver::beginSimulation() with the same dt.
+	*/
+	virtual void recordFrame(const Solver& solver, float dt) = 0;
+
+	/// Records the phase configs of a cloth, call together with Cloth::setPhaseConfig().
+	virtual void recordPhaseConfig(const Cloth& cloth, Range<const PhaseConfig> configs) = 0;
+
+	/// Records the virtual particles of a cloth, call together with Cloth::setVirtualParticles().
+	virtual void recordVirtualParticles(const Cloth& cloth, Range<const uint32_t[4]> indices, Range<const physx::PxVec3> weights) = 0;
+
+	/** \brief Stops recording a cloth, call before it is destroyed.
+		A new cloth created at the same address is recorded as a different cloth.
+	*/
+	virtual void removeCloth(const Cloth& cloth) = 0;
+
+	/** \brief Sets how often full snapshots are written (default 30 frames).
+		Snapshots in between only store the difference to the last full snapshot of the cloth.
+	*/
+	virtual void setKeyFrameInterval(uint32_t frames) = 0;
+};
+
+/// Timings of a replayed frame, see ClothReplay::simulateFrame().
+struct ClothReplayTimings
+{
+	float mDt;
+	uint32_t mNumCloths;
+	uint32_t mNumParticles;
+	float mLoadMs; // applying the recorded configuration and state
+	float mBeginSimulationMs; // Solver::beginSimulation()
+	float mSimulateChunksMs; // sum of all Solver::simulateChunk() calls
+	float mMaxChunkMs; // most expensive Solver::simulateChunk() call
+	float mEndSimulationMs; // Solver::endSimulation()
+};
+
+/**
+\brief Replays a stream written by ClothRecorder.
+
+Every frame restores the recorded state of all cloths before simulating it, so each frame is simulated from exactly
+the recorded inputs no matter which solver version or settings are used for the replay.
+
+Use NvClothCreateReplay() to create an implemented instance.
+*/
+class NV_CLOTH_IMPORT ClothReplay : public UserAllocated
+{
+public:
+	virtual ~ClothReplay(){}
+
+	/** \brief Applies the inputs of the next recorded frame and simulates it on a single thread.
+		Returns false at the end of the stream or if the stream is invalid.
+	*/
+	virtual bool simulateFrame(ClothReplayTimings& timings) = 0;
+
+	/// Returns true if the stream was invalid or didn't match the factory.
+	virtual bool hasError() const = 0;
+
+	/// Returns the solver used for the replay, e.g. to change settings or read back the particles.
+	virtual Solver& getSolver() = 0;
+};
+
+/** @} */
+
+} // namespace cloth
+} // namespace nv
+
+
+NV_CLOTH_API(nv::cloth::ClothRecorder*) NvClothCreateRecorder(physx::PxOutputStream& stream);
+
+/**
+\brief Creates a replay of a recorded stream.
+
+\param factory The factory used to create the recorded fabrics, cloths and solver, needs to be a CPU factory.
+\param stream The recorded stream, read one frame at a time.
+\return The replay, or NULL if the stream is not a cloth recording.
+*/
+NV_CLOTH_API(nv::cloth::ClothReplay*) NvClothCreateReplay(nv::cloth::Factory* factory, physx::PxInputStream& stream);
+
+#endif // NV_CLOTH_EXTENSIONS_CLOTH_RECORDER_H
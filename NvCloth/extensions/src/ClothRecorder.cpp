@@ -0,0 +1,954 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2008-2020 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#include "NvClothExt/ClothRecorder.h"
+#include "NvCloth/Fabric.h"
+#include "NvCloth/Range.h"
+#include <chrono>
+#include <string.h> // for memcpy, memcmp
+
+using namespace physx;
+
+namespace nv
+{
+namespace cloth
+{
+
+namespace
+{
+/*
+   The stream is a sequence of chunks [tag][payload bytes][payload], all sizes are multiples of 4 bytes.
+   Fabrics and cloths are referenced by ids in the order they were first recorded.
+ */
+enum ChunkTag
+{
+	eHeader = 0x44414548,           // HEAD: magic, version
+	eFabric = 0x52424146,           // FABR: fabric id, particle count, flags, element counts, fabric data
+	eCloth = 0x48544c43,            // CLTH: cloth id, fabric id, particle count, particles
+	eClothConfig = 0x464e4f43,      // CONF: cloth id, ClothConfig
+	ePhaseConfig = 0x53414850,      // PHAS: cloth id, count, phase configs
+	eVirtualParticles = 0x54524956, // VIRT: cloth id, index count, weight count, indices, weights
+	eSelfCollision = 0x464c4553,    // SELF: cloth id, count, indices
+	eRestPositions = 0x54534552,    // REST: cloth id, count, positions
+	eRemoveCloth = 0x204c4544,      // DEL : cloth id
+	eSolverConfig = 0x564c4f53,     // SOLV: SolverConfig
+	eFrame = 0x4d415246             // FRAM: dt, cloth count, per cloth [id, key frame, budget weight, snapshot bytes, snapshot]
+};
+
+const uint32_t sRecordingMagic = 0x52434e56; // "NVCR"
+const uint32_t sRecordingVersion = 1;
+const uint32_t sNumFabricArrays = 8;
+
+// cloth settings that can be read back through the Cloth interface
+struct ClothConfig
+{
+	void read(const Cloth& cloth)
+	{
+		mGravity = cloth.getGravity();
+		mDamping = cloth.getDamping();
+		mLinearDrag = cloth.getLinearDrag();
+		mAngularDrag = cloth.getAngularDrag();
+		mLinearInertia = cloth.getLinearInertia();
+		mAngularInertia = cloth.getAngularInertia();
+		mCentrifugalInertia = cloth.getCentrifugalInertia();
+		mWind = cloth.getWindVelocity();
+		mSolverFrequency = cloth.getSolverFrequency();
+		mStiffnessFrequency = cloth.getStiffnessFrequency();
+		mAccelerationFilterWidth = cloth.getAccelerationFilterWidth();
+		mTetherConstraintScale = cloth.getTetherConstraintScale();
+		mTetherConstraintStiffness = cloth.getTetherConstraintStiffness();
+		mMotionConstraintScale = cloth.getMotionConstraintScale();
+		mMotionConstraintBias = cloth.getMotionConstraintBias();
+		mMotionConstraintStiffness = cloth.getMotionConstraintStiffness();
+		mDragCoefficient = cloth.getDragCoefficient();
+		mLiftCoefficient = cloth.getLiftCoefficient();
+		mFluidDensity = cloth.getFluidDensity();
+		mSelfCollisionDistance = cloth.getSelfCollisionDistance();
+		mSelfCollisionStiffness = cloth.getSelfCollisionStiffness();
+		mContinuousCollision = cloth.isContinuousCollisionEnabled();
+		mCollisionMassScale = cloth.getCollisionMassScale();
+		mFriction = cloth.getFriction();
+		mSleepThreshold = cloth.getSleepThreshold();
+		mSleepTestInterval = cloth.getSleepTestInterval();
+		mSleepAfterCount = cloth.getSleepAfterCount();
+		mResidualMeasurement = cloth.isResidualMeasurementEnabled();
+		mResidualTolerance = cloth.getResidualTolerance();
+		mLodImportance = cloth.getLodImportance();
+		mLodConfig = cloth.getLodConfig();
+		mParticleHistoryCompression = cloth.isParticleHistoryCompressionEnabled();
+	}
+
+	void apply(Cloth& cloth) const
+	{
+		cloth.setGravity(mGravity);
+		cloth.setDamping(mDamping);
+		cloth.setLinearDrag(mLinearDrag);
+		cloth.setAngularDrag(mAngularDrag);
+		cloth.setLinearInertia(mLinearInertia);
+		cloth.setAngularInertia(mAngularInertia);
+		cloth.setCentrifugalInertia(mCentrifugalInertia);
+		cloth.setWindVelocity(mWind);
+		cloth.setSolverFrequency(mSolverFrequency);
+		cloth.setStiffnessFrequency(mStiffnessFrequency);
+		cloth.setAcceleationFilterWidth(mAccelerationFilterWidth);
+		cloth.setTetherConstraintScale(mTetherConstraintScale);
+		cloth.setTetherConstraintStiffness(mTetherConstraintStiffness);
+		cloth.setMotionConstraintScaleBias(mMotionConstraintScale, mMotionConstraintBias);
+		cloth.setMotionConstraintStiffness(mMotionConstraintStiffness);
+		cloth.setDragCoefficient(mDragCoefficient);
+		cloth.setLiftCoefficient(mLiftCoefficient);
+		cloth.setFluidDensity(mFluidDensity);
+		cloth.setSelfCollisionDistance(mSelfCollisionDistance);
+		cloth.setSelfCollisionStiffness(mSelfCollisionStiffness);
+		cloth.enableContinuousCollision(mContinuousCollision != 0);
+		cloth.setCollisionMassScale(mCollisionMassScale);
+		cloth.setFriction(mFriction);
+		cloth.setSleepThreshold(mSleepThreshold);
+		cloth.setSleepTestInterval(mSleepTestInterval);
+		cloth.setSleepAfterCount(mSleepAfterCount);
+		cloth.enableResidualMeasurement(mResidualMeasurement != 0);
+		cloth.setResidualTolerance(mResidualTolerance);
+		cloth.setLodImportance(mLodImportance);
+		cloth.setLodConfig(mLodConfig);
+		cloth.enableParticleHistoryCompression(mParticleHistoryCompression != 0);
+	}
+
+	PxVec3 mGravity;
+	PxVec3 mDamping;
+	PxVec3 mLinearDrag;
+	PxVec3 mAngularDrag;
+	PxVec3 mLinearInertia;
+	PxVec3 mAngularInertia;
+	PxVec3 mCentrifugalInertia;
+	PxVec3 mWind;
+	float mSolverFrequency;
+	float mStiffnessFrequency;
+	uint32_t mAccelerationFilterWidth;
+	float mTetherConstraintScale;
+	float mTetherConstraintStiffness;
+	float mMotionConstraintScale;
+	float mMotionConstraintBias;
+	float mMotionConstraintStiffness;
+	float mDragCoefficient;
+	float mLiftCoefficient;
+	float mFluidDensity;
+	float mSelfCollisionDistance;
+	float mSelfCollisionStiffness;
+	uint32_t mContinuousCollision;
+	float mCollisionMassScale;
+	float mFriction;
+	float mSleepThreshold;
+	uint32_t mSleepTestInterval;
+	uint32_t mSleepAfterCount;
+	uint32_t mResidualMeasurement;
+	float mResidualTolerance;
+	float mLodImportance;
+	LodConfig mLodConfig;
+	uint32_t mParticleHistoryCompression;
+};
+
+struct SolverConfig
+{
+	void read(const Solver& solver)
+	{
+		mInterCollisionDistance = solver.getInterCollisionDistance();
+		mInterCollisionStiffness = solver.getInterCollisionStiffness();
+		mInterCollisionNbIterations = solver.getInterCollisionNbIterations();
+		mFrameTimeBudget = solver.getFrameTimeBudget();
+	}
+
+	void apply(Solver& solver) const
+	{
+		solver.setInterCollisionDistance(mInterCollisionDistance);
+		solver.setInterCollisionStiffness(mInterCollisionStiffness);
+		solver.setInterCollisionNbIterations(mInterCollisionNbIterations);
+		solver.setFrameTimeBudget(mFrameTimeBudget);
+	}
+
+	float mInterCollisionDistance;
+	float mInterCollisionStiffness;
+	uint32_t mInterCollisionNbIterations;
+	float mFrameTimeBudget;
+};
+
+PX_COMPILE_TIME_ASSERT(sizeof(ClothConfig) % sizeof(uint32_t) == 0);
+PX_COMPILE_TIME_ASSERT(sizeof(SolverConfig) % sizeof(uint32_t) == 0);
+PX_COMPILE_TIME_ASSERT(sizeof(PhaseConfig) % sizeof(uint32_t) == 0);
+
+float getElapsedMs(std::chrono::high_resolution_clock::time_point& time)
+{
+	std::chrono::high_resolution_clock::time_point now = std::chrono::high_resolution_clock::now();
+	float elapsed = std::chrono::duration<float, std::milli>(now - time).count();
+	time = now;
+	return elapsed;
+}
+
+// payload of the chunk being read, reading past the end sets the error flag
+class ChunkReader
+{
+  public:
+	ChunkReader(const uint32_t* begin, const uint32_t* end) : mIt(begin), mEnd(end), mError(false)
+	{
+	}
+
+	uint32_t read()
+	{
+		if (mIt == mEnd)
+		{
+			mError = true;
+			return 0;
+		}
+		return *mIt++;
+	}
+
+	// returns count elements in place, or null if the payload is too short
+	template <typename T>
+	const T* read(uint32_t count)
+	{
+		PX_COMPILE_TIME_ASSERT(sizeof(T) % sizeof(uint32_t) == 0);
+		uint64_t numWords = uint64_t(count) * (sizeof(T) / sizeof(uint32_t));
+		if (numWords > uint64_t(mEnd - mIt))
+		{
+			mError = true;
+			return nullptr;
+		}
+		const T* result = reinterpret_cast<const T*>(mIt);
+		mIt += numWords;
+		return result;
+	}
+
+	template <typename T>
+	Range<const T> readRange(uint32_t count)
+	{
+		const T* begin = read<T>(count);
+		return begin ? Range<const T>(begin, begin + count) : Range<const T>();
+	}
+
+	float readFloat()
+	{
+		uint32_t word = read();
+		float value;
+		memcpy(&value, &word, sizeof(value));
+		return value;
+	}
+
+	bool hasError() const
+	{
+		return mError;
+	}
+
+  private:
+	const uint32_t* mIt;
+	const uint32_t* mEnd;
+	bool mError;
+};
+}
+
+class ClothRecorderImpl : public ClothRecorder
+{
+  public:
+	ClothRecorderImpl(PxOutputStream& stream);
+	~ClothRecorderImpl();
+
+	void recordFrame(const Solver& solver, float dt);
+	void recordPhaseConfig(const Cloth& cloth, Range<const PhaseConfig> configs);
+	void recordVirtualParticles(const Cloth& cloth, Range<const uint32_t[4]> indices, Range<const PxVec3> weights);
+	void removeCloth(const Cloth& cloth);
+	void setKeyFrameInterval(uint32_t frames);
+
+  private:
+	struct ClothRecord
+	{
+		ClothRecord() : mCloth(nullptr), mFramesSinceKeyFrame(0)
+		{
+		}
+
+		const Cloth* mCloth; // null after removeCloth()
+		ClothConfig mConfig;
+		Vector<uint32_t>::Type mSelfCollisionIndices; // last recorded
+		Vector<PxVec4>::Type mRestPositions; // last recorded
+		uint32_t mFramesSinceKeyFrame;
+		Vector<uint32_t>::Type mKeyFrame; // reference of the delta encoded snapshots
+	};
+
+	uint32_t getFabricId(const Fabric& fabric);
+	uint32_t getClothId(const Cloth& cloth);
+	void recordCollisionData(ClothRecord& record);
+
+	void beginChunk(ChunkTag tag);
+	void endChunk();
+	void write(uint32_t word)
+	{
+		mChunk.pushBack(word);
+	}
+	void write(float value)
+	{
+		uint32_t word;
+		memcpy(&word, &value, sizeof(word));
+		mChunk.pushBack(word);
+	}
+	template <typename T>
+	void write(const T* data, uint32_t count)
+	{
+		PX_COMPILE_TIME_ASSERT(sizeof(T) % sizeof(uint32_t) == 0);
+		uint32_t size = mChunk.size();
+		mChunk.resizeUninitialized(size + count * uint32_t(sizeof(T) / sizeof(uint32_t)));
+		if (count)
+			memcpy(mChunk.begin() + size, data, count * sizeof(T));
+	}
+
+	PxOutputStream& mStream;
+	Vector<uint32_t>::Type mChunk; // tag, size and payload of the chunk being written
+
+	HashMap<const Fabric*, uint32_t>::Type mFabricIds;
+	Vector<Fabric*>::Type mFabrics; // referenced until the recorder is destroyed, so addresses are not reused
+
+	HashMap<const Cloth*, uint32_t>::Type mClothIds;
+	Vector<ClothRecord>::Type mCloths;
+
+	// extracted collision data of the current cloth, compared against the last recorded one
+	Vector<uint32_t>::Type mSelfCollisionIndices;
+	Vector<PxVec4>::Type mRestPositions;
+
+	SolverConfig mSolverConfig;
+	bool mSolverConfigValid;
+	uint32_t mKeyFrameInterval;
+};
+
+ClothRecorderImpl::ClothRecorderImpl(PxOutputStream& stream)
+: mStream(stream), mSolverConfigValid(false), mKeyFrameInterval(30)
+{
+	beginChunk(eHeader);
+	write(sRecordingMagic);
+	write(sRecordingVersion);
+	endChunk();
+}
+
+ClothRecorderImpl::~ClothRecorderImpl()
+{
+	for (uint32_t i = 0; i < mFabrics.size(); ++i)
+		mFabrics[i]->decRefCount();
+}
+
+void ClothRecorderImpl::beginChunk(ChunkTag tag)
+{
+	mChunk.resizeUninitialized(2);
+	mChunk[0] = uint32_t(tag);
+}
+
+void ClothRecorderImpl::endChunk()
+{
+	mChunk[1] = (mChunk.size() - 2) * sizeof(uint32_t);
+	mStream.write(mChunk.begin(), mChunk.size() * sizeof(uint32_t));
+}
+
+uint32_t ClothRecorderImpl::getFabricId(const Fabric& fabric)
+{
+	if (const HashMap<const Fabric*, uint32_t>::Type::Entry* entry = mFabricIds.find(&fabric))
+		return entry->second;
+
+	uint32_t id = mFabrics.size();
+	mFabricIds.insert(&fabric, id);
+	mFabrics.pushBack(const_cast<Fabric*>(&fabric));
+	mFabrics.back()->incRefCount();
+
+	uint32_t counts[sNumFabricArrays] = { fabric.getNumPhases(),      fabric.getNumSets(),    fabric.getNumRestvalues(),
+	                                      fabric.getNumStiffnessValues(), fabric.getNumIndices(), fabric.getNumTethers(),
+	                                      fabric.getNumTethers(),     fabric.getNumTriangles() * 3 };
+
+	Vector<uint32_t>::Type phaseIndices(counts[0]), sets(counts[1]), indices(counts[4]), anchors(counts[5]), triangles(counts[7]);
+	Vector<float>::Type restvalues(counts[2]), stiffnessValues(counts[3]), tetherLengths(counts[6]);
+	fabric.getFactory().extractFabricData(fabric, Range<uint32_t>(phaseIndices.begin(), phaseIndices.end()),
+	                                      Range<uint32_t>(sets.begin(), sets.end()), Range<float>(restvalues.begin(), restvalues.end()),
+	                                      Range<float>(stiffnessValues.begin(), stiffnessValues.end()),
+	                                      Range<uint32_t>(indices.begin(), indices.end()), Range<uint32_t>(anchors.begin(), anchors.end()),
+	                                      Range<float>(tetherLengths.begin(), tetherLengths.end()),
+	                                      Range<uint32_t>(triangles.begin(), triangles.end()));
+
+	beginChunk(eFabric);
+	write(id);
+	write(fabric.getNumParticles());
+	write(uint32_t(fabric.isQuantized()) | uint32_t(fabric.hasPackedConstraints()) << 1);
+	write(counts, sNumFabricArrays);
+	write(phaseIndices.begin(), counts[0]);
+	write(sets.begin(), counts[1]);
+	write(restvalues.begin(), counts[2]);
+	write(stiffnessValues.begin(), counts[3]);
+	write(indices.begin(), counts[4]);
+	write(anchors.begin(), counts[5]);
+	write(tetherLengths.begin(), counts[6]);
+	write(triangles.begin(), counts[7]);
+	endChunk();
+
+	return id;
+}
+
+uint32_t ClothRecorderImpl::getClothId(const Cloth& cloth)
+{
+	if (const HashMap<const Cloth*, uint32_t>::Type::Entry* entry = mClothIds.find(&cloth))
+		return entry->second;
+
+	uint32_t fabricId = getFabricId(cloth.getFabric());
+
+	uint32_t id = mCloths.size();
+	mClothIds.insert(&cloth, id);
+	mCloths.pushBack(ClothRecord());
+	ClothRecord& record = mCloths.back();
+	record.mCloth = &cloth;
+	record.mConfig.read(cloth);
+
+	MappedRange<const PxVec4> particles = cloth.getCurrentParticles();
+	beginChunk(eCloth);
+	write(id);
+	write(fabricId);
+	write(particles.size());
+	write(particles.begin(), particles.size());
+	endChunk();
+
+	beginChunk(eClothConfig);
+	write(id);
+	write(&record.mConfig, 1);
+	endChunk();
+
+	recordCollisionData(record);
+
+	return id;
+}
+
+// self collision indices and rest positions can be extracted, recorded when they differ from the last recorded ones
+void ClothRecorderImpl::recordCollisionData(ClothRecord& record)
+{
+	const Cloth& cloth = *record.mCloth;
+	uint32_t id = uint32_t(&record - mCloths.begin());
+
+	uint32_t numSelfCollisionIndices = cloth.getNumSelfCollisionIndices();
+	mSelfCollisionIndices.resizeUninitialized(numSelfCollisionIndices);
+	cloth.getFactory().extractSelfCollisionIndices(cloth, Range<uint32_t>(mSelfCollisionIndices.begin(), mSelfCollisionIndices.end()));
+	if (numSelfCollisionIndices != record.mSelfCollisionIndices.size() ||
+	    (numSelfCollisionIndices && memcmp(mSelfCollisionIndices.begin(), record.mSelfCollisionIndices.begin(), numSelfCollisionIndices * sizeof(uint32_t))))
+	{
+		record.mSelfCollisionIndices.swap(mSelfCollisionIndices);
+
+		beginChunk(eSelfCollision);
+		write(id);
+		write(numSelfCollisionIndices);
+		write(record.mSelfCollisionIndices.begin(), numSelfCollisionIndices);
+		endChunk();
+	}
+
+	uint32_t numRestPositions = cloth.getNumRestPositions();
+	mRestPositions.resizeUninitialized(numRestPositions);
+	cloth.getFactory().extractRestPositions(cloth, Range<PxVec4>(mRestPositions.begin(), mRestPositions.end()));
+	if (numRestPositions != record.mRestPositions.size() ||
+	    (numRestPositions && memcmp(mRestPositions.begin(), record.mRestPositions.begin(), numRestPositions * sizeof(PxVec4))))
+	{
+		record.mRestPositions.swap(mRestPositions);
+
+		beginChunk(eRestPositions);
+		write(id);
+		write(numRestPositions);
+		write(record.mRestPositions.begin(), numRestPositions);
+		endChunk();
+	}
+}
+
+void ClothRecorderImpl::recordFrame(const Solver& solver, float dt)
+{
+	SolverConfig solverConfig;
+	solverConfig.read(solver);
+	if (!mSolverConfigValid || memcmp(&solverConfig, &mSolverConfig, sizeof(SolverConfig)))
+	{
+		mSolverConfig = solverConfig;
+		mSolverConfigValid = true;
+		beginChunk(eSolverConfig);
+		write(&mSolverConfig, 1);
+		endChunk();
+	}
+
+	uint32_t numCloths = uint32_t(solver.getNumCloths());
+	Cloth* const* cloths = solver.getClothList();
+
+	// record new cloths and configuration changes first, they precede the frame chunk
+	for (uint32_t i = 0; i < numCloths; ++i)
+	{
+		uint32_t id = getClothId(*cloths[i]);
+		ClothRecord& record = mCloths[id];
+
+		ClothConfig config;
+		config.read(*cloths[i]);
+		if (memcmp(&config, &record.mConfig, sizeof(ClothConfig)))
+		{
+			record.mConfig = config;
+			beginChunk(eClothConfig);
+			write(id);
+			write(&config, 1);
+			endChunk();
+		}
+
+		recordCollisionData(record);
+	}
+
+	beginChunk(eFrame);
+	write(dt);
+	write(numCloths);
+	for (uint32_t i = 0; i < numCloths; ++i)
+	{
+		const Cloth& cloth = *cloths[i];
+		uint32_t id = mClothIds.find(&cloth)->second;
+		ClothRecord& record = mCloths[id];
+
+		bool keyFrame = record.mKeyFrame.empty() || ++record.mFramesSinceKeyFrame >= mKeyFrameInterval;
+		Range<const uint8_t> reference;
+		if (!keyFrame)
+			reference = Range<const uint8_t>(reinterpret_cast<const uint8_t*>(record.mKeyFrame.begin()),
+			                                 reinterpret_cast<const uint8_t*>(record.mKeyFrame.end()));
+
+		// snapshot directly into the chunk
+		uint32_t size = mChunk.size();
+		uint32_t capacity = cloth.getStateSize();
+		mChunk.resizeUninitialized(size + 4 + capacity / sizeof(uint32_t));
+		uint8_t* snapshot = reinterpret_cast<uint8_t*>(mChunk.begin() + size + 4);
+		uint32_t numBytes = cloth.saveState(Range<uint8_t>(snapshot, snapshot + capacity), reference);
+		mChunk.resizeUninitialized(size + 4 + numBytes / sizeof(uint32_t));
+		mChunk[size] = id;
+		mChunk[size + 1] = keyFrame;
+		float budgetWeight = solver.getClothBudgetWeight(&cloth);
+		memcpy(&mChunk[size + 2], &budgetWeight, sizeof(float));
+		mChunk[size + 3] = numBytes;
+
+		if (keyFrame && numBytes)
+		{
+			record.mFramesSinceKeyFrame = 0;
+			const uint32_t* words = mChunk.begin() + size + 4;
+			record.mKeyFrame.assign(words, words + numBytes / sizeof(uint32_t));
+		}
+	}
+	endChunk();
+}
+
+void ClothRecorderImpl::recordPhaseConfig(const Cloth& cloth, Range<const PhaseConfig> configs)
+{
+	uint32_t id = getClothId(cloth);
+
+	beginChunk(ePhaseConfig);
+	write(id);
+	write(configs.size());
+	write(configs.begin(), configs.size());
+	endChunk();
+}
+
+void ClothRecorderImpl::recordVirtualParticles(const Cloth& cloth, Range<const uint32_t[4]> indices, Range<const PxVec3> weights)
+{
+	uint32_t id = getClothId(cloth);
+
+	beginChunk(eVirtualParticles);
+	write(id);
+	write(indices.size());
+	write(weights.size());
+	write(indices.begin(), indices.size());
+	write(weights.begin(), weights.size());
+	endChunk();
+}
+
+void ClothRecorderImpl::removeCloth(const Cloth& cloth)
+{
+	const HashMap<const Cloth*, uint32_t>::Type::Entry* entry = mClothIds.find(&cloth);
+	if (!entry)
+		return;
+
+	uint32_t id = entry->second;
+	mClothIds.erase(&cloth);
+	mCloths[id] = ClothRecord();
+
+	beginChunk(eRemoveCloth);
+	write(id);
+	endChunk();
+}
+
+void ClothRecorderImpl::setKeyFrameInterval(uint32_t frames)
+{
+	mKeyFrameInterval = frames ? frames : 1;
+}
+
+class ClothReplayImpl : public ClothReplay
+{
+  public:
+	ClothReplayImpl(Factory& factory, PxInputStream& stream);
+	~ClothReplayImpl();
+
+	bool simulateFrame(ClothReplayTimings& timings);
+	bool hasError() const
+	{
+		return mError;
+	}
+	Solver& getSolver()
+	{
+		return *mSolver;
+	}
+
+	bool readHeader();
+
+  private:
+	struct ReplayCloth
+	{
+		ReplayCloth() : mCloth(nullptr), mInSolver(false)
+		{
+		}
+
+		Cloth* mCloth;
+		bool mInSolver;
+		Vector<uint32_t>::Type mKeyFrame;
+	};
+
+	bool readChunk();
+	void readFabric(ChunkReader& reader);
+	void readCloth(ChunkReader& reader);
+	Cloth* getCloth(uint32_t id);
+	void destroyCloth(uint32_t id);
+	void readFrame(ChunkReader& reader, ClothReplayTimings& timings);
+
+	Factory& mFactory;
+	PxInputStream& mStream;
+	Solver* mSolver;
+
+	Vector<uint32_t>::Type mChunk; // payload of the last chunk read
+	uint32_t mTag;
+
+	Vector<Fabric*>::Type mFabrics;
+	Vector<ReplayCloth>::Type mCloths;
+	Vector<uint32_t>::Type mFrameCloths; // ids of the cloths in the current frame
+	Vector<float>::Type mFrameBudgetWeights;
+
+	bool mError;
+};
+
+ClothReplayImpl::ClothReplayImpl(Factory& factory, PxInputStream& stream)
+: mFactory(factory), mStream(stream), mSolver(factory.createSolver()), mTag(0), mError(false)
+{
+}
+
+ClothReplayImpl::~ClothReplayImpl()
+{
+	for (uint32_t i = 0; i < mCloths.size(); ++i)
+		destroyCloth(i);
+	NV_CLOTH_DELETE(mSolver);
+	for (uint32_t i = 0; i < mFabrics.size(); ++i)
+		if (mFabrics[i])
+			mFabrics[i]->decRefCount();
+}
+
+bool ClothReplayImpl::readHeader()
+{
+	if (!readChunk() || mTag != eHeader)
+		return false;
+
+	ChunkReader reader(mChunk.begin(), mChunk.end());
+	return reader.read() == sRecordingMagic && reader.read() == sRecordingVersion;
+}
+
+// returns false at the end of the stream
+bool ClothReplayImpl::readChunk()
+{
+	uint32_t header[2];
+	if (mStream.read(header, sizeof(header)) != sizeof(header))
+		return false;
+
+	mTag = header[0];
+	mChunk.resizeUninitialized(header[1] / sizeof(uint32_t));
+	if ((header[1] & 3) || mStream.read(mChunk.begin(), header[1]) != header[1])
+	{
+		mError = true;
+		return false;
+	}
+	return true;
+}
+
+void ClothReplayImpl::readFabric(ChunkReader& reader)
+{
+	uint32_t id = reader.read();
+	uint32_t numParticles = reader.read();
+	uint32_t flags = reader.read(); // 1: quantized, 2: packed constraints
+	const uint32_t* counts = reader.read<uint32_t>(sNumFabricArrays);
+	if (reader.hasError() || id != mFabrics.size())
+	{
+		mError = true;
+		return;
+	}
+
+	Range<const uint32_t> phaseIndices = reader.readRange<uint32_t>(counts[0]);
+	Range<const uint32_t> sets = reader.readRange<uint32_t>(counts[1]);
+	Range<const float> restvalues = reader.readRange<float>(counts[2]);
+	Range<const float> stiffnessValues = reader.readRange<float>(counts[3]);
+	Range<const uint32_t> indices = reader.readRange<uint32_t>(counts[4]);
+	Range<const uint32_t> anchors = reader.readRange<uint32_t>(counts[5]);
+	Range<const float> tetherLengths = reader.readRange<float>(counts[6]);
+	Range<const uint32_t> triangles = reader.readRange<uint32_t>(counts[7]);
+	if (reader.hasError())
+	{
+		mError = true;
+		return;
+	}
+
+	Fabric* fabric = mFactory.createFabric(numParticles, phaseIndices, sets, restvalues, stiffnessValues, indices, anchors,
+	                                       tetherLengths, triangles);
+	if (fabric && (flags & 1))
+		fabric->quantize();
+	if (fabric && (flags & 2))
+		fabric->packConstraints();
+	mFabrics.pushBack(fabric);
+	mError |= !fabric;
+}
+
+void ClothReplayImpl::readCloth(ChunkReader& reader)
+{
+	uint32_t id = reader.read();
+	uint32_t fabricId = reader.read();
+	uint32_t numParticles = reader.read();
+	Range<const PxVec4> particles = reader.readRange<PxVec4>(numParticles);
+	if (reader.hasError() || id != mCloths.size() || fabricId >= mFabrics.size() || !mFabrics[fabricId])
+	{
+		mError = true;
+		return;
+	}
+
+	mCloths.pushBack(ReplayCloth());
+	mCloths.back().mCloth = mFactory.createCloth(particles, *mFabrics[fabricId]);
+	mError |= !mCloths.back().mCloth;
+}
+
+Cloth* ClothReplayImpl::getCloth(uint32_t id)
+{
+	Cloth* cloth = id < mCloths.size() ? mCloths[id].mCloth : nullptr;
+	mError |= !cloth;
+	return cloth;
+}
+
+void ClothReplayImpl::destroyCloth(uint32_t id)
+{
+	ReplayCloth& cloth = mCloths[id];
+	if (cloth.mInSolver)
+		mSolver->removeCloth(cloth.mCloth);
+	NV_CLOTH_DELETE(cloth.mCloth);
+	cloth = ReplayCloth();
+}
+
+void ClothReplayImpl::readFrame(ChunkReader& reader, ClothReplayTimings& timings)
+{
+	timings.mDt = reader.readFloat();
+	timings.mNumCloths = reader.read();
+	timings.mNumParticles = 0;
+
+	// restore the recorded state before updating the solver, so cloths added this frame start from it
+	mFrameCloths.clear();
+	mFrameBudgetWeights.clear();
+	for (uint32_t i = 0; i < timings.mNumCloths && !reader.hasError(); ++i)
+	{
+		uint32_t id = reader.read();
+		bool keyFrame = reader.read() != 0;
+		float budgetWeight = reader.readFloat();
+		uint32_t numBytes = reader.read();
+		const uint8_t* snapshot = reinterpret_cast<const uint8_t*>(reader.read<uint32_t>(numBytes / sizeof(uint32_t)));
+		Cloth* cloth = getCloth(id);
+		if (reader.hasError() || !cloth)
+			break;
+
+		mFrameCloths.pushBack(id);
+		mFrameBudgetWeights.pushBack(budgetWeight);
+		timings.mNumParticles += cloth->getNumParticles();
+
+		if (!numBytes) // recorded from a GPU cloth
+			continue;
+
+		Vector<uint32_t>::Type& keyFrameData = mCloths[id].mKeyFrame;
+		Range<const uint8_t> state(snapshot, snapshot + numBytes);
+		Range<const uint8_t> reference;
+		if (keyFrame)
+			keyFrameData.assign(reinterpret_cast<const uint32_t*>(snapshot), reinterpret_cast<const uint32_t*>(snapshot + numBytes));
+		else
+			reference = Range<const uint8_t>(reinterpret_cast<const uint8_t*>(keyFrameData.begin()),
+			                                 reinterpret_cast<const uint8_t*>(keyFrameData.end()));
+
+		mError |= !cloth->loadState(state, reference);
+	}
+	mError |= reader.hasError();
+	if (mError)
+		return;
+
+	for (uint32_t i = 0; i < mCloths.size(); ++i)
+	{
+		if (mCloths[i].mInSolver && mFrameCloths.find(i) == mFrameCloths.end())
+		{
+			mSolver->removeCloth(mCloths[i].mCloth);
+			mCloths[i].mInSolver = false;
+		}
+	}
+	for (uint32_t i = 0; i < mFrameCloths.size(); ++i)
+	{
+		ReplayCloth& cloth = mCloths[mFrameCloths[i]];
+		if (!cloth.mInSolver)
+		{
+			mSolver->addCloth(cloth.mCloth);
+			cloth.mInSolver = true;
+		}
+		mSolver->setClothBudgetWeight(cloth.mCloth, mFrameBudgetWeights[i]);
+	}
+}
+
+bool ClothReplayImpl::simulateFrame(ClothReplayTimings& timings)
+{
+	std::chrono::high_resolution_clock::time_point time = std::chrono::high_resolution_clock::now();
+
+	// apply the chunks up to and including the next frame
+	while (!mError && readChunk())
+	{
+		ChunkReader reader(mChunk.begin(), mChunk.end());
+		switch (mTag)
+		{
+		case eFabric:
+			readFabric(reader);
+			break;
+		case eCloth:
+			readCloth(reader);
+			break;
+		case eClothConfig:
+		{
+			Cloth* cloth = getCloth(reader.read());
+			const ClothConfig* config = reader.read<ClothConfig>(1);
+			if (cloth && config)
+				config->apply(*cloth);
+			break;
+		}
+		case ePhaseConfig:
+		{
+			Cloth* cloth = getCloth(reader.read());
+			uint32_t count = reader.read();
+			Range<const PhaseConfig> configs = reader.readRange<PhaseConfig>(count);
+			if (cloth && !reader.hasError())
+				cloth->setPhaseConfig(configs);
+			break;
+		}
+		case eVirtualParticles:
+		{
+			Cloth* cloth = getCloth(reader.read());
+			uint32_t numIndices = reader.read();
+			uint32_t numWeights = reader.read();
+			Range<const uint32_t[4]> indices = reader.readRange<uint32_t[4]>(numIndices);
+			Range<const PxVec3> weights = reader.readRange<PxVec3>(numWeights);
+			if (cloth && !reader.hasError())
+				cloth->setVirtualParticles(indices, weights);
+			break;
+		}
+		case eSelfCollision:
+		{
+			Cloth* cloth = getCloth(reader.read());
+			uint32_t count = reader.read();
+			Range<const uint32_t> indices = reader.readRange<uint32_t>(count);
+			if (cloth && !reader.hasError())
+				cloth->setSelfCollisionIndices(indices);
+			break;
+		}
+		case eRestPositions:
+		{
+			Cloth* cloth = getCloth(reader.read());
+			uint32_t count = reader.read();
+			Range<const PxVec4> positions = reader.readRange<PxVec4>(count);
+			if (cloth && !reader.hasError())
+				cloth->setRestPositions(positions);
+			break;
+		}
+		case eRemoveCloth:
+		{
+			uint32_t id = reader.read();
+			if (getCloth(id))
+				destroyCloth(id);
+			break;
+		}
+		case eSolverConfig:
+		{
+			if (const SolverConfig* config = reader.read<SolverConfig>(1))
+				config->apply(*mSolver);
+			break;
+		}
+		case eFrame:
+		{
+			readFrame(reader, timings);
+			if (mError)
+				return false;
+
+			timings.mLoadMs = getElapsedMs(time);
+
+			timings.mSimulateChunksMs = 0.0f;
+			timings.mMaxChunkMs = 0.0f;
+			timings.mEndSimulationMs = 0.0f;
+			bool simulate = mSolver->beginSimulation(timings.mDt);
+			timings.mBeginSimulationMs = getElapsedMs(time);
+			if (simulate)
+			{
+				for (int i = 0; i < mSolver->getSimulationChunkCount(); ++i)
+				{
+					mSolver->simulateChunk(i);
+					float chunkMs = getElapsedMs(time);
+					timings.mSimulateChunksMs += chunkMs;
+					timings.mMaxChunkMs = PxMax(timings.mMaxChunkMs, chunkMs);
+				}
+				mSolver->endSimulation();
+				timings.mEndSimulationMs = getElapsedMs(time);
+			}
+			return true;
+		}
+		default: // skip unknown chunks
+			break;
+		}
+		mError |= reader.hasError();
+	}
+	return false;
+}
+
+} // namespace cloth
+} // namespace nv
+
+
+NV_CLOTH_API(nv::cloth::ClothRecorder*) NvClothCreateRecorder(physx::PxOutputStream& stream)
+{
+	return NV_CLOTH_NEW(nv::cloth::ClothRecorderImpl)(stream);
+}
+
+NV_CLOTH_API(nv::cloth::ClothReplay*) NvClothCreateReplay(nv::cloth::Factory* factory, physx::PxInputStream& stream)
+{
+	if (factory->getPlatform() != nv::cloth::Platform::CPU)
+		return nullptr;
+
+	nv::cloth::ClothReplayImpl* replay = NV_CLOTH_NEW(nv::cloth::ClothReplayImpl)(*factory, stream);
+	if (!replay->readHeader())
+	{
+		NV_CLOTH_DELETE(replay);
+		return nullptr;
+	}
+	return replay;
+}
@@ -31,7 +31,14 @@
 
 #include "NvCloth/Range.h"
 #include "NvCloth/PhaseConfig.h"
+#include "NvCloth/LodConfig.h"
+#include "NvCloth/CollisionShapeSet.h"
+#include "NvCloth/ParticleDataBuffer.h"
+#include "NvCloth/HeightField.h"
+#include "NvCloth/SignedDistanceField.h"
 #include <foundation/PxVec3.h>
+#include <foundation/PxTransform.h>
+#include <foundation/PxMat44.h>
 #include "NvCloth/Allocator.h"
 
 struct ID3D11Buffer;
@@ -142,6 +149,36 @@ class Cloth : public UserAllocated
 	/** \brief Returns platform dependent pointers to the current GPU particle memory.*/
 	virtual GpuParticles getGpuParticles() = 0;
 
+	/** \brief Keep the previous particles at half precision between frames (disabled by default).
+		The previous positions are stored as 16 bit float offsets from the current positions next to their inverse masses.
+		This reduces the resident memory of the previous particles from 16 to 10 bytes per particle at a small loss of
+		velocity precision. The history is expanded batch by batch during the first iteration of each simulated frame,
+		into a full precision buffer the solver shares between cloths that aren't simulated at the same time.
+		getCurrentParticles() and getPreviousParticles() expand the history until the next simulation, so that writing
+		to either keeps the other unchanged. The const versions leave it compressed. Only supported by the CPU solver.
+		*/
+	virtual void enableParticleHistoryCompression(bool enable) = 0;
+	///Returns true if previous particles are compressed between frames.
+	virtual bool isParticleHistoryCompressionEnabled() const = 0;
+
+	/** \brief Returns the maximum number of bytes saveState() writes for the current cloth state.*/
+	virtual uint32_t getStateSize() const = 0;
+	/** \brief Writes a binary snapshot of the simulation state into a 4 byte aligned buffer.
+		The snapshot contains the particles, particle accelerations, constraint and collision shape (including
+		signed distance field and height field pose) interpolation state, motion and the solver history needed to continue the simulation exactly as if it had not been interrupted.
+		The configuration (stiffness, damping, phase configs, etc.) is not included.
+		If reference is a full snapshot of the same cloth, only the difference to it is stored, which
+		makes consecutive snapshots of slowly changing cloth much smaller. An empty reference writes a full snapshot.
+		Returns the number of bytes written, or 0 if the buffer is too small. Only supported by the CPU solver.
+		*/
+	virtual uint32_t saveState(Range<uint8_t> buffer, Range<const uint8_t> reference) const = 0;
+	/** \brief Restores a snapshot written by saveState().
+		reference needs to be the same snapshot that was passed to saveState(), and can be empty for full snapshots.
+		Returns false and leaves the cloth unchanged if the snapshot doesn't match the particle, constraint or field counts of this cloth.
+		Loading a snapshot doesn't wake up a sleeping cloth.
+		*/
+	virtual bool loadState(Range<const uint8_t> buffer, Range<const uint8_t> reference) = 0;
+
 
 	/** \brief Set the translation of the local space simulation after next call to simulate(). 
 		This applies a force to make the cloth behave as if it was moved through space.
@@ -253,6 +290,18 @@ class Cloth : public UserAllocated
 	// setup edge constraint solver iteration
 	virtual void setPhaseConfig(Range<const PhaseConfig> configs) = 0;
 
+	/** \brief Set compliance per fabric constraint, used instead of PhaseConfig::mCompliance for compliant phases.
+		compliances needs to contain Fabric::getNumRestvalues() values, or be empty to use the phase compliance.
+		Only supported by the CPU solver.
+		*/
+	virtual void setConstraintCompliances(Range<const float> compliances) = 0;
+	virtual uint32_t getNumConstraintCompliances() const = 0;
+	/** \brief Copies the lagrange multipliers of the compliant constraints from the last iteration.
+		multipliers needs to contain Fabric::getNumRestvalues() values, divide by the squared iteration dt
+		to get the constraint force. Values of constraints in non compliant phases are 0.
+		*/
+	virtual void getConstraintMultipliers(Range<float> multipliers) const = 0;
+
 	/* collision parameters */
 
 	/** \brief Set spheres for collision detection.
@@ -285,6 +334,47 @@ class Cloth : public UserAllocated
 	/// Returns the number of capsules (which is half the number of capsule indices).
 	virtual uint32_t getNumCapsules() const = 0;
 
+	/** \brief Reference a collision shape set shared with other cloths.
+		While a set is referenced, its spheres and capsules replace the ones set with setSpheres() and setCapsules().
+		sphereMask selects the spheres of the set this cloth collides with (bit i for sphere i),
+		capsules collide if both of their spheres are selected.
+		Pass null to go back to the spheres and capsules of the cloth. Only supported by the CPU solver.
+		*/
+	virtual void setCollisionShapeSet(const CollisionShapeSet* shapeSet, uint32_t sphereMask = 0xffffffff) = 0;
+	/// Returns the referenced collision shape set, or null.
+	virtual const CollisionShapeSet* getCollisionShapeSet() const = 0;
+	/// Returns the mask of spheres selected from the collision shape set.
+	virtual uint32_t getCollisionShapeSetMask() const = 0;
+
+	/** \brief Set collision spheres attached to bones.
+		Elements of localSpheres contain PxVec4(x,y,z,r) with the center in the space of bone boneIndices[i].
+		The spheres are transformed by the bone transforms during simulation, see setBoneTransforms().
+		While bone spheres and transforms are set they replace the spheres set with setSpheres(),
+		and capsule indices refer to the bone spheres. Pass empty ranges to remove all bone spheres.
+		Only supported by the CPU solver.
+		*/
+	virtual void setBoneSpheres(Range<const physx::PxVec4> localSpheres, Range<const uint32_t> boneIndices) = 0;
+	/// Returns the number of bone spheres currently set.
+	virtual uint32_t getNumBoneSpheres() const = 0;
+
+	/** \brief Set the bone transforms from bone space to the local space of the cloth at the end of the frame.
+		If the number of bones doesn't change, the previous transforms are used at the start of the frame
+		and the sphere centers are interpolated between the two. Transforms need to be rigid, radii are not scaled.
+		*/
+	virtual void setBoneTransforms(Range<const physx::PxMat44> transforms) = 0;
+	/// Returns the number of bone transforms currently set.
+	virtual uint32_t getNumBoneTransforms() const = 0;
+
+	/** \brief Restrict the spheres and capsules each particle collides with.
+		Bit i of masks[p] enables collision of particle p with sphere i, capsules collide if both of their spheres are enabled.
+		Virtual particles collide with the shapes enabled for any of their triangle particles.
+		masks needs to contain one element per particle, pass an empty range to collide all particles with all shapes.
+		Only supported by the CPU solver.
+		*/
+	virtual void setParticleCollisionMasks(Range<const uint32_t> masks) = 0;
+	/// Returns the number of particle collision masks currently set.
+	virtual uint32_t getNumParticleCollisionMasks() const = 0;
+
 	/** \brief Sets plane values to be used with convex collision detection.
 		The planes are specified in the form ax + by + cz + d = 0, where elements in planes contain PxVec4(x,y,z,d).
 		[x,y,z] is required to be normalized.
@@ -314,9 +404,32 @@ class Cloth : public UserAllocated
 	/// Returns the number of triangles currently set.
 	virtual uint32_t getNumTriangles() const = 0;
 
+	/** \brief Set signed distance fields for collision with static geometry.
+		The fields are referenced, not copied, and can be shared between cloths.
+		poses transform from field space to the local space of the cloth, one pose per field.
+		If the number of fields doesn't change, the poses are interpolated from the previous ones over the frame.
+		Particles collide with friction, and continuous collision applies to the fields as well.
+		Only supported by the CPU solver.
+		*/
+	virtual void setSignedDistanceFields(Range<const SignedDistanceField* const> fields, Range<const physx::PxTransform> poses) = 0;
+	/// Returns the number of signed distance fields currently set.
+	virtual uint32_t getNumSignedDistanceFields() const = 0;
+
+	/** \brief Set height fields for collision with terrain.
+		The height fields are referenced, not copied, and can be shared between cloths.
+		poses transform from height field space to the local space of the cloth, one pose per height field.
+		If the number of height fields doesn't change, the poses are interpolated from the previous ones over the frame.
+		Particles collide with friction. Only supported by the CPU solver.
+		*/
+	virtual void setHeightFields(Range<const HeightField* const> heightFields, Range<const physx::PxTransform> poses) = 0;
+	/// Returns the number of height fields currently set.
+	virtual uint32_t getNumHeightFields() const = 0;
+
 	/// Returns true if we use ccd
 	virtual bool isContinuousCollisionEnabled() const = 0;
-	/// Set if we use ccd or not (disabled by default)
+	/** \brief Set if we use ccd or not (disabled by default)
+		Spheres, capsules, convexes, triangles and signed distance fields are swept against the particle paths.
+		*/
 	virtual void enableContinuousCollision(bool) = 0;
 
 	// controls how quickly mass is increased during collisions
@@ -331,6 +444,8 @@ class Cloth : public UserAllocated
 	// set virtual particles for collision handling.
 	// each indices element consists of 3 particle
 	// indices and an index into the lerp weights array.
+	// virtual particles collide with all shape types,
+	// but only discretely with signed distance fields.
 	virtual void setVirtualParticles(Range<const uint32_t[4]> indices, Range<const physx::PxVec3> weights) = 0;
 	virtual uint32_t getNumVirtualParticles() const = 0;
 	virtual uint32_t getNumVirtualParticleWeights() const = 0;
@@ -367,6 +482,23 @@ class Cloth : public UserAllocated
 	virtual float getMotionConstraintBias() const = 0;
 	virtual void setMotionConstraintStiffness(float stiffness) = 0;
 	virtual float getMotionConstraintStiffness() const = 0;
+	/** \brief Restrict motion constraints to the listed particles.
+		getMotionConstraints() then returns one sphere per index instead of one per particle,
+		and the solver only visits the listed particles. Indices need to be unique.
+		Clears the current motion constraints, pass an empty range to go back to one sphere per particle.
+		Only supported by the CPU solver.
+		*/
+	virtual void setMotionConstraintIndices(Range<const uint32_t> indices) = 0;
+	/// Returns the number of motion constraint indices currently set.
+	virtual uint32_t getNumMotionConstraintIndices() const = 0;
+	/** \brief Reference motion constraints from a caller owned buffer instead of copying them.
+		While set, the buffer replaces the constraints written through getMotionConstraints().
+		It holds one sphere per particle, or one per index if setMotionConstraintIndices() is used.
+		Pass null to go back to getMotionConstraints(). Only supported by the CPU solver.
+		*/
+	virtual void setMotionConstraintBuffer(const ParticleDataBuffer* buffer) = 0;
+	/// Returns the buffer set with setMotionConstraintBuffer().
+	virtual const ParticleDataBuffer* getMotionConstraintBuffer() const = 0;
 
 	/* separation constraint parameters */
 
@@ -375,6 +507,12 @@ class Cloth : public UserAllocated
 	virtual Range<physx::PxVec4> getSeparationConstraints() = 0;
 	virtual void clearSeparationConstraints() = 0;
 	virtual uint32_t getNumSeparationConstraints() const = 0;
+	// restrict separation constraints to the listed particles, see setMotionConstraintIndices()
+	virtual void setSeparationConstraintIndices(Range<const uint32_t> indices) = 0;
+	virtual uint32_t getNumSeparationConstraintIndices() const = 0;
+	// reference separation constraints from a caller owned buffer, see setMotionConstraintBuffer()
+	virtual void setSeparationConstraintBuffer(const ParticleDataBuffer* buffer) = 0;
+	virtual const ParticleDataBuffer* getSeparationConstraintBuffer() const = 0;
 
 	/* clear interpolation */
 
@@ -389,6 +527,10 @@ class Cloth : public UserAllocated
 	virtual Range<physx::PxVec4> getParticleAccelerations() = 0;
 	virtual void clearParticleAccelerations() = 0;
 	virtual uint32_t getNumParticleAccelerations() const = 0;
+	// reference particle accelerations from a caller owned buffer, see setMotionConstraintBuffer()
+	// accelerations are not interpolated, ParticleDataBuffer::mTarget is ignored
+	virtual void setParticleAccelerationBuffer(const ParticleDataBuffer* buffer) = 0;
+	virtual const ParticleDataBuffer* getParticleAccelerationBuffer() const = 0;
 
 	/* wind */
 
@@ -457,6 +599,51 @@ class Cloth : public UserAllocated
 	virtual void putToSleep() = 0;
 	virtual void wakeUp() = 0;
 
+	/* convergence */
+
+	/** \brief Enable measuring the fabric constraint residual, disabled by default.
+		The residual is the average relative length error of the fabric constraints,
+		measured during the last iteration of each frame before the constraints are solved.
+		Only supported by the CPU solver.
+		*/
+	virtual void enableResidualMeasurement(bool) = 0;
+	/// Returns value set with enableResidualMeasurement().
+	virtual bool isResidualMeasurementEnabled() const = 0;
+	/** \brief Adapt the number of iterations to the measured residual, 0 disables (default).
+		While the residual of a frame stays below the tolerance the solver frequency of the following frames
+		is reduced gradually (down to 1/8th), and raised again quickly once the tolerance is exceeded.
+		A positive tolerance measures the residual regardless of enableResidualMeasurement().
+		*/
+	virtual void setResidualTolerance(float) = 0;
+	/// Returns value set with setResidualTolerance().
+	virtual float getResidualTolerance() const = 0;
+	/// Returns the residual of all fabric constraints measured in the previous frame.
+	virtual float getResidual() const = 0;
+	/// Returns the residual measured in the previous frame for each fabric phase, indexed by PhaseConfig::mPhaseIndex.
+	virtual Range<const float> getPhaseResiduals() const = 0;
+
+	/* level of detail */
+
+	/** \brief Set the simulation level of detail importance, clamped to [0, 1].
+		1 (default) simulates the cloth at full detail. Lower values scale down the solver frequency,
+		as configured with setLodConfig(). The CPU solver additionally disables self collision and
+		virtual particle collision, and eventually only simulates every few frames, extrapolating in between.
+		Collision shapes and constraints set during skipped frames only replace the end of the frame state,
+		the next simulated frame interpolates them over all skipped frames.
+		Does not wake up the cloth.
+		*/
+	virtual void setLodImportance(float) = 0;
+	/// Returns value set with setLodImportance().
+	virtual float getLodImportance() const = 0;
+	/** \brief Set the importance from the distance between the camera and the cloth bounds center in world space.
+		The importance is 1 closer than nearDistance and falls off linearly to 0 at farDistance.
+		*/
+	virtual void setLodImportanceFromDistance(const physx::PxVec3& cameraPosition, float nearDistance, float farDistance) = 0;
+	/// Set how the simulation is scaled down with decreasing importance.
+	virtual void setLodConfig(const LodConfig&) = 0;
+	/// Returns value set with setLodConfig().
+	virtual const LodConfig& getLodConfig() const = 0;
+
 	/**  \brief Set user data. Not used internally.	*/
 	virtual void setUserData(void*) = 0;
 	// Returns value set by setUserData().
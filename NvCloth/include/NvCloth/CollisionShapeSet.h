@@ -0,0 +1,61 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2008-2020 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.
+
+#pragma once
+
+#include <foundation/PxVec4.h>
+
+namespace nv
+{
+namespace cloth
+{
+
+/** \brief Set of collision spheres and capsules that can be shared by multiple cloths.
+	Typically holds the bone capsules of a character, updated once per frame and
+	referenced by every cloth the character wears. Each cloth selects a subset of the
+	spheres with a mask, see Cloth::setCollisionShapeSet().
+	The arrays are referenced, not copied, and need to stay valid while a cloth references the set.
+	Spheres are given in the local space of the cloths and interpolated from start to target over the frame.
+	*/
+struct CollisionShapeSet
+{
+	CollisionShapeSet()
+	: mStartSpheres(nullptr), mTargetSpheres(nullptr), mNumSpheres(0), mCapsuleIndices(nullptr), mNumCapsules(0)
+	{
+	}
+
+	const physx::PxVec4* mStartSpheres;  // xyz = center, w = radius, at the start of the frame
+	const physx::PxVec4* mTargetSpheres; // at the end of the frame, null if the spheres don't move
+	uint32_t mNumSpheres;                // at most 32
+	const uint32_t* mCapsuleIndices;     // pairs of sphere indices
+	uint32_t mNumCapsules;               // at most 32
+};
+
+} // namespace cloth
+} // namespace nv
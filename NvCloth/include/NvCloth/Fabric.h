@@ -103,6 +103,27 @@ public:
 	/** Scales all tether lengths.*/
 	virtual void scaleTetherLengths(float) = 0;
 
+	/** \brief Re-encodes rest values, stiffness values and tether lengths as 16 bit integers to reduce the memory footprint.
+		Values are stored relative to a scale per set (per fabric for tether lengths) and are decoded by the solver on the fly.
+		The encoding is lossy with an error of at most 1/65535 of the largest value of a set, and cannot be undone.
+		Should not be called while cloths using this fabric are being simulated.
+		Returns false if the fabric does not support quantization (GPU fabrics).
+	*/
+	virtual bool quantize() = 0;
+	/// Returns true if quantize() has been applied to this fabric.
+	virtual bool isQuantized() const = 0;
+
+	/** \brief Interleaves rest values, particle indices and stiffness values per batch of 4 constraints, so that the CPU solver
+		reads one stream per set instead of three. Only pays off for fabrics whose constraints don't fit into cache (several
+		thousand constraints). The separate arrays are still needed by other solver paths, so this roughly doubles the memory
+		of the constraints. quantize() releases the interleaved copy.
+		Should not be called while cloths using this fabric are being simulated.
+		Returns false if the fabric is quantized or does not support packing (GPU fabrics).
+	*/
+	virtual bool packConstraints() = 0;
+	/// Returns true if the fabric has the interleaved copy built by packConstraints().
+	virtual bool hasPackedConstraints() const = 0;
+
 	void incRefCount()
 	{
 		ps::atomicIncrement(&mRefCount);
@@ -107,6 +107,21 @@ class Factory : public UserAllocated
 	 */
 	virtual Cloth* createCloth(Range<const physx::PxVec4> particles, Fabric& fabric) = 0;
 
+	/**
+	    \brief Create multiple cloth objects sharing the same fabric.
+	    The CPU factory allocates the instances and their particle arrays from a single block of memory,
+	    which is released after the last of them is destroyed. The cloths can be destroyed individually.
+	    @param cloths receives one cloth object per element.
+	    @param particles initial particle positions, fabric.getNumParticles() per cloth, back to back.
+	    @param fabric edge distance constraint structure
+	 */
+	virtual void createCloths(Range<Cloth*> cloths, Range<const physx::PxVec4> particles, Fabric& fabric) = 0;
+
+	/**
+	    \brief Destroy multiple cloth objects, equivalent to NV_CLOTH_DELETE for each of them.
+	 */
+	virtual void destroyCloths(Range<Cloth* const> cloths) = 0;
+
 	/**
 	   \brief Create cloth solver object.
 	 */
@@ -0,0 +1,58 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2008-2020 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.
+
+#pragma once
+
+#include <foundation/PxVec3.h>
+
+namespace nv
+{
+namespace cloth
+{
+
+/** \brief Grid of heights used as terrain collision geometry.
+	The surface is y = height * mScale.y over the xz plane of the field space, starting at the origin.
+	Everything below the surface is solid, particles outside of the grid along x and z don't collide.
+	The heights are referenced, not copied, so a height field can be shared by any number of cloths
+	but needs to stay valid while a cloth references it.
+	*/
+struct HeightField
+{
+	HeightField() : mHeights(nullptr), mScale(1.0f)
+	{
+		mDimensions[0] = mDimensions[1] = 0;
+	}
+
+	const float* mHeights;   // x varies fastest: mHeights[x + z * mDimensions[0]]
+	uint32_t mDimensions[2]; // number of samples along x and z, at least 2
+	physx::PxVec3 mScale;    // distance between samples along x and z, multiplier of the heights along y
+};
+
+} // namespace cloth
+} // namespace nv
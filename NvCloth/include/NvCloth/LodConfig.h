@@ -0,0 +1,61 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2008-2020 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.
+
+#pragma once
+
+#include <foundation/Px.h>
+
+namespace nv
+{
+namespace cloth
+{
+
+/** \brief Controls how the simulation cost of a cloth scales with its LOD importance.
+	The importance is set with Cloth::setLodImportance() and ranges from 0 (background) to 1 (full detail).
+	*/
+struct LodConfig
+{
+	LodConfig()
+		: mMinSolverFrequencyScale(0.25f)
+		, mSelfCollisionThreshold(0.5f)
+		, mVirtualParticleThreshold(0.5f)
+		, mFrameSkipThreshold(0.25f)
+		, mMaxSkippedFrames(3)
+	{
+	}
+
+	float mMinSolverFrequencyScale; // solver frequency scale at importance 0, interpolated linearly to 1 at importance 1
+	float mSelfCollisionThreshold; // self collision is disabled below this importance
+	float mVirtualParticleThreshold; // virtual particle collision is disabled below this importance
+	float mFrameSkipThreshold; // below this importance the cloth is only simulated every few frames
+	uint32_t mMaxSkippedFrames; // number of extrapolated frames between simulated frames at importance 0
+};
+
+} // namespace cloth
+} // namespace nv
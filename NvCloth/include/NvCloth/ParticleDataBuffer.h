@@ -0,0 +1,58 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2008-2020 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.
+
+#pragma once
+
+#include <foundation/PxVec4.h>
+
+namespace nv
+{
+namespace cloth
+{
+
+/** \brief Per particle input data that a cloth references instead of copying it.
+	Lets the application feed motion constraints, separation constraints or particle accelerations
+	straight from its own animation buffers, see Cloth::setMotionConstraintBuffer().
+	The arrays are referenced, not copied, and need to stay valid while a cloth references the buffer.
+	A buffer can be shared by multiple cloths and updated in place between frames.
+	Elements are PxVec4 values mStride bytes apart, the arrays need to be 4 byte aligned.
+	*/
+struct ParticleDataBuffer
+{
+	ParticleDataBuffer() : mStart(nullptr), mTarget(nullptr), mStride(sizeof(physx::PxVec4))
+	{
+	}
+
+	const void* mStart;  // at the start of the frame
+	const void* mTarget; // at the end of the frame, null if the data doesn't change over the frame
+	uint32_t mStride;    // in bytes, at least sizeof(PxVec4)
+};
+
+} // namespace cloth
+} // namespace nv
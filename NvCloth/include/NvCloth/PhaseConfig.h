@@ -43,6 +43,8 @@ struct PhaseConfig
 		, mStiffnessMultiplier(1.0f)
 		, mCompressionLimit(1.0f)
 		, mStretchLimit(1.0f)
+		, mOverRelaxation(1.0f)
+		, mCompliance(-1.0f)
 		, mPhaseIndex(index)
 		, mPadding(0xffff)
 	{
@@ -54,6 +56,15 @@ struct PhaseConfig
 	float mCompressionLimit;
 	float mStretchLimit;
 
+	// over-relaxation factor of the constraint corrections, clamped to [1, 1.9] (default 1 = off)
+	// ramped up over the iterations of a frame following a chebyshev schedule, CPU solver only
+	float mOverRelaxation;
+
+	// compliance (inverse stiffness) of the constraints, in distance per unit force (0 = rigid)
+	// non-negative values solve the phase as xpbd constraints independent of the iteration count,
+	// ignoring mStiffness and mOverRelaxation (default -1 = off), CPU solver only
+	float mCompliance;
+
 	uint16_t mPhaseIndex;
 	uint16_t mPadding;
 };
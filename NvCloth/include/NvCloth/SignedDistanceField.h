@@ -0,0 +1,59 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2008-2020 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.
+
+#pragma once
+
+#include <foundation/PxVec3.h>
+
+namespace nv
+{
+namespace cloth
+{
+
+/** \brief Dense signed distance field volume used as static collision geometry.
+	Distances are negative inside the geometry.
+	The samples are referenced, not copied, so a field can be shared by any number of cloths
+	but needs to stay valid while a cloth references it.
+	Geometry is expected to lie inside the volume, particles outside of it don't collide.
+	*/
+struct SignedDistanceField
+{
+	SignedDistanceField() : mSamples(nullptr), mLowerBound(0.0f), mCellSize(1.0f)
+	{
+		mDimensions[0] = mDimensions[1] = mDimensions[2] = 0;
+	}
+
+	const float* mSamples;      // x varies fastest: mSamples[x + (y + z * mDimensions[1]) * mDimensions[0]]
+	uint32_t mDimensions[3];    // number of samples along each axis, at least 2
+	physx::PxVec3 mLowerBound;  // position of the first sample in field space
+	float mCellSize;            // distance between neighboring samples
+};
+
+} // namespace cloth
+} // namespace nv
@@ -43,6 +43,16 @@ class Cloth;
 // called during inter-collision, user0 and user1 are the user data from each cloth
 typedef bool (*InterCollisionFilter)(void* user0, void* user1);
 
+/// Per cloth result of the frame time budget, see Solver::setFrameTimeBudget().
+struct BudgetAllocation
+{
+	Cloth* mCloth;
+	float mWeight; // priority set with Solver::setClothBudgetWeight()
+	float mCostPerIteration; // measured (or estimated) time of one solver iteration in milliseconds
+	uint32_t mRequestedIterations; // iterations needed for the solver frequency this frame, 0 if the frame is skipped
+	uint32_t mNumIterations; // iterations allocated within the budget
+};
+
 /// base class for solvers
 class Solver : public UserAllocated
 {
@@ -103,6 +113,24 @@ class Solver : public UserAllocated
 	virtual uint32_t getInterCollisionNbIterations() const = 0;
 	virtual void setInterCollisionFilter(InterCollisionFilter filter) = 0;
 
+	/** \brief Set an upper bound for the time spent simulating all cloths in a frame, in milliseconds.
+		The cost of each cloth is measured over the previous frames, and when the requested iterations
+		don't fit the budget the iterations of cloths with the lowest weight are reduced first.
+		Each simulated cloth keeps at least one iteration per frame. Set to 0 to disable (default).
+		Only supported by the CPU solver.
+	*/
+	virtual void setFrameTimeBudget(float milliseconds) = 0;
+	/// Returns value set with setFrameTimeBudget().
+	virtual float getFrameTimeBudget() const = 0;
+	/// Set the frame time budget priority of a cloth added to this solver (default 1).
+	virtual void setClothBudgetWeight(Cloth* cloth, float weight) = 0;
+	/// Returns value set with setClothBudgetWeight().
+	virtual float getClothBudgetWeight(const Cloth* cloth) const = 0;
+	/** \brief Returns the iterations allocated to each cloth by the last beginSimulation() call.
+		Empty if the frame time budget is disabled.
+	*/
+	virtual Range<const BudgetAllocation> getBudgetAllocations() const = 0;
+
 	/// Returns true if an unrecoverable error has occurred.
 	virtual bool hasError() const = 0;
 };
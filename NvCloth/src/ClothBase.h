@@ -66,7 +66,7 @@ void initialize(Cloth& cloth, const physx::PxVec4* pIt, const physx::PxVec4* pEn
 	cloth.mAngularVelocity = physx::PxVec3(0.0f);
 	cloth.mIgnoreVelocityDiscontinuityNextFrame = false;
 	cloth.mPrevIterDt = 0.0f;
-	cloth.mIterDtAvg = MovingAverage(30);
+	cloth.mIterDtAvg.resize(30); // in place, avoids a temporary allocation
 	cloth.mTetherConstraintLogStiffness = float(-FLT_MAX_EXP);
 	cloth.mTetherConstraintScale = 1.0f;
 	cloth.mMotionConstraintScale = 1.0f;
@@ -86,6 +86,14 @@ void initialize(Cloth& cloth, const physx::PxVec4* pIt, const physx::PxVec4* pEn
 	cloth.mSleepThreshold = 0.0f;
 	cloth.mSleepPassCounter = 0;
 	cloth.mSleepTestCounter = 0;
+	cloth.mMeasureResidual = false;
+	cloth.mResidualTolerance = 0.0f;
+	cloth.mResidual = 0.0f;
+	cloth.mResidualFrequencyScale = 1.0f;
+	cloth.mLodConfig = LodConfig();
+	cloth.mLodImportance = 1.0f;
+	cloth.mLodSkippedFrames = 0;
+	cloth.mLodSkippedDt = 0.0f;
 }
 
 template <typename DstCloth, typename SrcCloth>
@@ -126,6 +134,15 @@ void copy(DstCloth& dstCloth, const SrcCloth& srcCloth)
 	dstCloth.mSleepThreshold = srcCloth.mSleepThreshold;
 	dstCloth.mSleepPassCounter = srcCloth.mSleepPassCounter;
 	dstCloth.mSleepTestCounter = srcCloth.mSleepTestCounter;
+	dstCloth.mMeasureResidual = srcCloth.mMeasureResidual;
+	dstCloth.mResidualTolerance = srcCloth.mResidualTolerance;
+	dstCloth.mResidual = srcCloth.mResidual;
+	dstCloth.mResidualFrequencyScale = srcCloth.mResidualFrequencyScale;
+	dstCloth.mPhaseResiduals = srcCloth.mPhaseResiduals;
+	dstCloth.mLodConfig = srcCloth.mLodConfig;
+	dstCloth.mLodImportance = srcCloth.mLodImportance;
+	dstCloth.mLodSkippedFrames = srcCloth.mLodSkippedFrames;
+	dstCloth.mLodSkippedDt = srcCloth.mLodSkippedDt;
 	dstCloth.mUserData = srcCloth.mUserData;
 }
 
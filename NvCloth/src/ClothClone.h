@@ -59,6 +59,12 @@ Range<const T> makeRange(const ps::Array<T, A>& vec)
 	return Range<const T>(ptr, ptr + vec.size());
 }
 
+template <typename T, typename A>
+Range<const T> makeRange(const SharedArray<ps::Array<T, A> >& vec)
+{
+	return Range<const T>(vec.begin(), vec.end());
+}
+
 // fabric conversion
 template <typename SrcClothType, typename DstFactoryType>
 typename DstFactoryType::FabricType* convertFabric(const SrcClothType& srcFabric, DstFactoryType& dstFactory)
@@ -123,6 +129,24 @@ inline Range<const uint32_t> getSelfCollisionIndices(const SwCloth& cloth)
 {
 	return makeRange(cloth.mSelfCollisionIndices);
 }
+inline Range<const uint32_t> getMotionConstraintIndices(const SwCloth& cloth)
+{
+	return makeRange(cloth.mMotionConstraints.mIndices);
+}
+inline Range<const uint32_t> getSeparationConstraintIndices(const SwCloth& cloth)
+{
+	return makeRange(cloth.mSeparationConstraints.mIndices);
+}
+
+// spread sparse constraints over one constraint per particle, for cloths that don't support indices
+inline void scatterConstraints(Range<physx::PxVec4> dst, Range<const physx::PxVec4> src, Range<const uint32_t> indices,
+                               const physx::PxVec4& unconstrained)
+{
+	for (physx::PxVec4* it = dst.begin(); it < dst.end(); ++it)
+		*it = unconstrained;
+	for (uint32_t i = 0; i < indices.size(); ++i)
+		dst[indices[i]] = src[i];
+}
 
 // cloth conversion
 template <typename DstFactoryType, typename SrcClothType>
@@ -179,12 +203,33 @@ typename DstFactoryType::ClothType* convertCloth(DstFactoryType& dstFactory, con
 	dstCloth->setTriangles(triangleRange, 0, 0);
 
 	// motion constraints, copy directly into new cloth buffer
-	if (srcCloth.getNumMotionConstraints())
+	Range<const uint32_t> motionIndices = getMotionConstraintIndices(srcCloth);
+	dstCloth->setMotionConstraintIndices(motionIndices);
+	if (srcCloth.getNumMotionConstraints() && dstCloth->getNumMotionConstraintIndices() == motionIndices.size())
 		srcFactory.extractMotionConstraints(srcCloth, dstCloth->getMotionConstraints());
+	else if (srcCloth.getNumMotionConstraints())
+	{
+		// radius large enough to not constrain the particles that are not listed
+		Vector<physx::PxVec4>::Type constraints(srcCloth.getNumMotionConstraints());
+		srcFactory.extractMotionConstraints(srcCloth, makeRange(constraints));
+		scatterConstraints(dstCloth->getMotionConstraints(), makeRange(constraints), motionIndices,
+		                   physx::PxVec4(0.0f, 0.0f, 0.0f, FLT_MAX));
+	}
 
 	// separation constraints, copy directly into new cloth buffer
-	if (srcCloth.getNumSeparationConstraints())
+	Range<const uint32_t> separationIndices = getSeparationConstraintIndices(srcCloth);
+	dstCloth->setSeparationConstraintIndices(separationIndices);
+	if (srcCloth.getNumSeparationConstraints() &&
+	    dstCloth->getNumSeparationConstraintIndices() == separationIndices.size())
 		srcFactory.extractSeparationConstraints(srcCloth, dstCloth->getSeparationConstraints());
+	else if (srcCloth.getNumSeparationConstraints())
+	{
+		// zero radius doesn't separate the particles that are not listed
+		Vector<physx::PxVec4>::Type constraints(srcCloth.getNumSeparationConstraints());
+		srcFactory.extractSeparationConstraints(srcCloth, makeRange(constraints));
+		scatterConstraints(dstCloth->getSeparationConstraints(), makeRange(constraints), separationIndices,
+		                   physx::PxVec4(0.0f));
+	}
 
 	// particle accelerations
 	if (srcCloth.getNumParticleAccelerations())
@@ -194,6 +239,11 @@ typename DstFactoryType::ClothType* convertCloth(DstFactoryType& dstFactory, con
 		          accelerations.size() * sizeof(physx::PxVec4));
 	}
 
+	// caller owned input buffers are referenced, not copied
+	dstCloth->setMotionConstraintBuffer(srcCloth.getMotionConstraintBuffer());
+	dstCloth->setSeparationConstraintBuffer(srcCloth.getSeparationConstraintBuffer());
+	dstCloth->setParticleAccelerationBuffer(srcCloth.getParticleAccelerationBuffer());
+
 	// self-collision indices
 	dstCloth->setSelfCollisionIndices(getSelfCollisionIndices(srcCloth));
 
@@ -192,6 +192,30 @@ class ClothImpl : public Cloth
 	virtual bool isSleeping() const;
 	virtual void wakeUp();
 
+	virtual void enableResidualMeasurement(bool);
+	virtual bool isResidualMeasurementEnabled() const;
+	virtual void setResidualTolerance(float);
+	virtual float getResidualTolerance() const;
+	virtual float getResidual() const;
+	virtual Range<const float> getPhaseResiduals() const;
+
+	// convergence helpers used by the solvers
+	bool isResidualMeasured() const;
+	void updateResidual(float residual);
+
+	virtual void setLodImportance(float);
+	virtual float getLodImportance() const;
+	virtual void setLodImportanceFromDistance(const physx::PxVec3& cameraPosition, float nearDistance, float farDistance);
+	virtual void setLodConfig(const LodConfig&);
+	virtual const LodConfig& getLodConfig() const;
+
+	// level of detail helpers used by the solvers
+	float getLodSolverFrequencyScale() const;
+	float getEffectiveSolverFrequency() const;
+	uint32_t getLodFrameInterval() const;
+	bool isLodSelfCollisionEnabled() const;
+	bool isLodVirtualParticleCollisionEnabled() const;
+
 	virtual void setUserData(void*);
 	virtual void* getUserData() const;
 
@@ -234,6 +258,19 @@ public: //Fields shared between all cloth classes
 	float mSleepThreshold;       // max movement delta to pass test
 	uint32_t mSleepPassCounter;  // how many tests passed
 	uint32_t mSleepTestCounter;  // how many iterations since tested
+
+	// convergence
+	bool mMeasureResidual;
+	float mResidualTolerance;
+	float mResidual;
+	float mResidualFrequencyScale; // solver frequency scale adapted to the residual
+	Vector<float>::Type mPhaseResiduals;
+
+	// level of detail
+	LodConfig mLodConfig;
+	float mLodImportance;
+	uint32_t mLodSkippedFrames; // frames extrapolated since the last simulated frame
+	float mLodSkippedDt; // time extrapolated since the last simulated frame
 };
 
 template <typename T>
@@ -1475,6 +1512,143 @@ inline void ClothImpl<T>::wakeUp()
 	mSleepPassCounter = 0;
 }
 
+template <typename T>
+inline void ClothImpl<T>::enableResidualMeasurement(bool enable)
+{
+	mMeasureResidual = enable;
+}
+
+template <typename T>
+inline bool ClothImpl<T>::isResidualMeasurementEnabled() const
+{
+	return mMeasureResidual;
+}
+
+template <typename T>
+inline void ClothImpl<T>::setResidualTolerance(float tolerance)
+{
+	if (tolerance == mResidualTolerance)
+		return;
+
+	mResidualTolerance = tolerance;
+	mResidualFrequencyScale = 1.0f;
+	wakeUp();
+}
+
+template <typename T>
+inline float ClothImpl<T>::getResidualTolerance() const
+{
+	return mResidualTolerance;
+}
+
+template <typename T>
+inline float ClothImpl<T>::getResidual() const
+{
+	return mResidual;
+}
+
+template <typename T>
+inline Range<const float> ClothImpl<T>::getPhaseResiduals() const
+{
+	return Range<const float>(mPhaseResiduals.begin(), mPhaseResiduals.end());
+}
+
+template <typename T>
+inline bool ClothImpl<T>::isResidualMeasured() const
+{
+	return mMeasureResidual || mResidualTolerance > 0.0f;
+}
+
+// adapt the solver frequency of the next frame to the residual of the current frame
+template <typename T>
+inline void ClothImpl<T>::updateResidual(float residual)
+{
+	mResidual = residual;
+
+	if (mResidualTolerance <= 0.0f)
+		return;
+
+	// back off slowly while converged, recover quickly when disturbed
+	if (residual < mResidualTolerance)
+		mResidualFrequencyScale = std::max(mResidualFrequencyScale * 0.9f, 0.125f);
+	else
+		mResidualFrequencyScale = std::min(mResidualFrequencyScale * 2.0f, 1.0f);
+}
+
+template <typename T>
+inline void ClothImpl<T>::setLodImportance(float importance)
+{
+	importance = physx::PxClamp(importance, 0.0f, 1.0f);
+	if (importance == mLodImportance)
+		return;
+
+	mLodImportance = importance;
+}
+
+template <typename T>
+inline float ClothImpl<T>::getLodImportance() const
+{
+	return mLodImportance;
+}
+
+template <typename T>
+inline void ClothImpl<T>::setLodImportanceFromDistance(const physx::PxVec3& cameraPosition, float nearDistance,
+                                                       float farDistance)
+{
+	physx::PxVec3 center = mTargetMotion.transform(mParticleBoundsCenter);
+	float distance = (cameraPosition - center).magnitude();
+	float range = farDistance - nearDistance;
+	setLodImportance(range > 0.0f ? 1.0f - (distance - nearDistance) / range : float(distance <= nearDistance));
+}
+
+template <typename T>
+inline void ClothImpl<T>::setLodConfig(const LodConfig& config)
+{
+	mLodConfig = config;
+}
+
+template <typename T>
+inline const LodConfig& ClothImpl<T>::getLodConfig() const
+{
+	return mLodConfig;
+}
+
+template <typename T>
+inline float ClothImpl<T>::getLodSolverFrequencyScale() const
+{
+	float minScale = physx::PxClamp(mLodConfig.mMinSolverFrequencyScale, 0.0f, 1.0f);
+	return minScale + (1.0f - minScale) * mLodImportance;
+}
+
+template <typename T>
+inline float ClothImpl<T>::getEffectiveSolverFrequency() const
+{
+	return mSolverFrequency * getLodSolverFrequencyScale() * mResidualFrequencyScale;
+}
+
+template <typename T>
+inline uint32_t ClothImpl<T>::getLodFrameInterval() const
+{
+	if (mLodImportance >= mLodConfig.mFrameSkipThreshold)
+		return 1;
+
+	// ramp up to mMaxSkippedFrames extrapolated frames at importance 0
+	float t = 1.0f - mLodImportance / mLodConfig.mFrameSkipThreshold;
+	return 1 + uint32_t(t * mLodConfig.mMaxSkippedFrames + 0.5f);
+}
+
+template <typename T>
+inline bool ClothImpl<T>::isLodSelfCollisionEnabled() const
+{
+	return mLodImportance >= mLodConfig.mSelfCollisionThreshold;
+}
+
+template <typename T>
+inline bool ClothImpl<T>::isLodVirtualParticleCollisionEnabled() const
+{
+	return mLodImportance >= mLodConfig.mVirtualParticleThreshold;
+}
+
 template <typename T>
 inline void ClothImpl<T>::setUserData(void* data)
 {
@@ -0,0 +1,92 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2008-2020 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.
+
+#pragma once
+
+#include <foundation/Px.h>
+
+namespace nv
+{
+namespace cloth
+{
+
+// 16 bit float conversion, rounds to nearest even and saturates instead of producing infinities
+inline uint16_t floatToHalf(float f)
+{
+	union
+	{
+		float f;
+		uint32_t u;
+	} value;
+	value.f = f;
+
+	uint32_t sign = (value.u >> 16) & 0x8000;
+	value.u &= 0x7fffffff;
+
+	// larger than the largest half, or NaN
+	if (value.u > 0x477fe000)
+		return uint16_t(sign | 0x7bff);
+
+	// smaller than the smallest normal half, let the fpu round the mantissa
+	if (value.u < 0x38800000)
+	{
+		union
+		{
+			uint32_t u;
+			float f;
+		} denormMagic;
+		denormMagic.u = ((127 - 15) + (23 - 10) + 1) << 23;
+		value.f += denormMagic.f;
+		return uint16_t(sign | (value.u - denormMagic.u));
+	}
+
+	// rebias exponent and round mantissa
+	uint32_t mantissaOdd = (value.u >> 13) & 1;
+	value.u -= (127 - 15) << 23;
+	value.u += 0xfff + mantissaOdd;
+	return uint16_t(sign | (value.u >> 13));
+}
+
+// inverse of the above, denormals are rebiased by the multiply
+inline float halfToFloat(uint16_t h)
+{
+	union
+	{
+		uint32_t u;
+		float f;
+	} value, magic;
+	magic.u = (254 - 15) << 23;
+	value.u = uint32_t(h & 0x7fff) << 13;
+	value.f *= magic.f;
+	value.u |= uint32_t(h & 0x8000) << 16;
+	return value.f;
+}
+
+} // namespace cloth
+} // namespace nv
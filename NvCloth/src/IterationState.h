@@ -36,6 +36,7 @@
 #include <foundation/PxMat33.h>
 #include "Vec4T.h"
 #include <algorithm>
+#include <climits>
 #include "NvCloth/ps/PsMathUtils.h"
 
 namespace nv
@@ -97,7 +98,7 @@ struct IterationState; // forward declaration
 struct IterationStateFactory
 {
 	template <typename MyCloth>
-	IterationStateFactory(MyCloth& cloth, float frameDt);
+	IterationStateFactory(MyCloth& cloth, float frameDt, int maxIterations = INT_MAX);
 
 	template <typename T4f, typename MyCloth>
 	IterationState<T4f> create(MyCloth const& cloth) const;
@@ -170,9 +171,9 @@ inline float cloth::IterationState<T4f>::getPreviousAlpha() const
 }
 
 template <typename MyCloth>
-cloth::IterationStateFactory::IterationStateFactory(MyCloth& cloth, float frameDt)
+cloth::IterationStateFactory::IterationStateFactory(MyCloth& cloth, float frameDt, int maxIterations)
 {
-	mNumIterations = std::max(1, int(frameDt * cloth.mSolverFrequency + 0.5f));
+	mNumIterations = std::max(1, std::min(maxIterations, int(frameDt * cloth.getEffectiveSolverFrequency() + 0.5f)));
 	mInvNumIterations = 1.0f / mNumIterations;
 	mIterDt = frameDt * mInvNumIterations;
 
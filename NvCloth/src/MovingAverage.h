@@ -153,6 +153,42 @@ struct MovingAverage
 		return sum / static_cast<float>(totalWeight);
 	}
 
+	// snapshot support, see SwCloth::saveState()
+	struct State
+	{
+		uint32_t mSize;
+		int32_t mBegin;
+		int32_t mCount;
+
+		bool isValid() const
+		{
+			return mSize && mBegin >= 0 && mBegin < int32_t(mSize) && mCount >= 0 && mCount <= int32_t(mSize);
+		}
+	};
+
+	State getState() const
+	{
+		State state = { uint32_t(mSize), mBegin, mCount };
+		return state;
+	}
+
+	template <typename Writer>
+	void writeData(Writer& writer) const
+	{
+		writer.write(mData, uint32_t(mSize));
+	}
+
+	template <typename Reader>
+	void readData(const State& state, Reader& reader)
+	{
+		NV_CLOTH_ASSERT(state.isValid());
+		if (int32_t(state.mSize) != mSize)
+			resize(state.mSize);
+		reader.read(mData, state.mSize);
+		mBegin = state.mBegin;
+		mCount = state.mCount;
+	}
+
 private:
 	float* mData; //Ring buffer
 	int32_t mBegin; //Index to first element
@@ -57,5 +57,8 @@ cloth::PhaseConfig cloth::transform(const PhaseConfig& config)
 	result.mCompressionLimit = 1.f - 1.f / config.mCompressionLimit;
 	result.mStretchLimit = 1.f - 1.f / config.mStretchLimit;
 
+	result.mOverRelaxation = std::min(std::max(config.mOverRelaxation, 1.0f), 1.9f);
+	result.mCompliance = config.mCompliance < 0.0f ? -1.0f : config.mCompliance;
+
 	return result;
 }
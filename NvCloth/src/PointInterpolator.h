@@ -108,6 +108,38 @@ class UnalignedIterator
 	const float* mPointer;
 };
 
+// iterates over elements of a caller owned buffer a byte stride apart, starting at element first
+template <typename T4f>
+class StridedIterator
+{
+  public:
+	StridedIterator(const float* pointer, uint32_t stride, uint32_t first)
+	: mPointer(reinterpret_cast<const char*>(pointer) + size_t(first) * stride), mStride(stride)
+	{
+	}
+
+	inline T4f operator[](size_t index) const
+	{
+		return load(reinterpret_cast<const float*>(mPointer + index * mStride));
+	}
+
+	inline T4f operator*() const
+	{
+		return (*this)[0];
+	}
+
+	// prefix increment only
+	inline StridedIterator& operator ++ ()
+	{
+		mPointer += mStride;
+		return *this;
+	}
+
+  private:
+	const char* mPointer;
+	size_t mStride;
+};
+
 // acts as an iterator but returns a constant
 template <typename T4f>
 class ConstantIterator
@@ -0,0 +1,174 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2008-2020 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.
+
+#pragma once
+
+#include "NvCloth/Allocator.h"
+#include "NvCloth/ps/PsAtomic.h"
+
+namespace nv
+{
+namespace cloth
+{
+
+template <typename ArrayType>
+class SharedArray;
+
+// copy-on-write wrapper around ps::Array, copies share the elements
+// until one of them is modified, only then the elements are duplicated
+template <typename T, typename Alloc>
+class SharedArray<ps::Array<T, Alloc> >
+{
+  public:
+	typedef ps::Array<T, Alloc> ArrayType;
+
+	SharedArray() : mStorage(nullptr)
+	{
+	}
+	SharedArray(const SharedArray& other) : mStorage(other.acquire())
+	{
+	}
+	~SharedArray()
+	{
+		release();
+	}
+	SharedArray& operator = (const SharedArray& other)
+	{
+		Storage* storage = other.acquire();
+		release();
+		mStorage = storage;
+		return *this;
+	}
+
+	bool empty() const
+	{
+		return !mStorage || mStorage->mArray.empty();
+	}
+	uint32_t size() const
+	{
+		return mStorage ? mStorage->mArray.size() : 0;
+	}
+	const T* begin() const
+	{
+		return mStorage ? mStorage->mArray.begin() : nullptr;
+	}
+	const T* end() const
+	{
+		return mStorage ? mStorage->mArray.end() : nullptr;
+	}
+	const T& front() const
+	{
+		NV_CLOTH_ASSERT(!empty());
+		return mStorage->mArray.front();
+	}
+	const T& operator[](uint32_t i) const
+	{
+		NV_CLOTH_ASSERT(i < size());
+		return mStorage->mArray[i];
+	}
+
+	// modifiers, duplicate the elements first if they are shared
+	void assign(const T* first, const T* last)
+	{
+		mutate(false).assign(first, last);
+	}
+	void resize(uint32_t size, const T& a = T())
+	{
+		mutate(true).resize(size, a);
+	}
+	void reserve(uint32_t capacity)
+	{
+		mutate(true).reserve(capacity);
+	}
+	void pushBack(const T& a)
+	{
+		mutate(true).pushBack(a);
+	}
+	void swap(ArrayType& other)
+	{
+		mutate(false).swap(other);
+	}
+	void clear()
+	{
+		if (mStorage && mStorage->mRefCount == 1)
+			mStorage->mArray.clear();
+		else
+			reset();
+	}
+
+	// drops the elements and their memory
+	void reset()
+	{
+		release();
+		mStorage = nullptr;
+	}
+
+  private:
+	struct Storage : public UserAllocated
+	{
+		Storage() : mRefCount(1)
+		{
+		}
+		explicit Storage(const ArrayType& array) : mRefCount(1), mArray(array)
+		{
+		}
+
+		int32_t mRefCount;
+		ArrayType mArray;
+	};
+
+	Storage* acquire() const
+	{
+		if (mStorage)
+			ps::atomicIncrement(&mStorage->mRefCount);
+		return mStorage;
+	}
+
+	void release()
+	{
+		if (mStorage && !ps::atomicDecrement(&mStorage->mRefCount))
+			NV_CLOTH_DELETE(mStorage);
+	}
+
+	ArrayType& mutate(bool keepElements)
+	{
+		if (!mStorage || mStorage->mRefCount > 1)
+		{
+			Storage* storage = mStorage && keepElements ? NV_CLOTH_NEW(Storage)(mStorage->mArray) : NV_CLOTH_NEW(Storage)();
+			release();
+			mStorage = storage;
+		}
+		return mStorage->mArray;
+	}
+
+	Storage* mStorage;
+};
+
+} // namespace cloth
+} // namespace nv
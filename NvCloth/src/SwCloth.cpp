@@ -32,8 +32,11 @@
 #include "SwFactory.h"
 #include "TripletScheduler.h"
 #include "ClothBase.h"
+#include "HalfFloat.h"
 #include <foundation/PxMat44.h>
 #include "NvCloth/Allocator.h"
+#include <algorithm>
+#include <cstring> // for memcmp
 
 using namespace physx;
 
@@ -47,27 +50,49 @@ PhaseConfig transform(const PhaseConfig&); // from PhaseConfig.cpp
 
 using namespace nv;
 
-cloth::SwCloth::SwCloth(SwFactory& factory, SwFabric& fabric, Range<const PxVec4> particles)
-: mFactory(factory), mFabric(fabric), mNumVirtualParticles(0), mUserData(0)
+namespace
+{
+// array referencing memory it doesn't own, only used to hand the memory to a regular array
+template <typename T>
+struct UserMemoryVector : public nv::cloth::Vector<T>::Type
+{
+	UserMemoryVector(T* memory, uint32_t capacity) : nv::cloth::Vector<T>::Type(memory, 0, capacity)
+	{
+	}
+};
+}
+
+cloth::SwCloth::SwCloth(SwFactory& factory, SwFabric& fabric, Range<const PxVec4> particles, PxVec4* particleMemory)
+: mFactory(factory)
+, mFabric(fabric)
+, mPrevParticleMemory(particleMemory ? particleMemory + getParticleCapacity(particles.size()) : nullptr)
+, mCompressPrevParticles(false)
+, mParticleAccelerationBuffer(nullptr)
+, mCollisionShapeSet(nullptr)
+, mCollisionShapeSetMask(0xffffffff)
+, mNumVirtualParticles(0)
+, mUserData(0)
 {
 	NV_CLOTH_ASSERT(!particles.empty());
 
 	initialize(*this, particles.begin(), particles.end());
 
-#if PX_WINDOWS_FAMILY
-	const uint32_t kSimdWidth = 8; // avx
-#else
-	const uint32_t kSimdWidth = 4; // sse
-#endif
-
 	NV_CLOTH_ASSERT(particles.size() == fabric.getNumParticles());
 
-	mCurParticles.reserve(particles.size() + kSimdWidth - 1);
+	uint32_t capacity = getParticleCapacity(particles.size());
+	if (particleMemory)
+	{
+		// current and previous particles live in the caller's block
+		UserMemoryVector<PxVec4>(particleMemory, capacity).swap(mCurParticles);
+		UserMemoryVector<PxVec4>(mPrevParticleMemory, capacity).swap(mPrevParticles);
+	}
+
+	mCurParticles.reserve(capacity);
 	mCurParticles.assign(reinterpret_cast<const PxVec4*>(particles.begin()),
 	                     reinterpret_cast<const PxVec4*>(particles.end()));
 
 	// 7 dummy particles used in SIMD solver
-	mCurParticles.resize(particles.size() + kSimdWidth - 1, PxVec4(0.0f));
+	mCurParticles.resize(capacity, PxVec4(0.0f));
 	mPrevParticles = mCurParticles;
 
 	mCurParticles.resize(particles.size());
@@ -88,13 +113,29 @@ void copyVector(nv::cloth::Vector<PxVec4>::Type& dst, const nv::cloth::Vector<Px
 	dst.resize(src.capacity(), PxVec4(0.0f));
 	dst.resize(src.size());
 }
+
+// copy indices and pad the same capacity with the dummy particle
+void copyVector(nv::cloth::Vector<uint32_t>::Type& dst, const nv::cloth::Vector<uint32_t>::Type& src, uint32_t dummyIndex)
+{
+	dst.reserve(src.capacity());
+	dst.assign(src.begin(), src.end());
+	dst.resize(src.capacity(), dummyIndex);
+	dst.resize(src.size());
+}
 }
 
 // copy constructor, supports rebinding to a different factory
 cloth::SwCloth::SwCloth(SwFactory& factory, const SwCloth& cloth)
 : mFactory(factory)
 , mFabric(cloth.mFabric)
+, mPrevParticleMemory(nullptr)
+, mCompressedPrevParticles(cloth.mCompressedPrevParticles)
+, mPrevInvMasses(cloth.mPrevInvMasses)
+, mCompressPrevParticles(cloth.mCompressPrevParticles)
 , mPhaseConfigs(cloth.mPhaseConfigs)
+, mConstraintCompliances(cloth.mConstraintCompliances)
+, mConstraintMultipliers(cloth.mConstraintMultipliers)
+, mParticleAccelerationBuffer(cloth.mParticleAccelerationBuffer)
 , mCapsuleIndices(cloth.mCapsuleIndices)
 , mStartCollisionSpheres(cloth.mStartCollisionSpheres)
 , mTargetCollisionSpheres(cloth.mTargetCollisionSpheres)
@@ -102,6 +143,19 @@ cloth::SwCloth::SwCloth(SwFactory& factory, const SwCloth& cloth)
 , mTargetCollisionPlanes(cloth.mTargetCollisionPlanes)
 , mStartCollisionTriangles(cloth.mStartCollisionTriangles)
 , mTargetCollisionTriangles(cloth.mTargetCollisionTriangles)
+, mSignedDistanceFields(cloth.mSignedDistanceFields)
+, mStartSignedDistanceFieldPoses(cloth.mStartSignedDistanceFieldPoses)
+, mTargetSignedDistanceFieldPoses(cloth.mTargetSignedDistanceFieldPoses)
+, mHeightFields(cloth.mHeightFields)
+, mStartHeightFieldPoses(cloth.mStartHeightFieldPoses)
+, mTargetHeightFieldPoses(cloth.mTargetHeightFieldPoses)
+, mCollisionShapeSet(cloth.mCollisionShapeSet)
+, mCollisionShapeSetMask(cloth.mCollisionShapeSetMask)
+, mBoneSpheres(cloth.mBoneSpheres)
+, mSphereBoneIndices(cloth.mSphereBoneIndices)
+, mStartBoneTransforms(cloth.mStartBoneTransforms)
+, mTargetBoneTransforms(cloth.mTargetBoneTransforms)
+, mParticleCollisionMasks(cloth.mParticleCollisionMasks)
 , mVirtualParticleIndices(cloth.mVirtualParticleIndices)
 , mVirtualParticleWeights(cloth.mVirtualParticleWeights)
 , mNumVirtualParticles(cloth.mNumVirtualParticles)
@@ -117,6 +171,10 @@ cloth::SwCloth::SwCloth(SwFactory& factory, const SwCloth& cloth)
 	copyVector(mMotionConstraints.mTarget, cloth.mMotionConstraints.mTarget);
 	copyVector(mSeparationConstraints.mStart, cloth.mSeparationConstraints.mStart);
 	copyVector(mSeparationConstraints.mTarget, cloth.mSeparationConstraints.mTarget);
+	copyVector(mMotionConstraints.mIndices, cloth.mMotionConstraints.mIndices, uint32_t(mCurParticles.size()));
+	copyVector(mSeparationConstraints.mIndices, cloth.mSeparationConstraints.mIndices, uint32_t(mCurParticles.size()));
+	mMotionConstraints.mBuffer = cloth.mMotionConstraints.mBuffer;
+	mSeparationConstraints.mBuffer = cloth.mSeparationConstraints.mBuffer;
 	copyVector(mParticleAccelerations, cloth.mParticleAccelerations);
 
 	//Both cloth and this have a reference to fabric. The factory that created fabric does not have to be the same as mFactory.
@@ -129,6 +187,41 @@ cloth::SwCloth::~SwCloth()
 	mFabric.decRefCount();
 }
 
+uint32_t cloth::SwCloth::getParticleCapacity(uint32_t numParticles)
+{
+#if PX_WINDOWS_FAMILY
+	const uint32_t kSimdWidth = 8; // avx
+#else
+	const uint32_t kSimdWidth = 4; // sse
+#endif
+	return numParticles + kSimdWidth - 1;
+}
+
+void* cloth::SwCloth::operator new(size_t size, const char* fileName, int line, NvClothOverload)
+{
+	void* header = GetNvClothAllocator()->allocate(sAllocationHeaderSize + size, "SwCloth", fileName, line);
+	*reinterpret_cast<SwClothBlock**>(header) = nullptr;
+	return reinterpret_cast<char*>(header) + sAllocationHeaderSize;
+}
+
+void cloth::SwCloth::operator delete(void* ptr, const char*, int, NvClothOverload)
+{
+	operator delete(ptr);
+}
+
+void cloth::SwCloth::operator delete(void* ptr)
+{
+	if (!ptr)
+		return;
+
+	void* header = reinterpret_cast<char*>(ptr) - sAllocationHeaderSize;
+	SwClothBlock* block = *reinterpret_cast<SwClothBlock**>(header);
+	if (!block)
+		GetNvClothAllocator()->deallocate(header);
+	else if (!ps::atomicDecrement(&block->mRefCount))
+		GetNvClothAllocator()->deallocate(block);
+}
+
 // bounds = lower[3], upper[3]
 void cloth::SwCloth::setParticleBounds(const float* bounds)
 {
@@ -139,9 +232,100 @@ void cloth::SwCloth::setParticleBounds(const float* bounds)
 	}
 }
 
-cloth::Range<PxVec4> cloth::SwCloth::push(SwConstraints& constraints)
+void cloth::SwCollisionCache::update(const PxVec4* spheres, uint32_t numSpheres, const IndexPair* capsuleIndices,
+                                     uint32_t numCapsules, uint32_t sphereMask)
 {
+	if (mSphereMask == sphereMask && mSpheres.size() == numSpheres && mCapsuleIndices.size() == numCapsules &&
+	    !memcmp(mSpheres.begin(), spheres, numSpheres * sizeof(PxVec4)) &&
+	    !memcmp(mCapsuleIndices.begin(), capsuleIndices, numCapsules * sizeof(IndexPair)))
+		return;
+
+	mSpheres.assign(spheres, spheres + numSpheres);
+	mCapsuleIndices.assign(capsuleIndices, capsuleIndices + numCapsules);
+	mSphereMask = sphereMask;
+	mValid = false;
+}
+
+// full precision previous particles with the same dummy particles as the constructor, contents undefined
+// uses the capacity sized memory if given, otherwise the SwClothBlock region of bulk created cloths or the heap
+void cloth::SwCloth::allocatePrevParticles(PxVec4* memory)
+{
+	NV_CLOTH_ASSERT(mPrevParticles.empty());
+
 	uint32_t n = uint32_t(mCurParticles.size());
+	uint32_t capacity = mCurParticles.capacity();
+	if (!memory)
+		memory = mPrevParticleMemory;
+	if (memory)
+		UserMemoryVector<PxVec4>(memory, capacity).swap(mPrevParticles);
+	mPrevParticles.reserve(capacity);
+	mPrevParticles.resizeUninitialized(capacity);
+	for (PxVec4* it = mPrevParticles.begin() + n; it != mPrevParticles.end(); ++it)
+		*it = PxVec4(0.0f);
+	mPrevParticles.resizeUninitialized(n);
+}
+
+// store previous particles as offsets from the current ones and their inverse masses,
+// and release the full precision copy
+void cloth::SwCloth::compressPrevParticles()
+{
+	if (!mCompressPrevParticles || mPrevParticles.empty())
+		return;
+
+	uint32_t n = uint32_t(mCurParticles.size());
+	mCompressedPrevParticles.resizeUninitialized(n);
+	mPrevInvMasses.resizeUninitialized(n);
+
+	const PxVec4* curIt = mCurParticles.begin();
+	const PxVec4* prevIt = mPrevParticles.begin();
+	SwCompressedParticle* cIt = mCompressedPrevParticles.begin();
+	float* wIt = mPrevInvMasses.begin();
+	for (const PxVec4* curEnd = mCurParticles.end(); curIt != curEnd; ++curIt, ++prevIt, ++cIt, ++wIt)
+	{
+		cIt->mOffset[0] = floatToHalf(prevIt->x - curIt->x);
+		cIt->mOffset[1] = floatToHalf(prevIt->y - curIt->y);
+		cIt->mOffset[2] = floatToHalf(prevIt->z - curIt->z);
+		*wIt = prevIt->w;
+	}
+
+	Vector<PxVec4>::Type().swap(mPrevParticles);
+	Vector<PxVec4>::Type().swap(mDecodedPrevParticles);
+}
+
+// expand the previous particles to full precision until the next compressPrevParticles(),
+// the compressed copy is released
+void cloth::SwCloth::decompressPrevParticles()
+{
+	if (!mPrevParticles.empty())
+		return;
+
+	allocatePrevParticles();
+	decodePrevParticles(mPrevParticles.begin());
+
+	Vector<SwCompressedParticle>::Type().swap(mCompressedPrevParticles);
+	Vector<float>::Type().swap(mPrevInvMasses);
+	Vector<PxVec4>::Type().swap(mDecodedPrevParticles);
+}
+
+// writes the full precision previous particles to prevIt without changing the cloth
+void cloth::SwCloth::decodePrevParticles(PxVec4* prevIt) const
+{
+	const PxVec4* curIt = mCurParticles.begin();
+	const SwCompressedParticle* cIt = mCompressedPrevParticles.begin();
+	const float* wIt = mPrevInvMasses.begin();
+	for (const PxVec4* curEnd = mCurParticles.end(); curIt != curEnd; ++curIt, ++prevIt, ++cIt, ++wIt)
+	{
+		prevIt->x = curIt->x + halfToFloat(cIt->mOffset[0]);
+		prevIt->y = curIt->y + halfToFloat(cIt->mOffset[1]);
+		prevIt->z = curIt->z + halfToFloat(cIt->mOffset[2]);
+		prevIt->w = *wIt;
+	}
+}
+
+cloth::Range<PxVec4> cloth::SwCloth::push(SwConstraints& constraints)
+{
+	// one constraint per particle, or one per index if sparse
+	uint32_t n = uint32_t(constraints.mIndices.empty() ? mCurParticles.size() : constraints.mIndices.size());
 
 	if (!constraints.mTarget.capacity())
 		constraints.mTarget.resize((n + 3) & ~3, PxVec4(0.0f)); // reserve multiple of 4 for SIMD
@@ -162,6 +346,31 @@ void cloth::SwCloth::clear(SwConstraints& constraints)
 	Vector<PxVec4>::Type().swap(constraints.mTarget);
 }
 
+void cloth::SwCloth::setIndices(SwConstraints& constraints, Range<const uint32_t> indices)
+{
+#if PX_DEBUG
+	for (const uint32_t* it = indices.begin(); it < indices.end(); ++it)
+		NV_CLOTH_ASSERT(*it < mCurParticles.size());
+#endif
+
+	ContextLockType lock(mFactory);
+	clear(constraints);
+
+	uint32_t n = indices.size();
+	Vector<uint32_t>::Type().swap(constraints.mIndices);
+	if (n)
+	{
+		constraints.mIndices.reserve((n + 3) & ~3);
+		constraints.mIndices.assign(indices.begin(), indices.end());
+
+		// pad with the first dummy particle for SIMD
+		constraints.mIndices.resize((n + 3) & ~3, uint32_t(mCurParticles.size()));
+		constraints.mIndices.resize(n);
+	}
+
+	wakeUp();
+}
+
 cloth::Range<const PxVec3> cloth::SwCloth::clampTriangleCount(Range<const PxVec3> range, uint32_t)
 {
 	return range;
@@ -194,6 +403,8 @@ void SwCloth::unlockParticles() const
 
 MappedRange<physx::PxVec4> SwCloth::getCurrentParticles()
 {
+	// the compressed history is relative to the current particles, expand it so that moving them doesn't move it too
+	decompressPrevParticles();
 	return getMappedParticles(&mCurParticles.front());
 }
 
@@ -204,12 +415,19 @@ MappedRange<const physx::PxVec4> SwCloth::getCurrentParticles() const
 
 MappedRange<physx::PxVec4> SwCloth::getPreviousParticles()
 {
+	decompressPrevParticles();
 	return getMappedParticles(&mPrevParticles.front());
 }
 
 MappedRange<const physx::PxVec4> SwCloth::getPreviousParticles() const
 {
-	return getMappedParticles(&mPrevParticles.front());
+	if (!mPrevParticles.empty())
+		return getMappedParticles(&mPrevParticles.front());
+
+	// read only copy, the history stays compressed
+	mDecodedPrevParticles.resizeUninitialized(mCurParticles.size());
+	decodePrevParticles(mDecodedPrevParticles.begin());
+	return getMappedParticles(static_cast<const PxVec4*>(mDecodedPrevParticles.begin()));
 }
 
 GpuParticles SwCloth::getGpuParticles()
@@ -218,18 +436,287 @@ GpuParticles SwCloth::getGpuParticles()
 	return result;
 }
 
+void SwCloth::enableParticleHistoryCompression(bool enable)
+{
+	mCompressPrevParticles = enable;
+	if (enable)
+		compressPrevParticles();
+	else
+		decompressPrevParticles();
+}
+
+bool SwCloth::isParticleHistoryCompressionEnabled() const
+{
+	return mCompressPrevParticles;
+}
+
 void SwCloth::setPhaseConfig(Range<const PhaseConfig> configs)
 {
-	mPhaseConfigs.resize(0);
+	mPhaseConfigs.clear();
+	bool isCompliant = false;
 
 	// transform phase config to use in solver
 	for (; !configs.empty(); configs.popFront())
-		if (configs.front().mStiffness > 0.0f)
+	{
+		if (configs.front().mStiffness > 0.0f || configs.front().mCompliance >= 0.0f)
 			mPhaseConfigs.pushBack(transform(configs.front()));
+		isCompliant |= configs.front().mCompliance >= 0.0f;
+	}
+
+	// lagrange multipliers are only stored if a phase needs them
+	mConstraintMultipliers.resize(0);
+	if (isCompliant)
+		mConstraintMultipliers.resize(mFabric.getNumPaddedRestvalues(), 0.0f);
+
+	wakeUp();
+}
+
+void SwCloth::setConstraintCompliances(Range<const float> compliances)
+{
+	NV_CLOTH_ASSERT(compliances.empty() || compliances.size() == mFabric.getNumRestvalues());
+
+	mConstraintCompliances.clear();
+	if (!compliances.empty())
+	{
+		// dummy constraints added by the fabric for SIMD padding reference particles past the end
+		mConstraintCompliances.reserve(mFabric.getNumPaddedRestvalues());
+		Vector<uint16_t>::Type::ConstIterator iIt = mFabric.mIndices.begin();
+		for (uint32_t i = 0, n = mFabric.getNumPaddedRestvalues(); i < n; ++i, iIt += 2)
+		{
+			if (std::max(iIt[0], iIt[1]) >= mFabric.mNumParticles)
+			{
+				mConstraintCompliances.pushBack(0.0f);
+				continue;
+			}
+			mConstraintCompliances.pushBack(std::max(compliances.front(), 0.0f));
+			compliances.popFront();
+		}
+	}
+
+	wakeUp();
+}
+
+uint32_t SwCloth::getNumConstraintCompliances() const
+{
+	return mConstraintCompliances.empty() ? 0 : mFabric.getNumRestvalues();
+}
+
+void SwCloth::getConstraintMultipliers(Range<float> multipliers) const
+{
+	NV_CLOTH_ASSERT(multipliers.size() == mFabric.getNumRestvalues());
+
+	Vector<uint16_t>::Type::ConstIterator iIt = mFabric.mIndices.begin();
+	for (uint32_t i = 0, n = mFabric.getNumPaddedRestvalues(); i < n && !multipliers.empty(); ++i, iIt += 2)
+	{
+		if (std::max(iIt[0], iIt[1]) >= mFabric.mNumParticles)
+			continue;
+		multipliers.front() = mConstraintMultipliers.empty() ? 0.0f : mConstraintMultipliers[i];
+		multipliers.popFront();
+	}
+}
+
+void SwCloth::setSignedDistanceFields(Range<const SignedDistanceField* const> fields, Range<const PxTransform> poses)
+{
+	NV_CLOTH_ASSERT(fields.size() == poses.size());
+
+#if PX_DEBUG
+	for (const SignedDistanceField* const* it = fields.begin(); it < fields.end(); ++it)
+		NV_CLOTH_ASSERT((*it)->mSamples && (*it)->mCellSize > 0.0f && (*it)->mDimensions[0] > 1 &&
+		                (*it)->mDimensions[1] > 1 && (*it)->mDimensions[2] > 1);
+#endif
+
+	if (fields.size() != mSignedDistanceFields.size())
+	{
+		// no previous poses to interpolate from
+		ContextLockType lock(mFactory);
+		mSignedDistanceFields.assign(fields.begin(), fields.end());
+		mStartSignedDistanceFieldPoses.assign(poses.begin(), poses.end());
+		mTargetSignedDistanceFieldPoses.resize(0);
+	}
+	else
+	{
+		mSignedDistanceFields.assign(fields.begin(), fields.end());
+		mTargetSignedDistanceFieldPoses.assign(poses.begin(), poses.end());
+	}
+
+	wakeUp();
+}
+
+uint32_t SwCloth::getNumSignedDistanceFields() const
+{
+	return uint32_t(mSignedDistanceFields.size());
+}
+
+void SwCloth::setHeightFields(Range<const HeightField* const> heightFields, Range<const PxTransform> poses)
+{
+	NV_CLOTH_ASSERT(heightFields.size() == poses.size());
+
+#if PX_DEBUG
+	for (const HeightField* const* it = heightFields.begin(); it < heightFields.end(); ++it)
+		NV_CLOTH_ASSERT((*it)->mHeights && (*it)->mScale.x > 0.0f && (*it)->mScale.z > 0.0f &&
+		                (*it)->mDimensions[0] > 1 && (*it)->mDimensions[1] > 1);
+#endif
+
+	if (heightFields.size() != mHeightFields.size())
+	{
+		// no previous poses to interpolate from
+		ContextLockType lock(mFactory);
+		mHeightFields.assign(heightFields.begin(), heightFields.end());
+		mStartHeightFieldPoses.assign(poses.begin(), poses.end());
+		mTargetHeightFieldPoses.resize(0);
+	}
+	else
+	{
+		mHeightFields.assign(heightFields.begin(), heightFields.end());
+		mTargetHeightFieldPoses.assign(poses.begin(), poses.end());
+	}
 
 	wakeUp();
 }
 
+uint32_t SwCloth::getNumHeightFields() const
+{
+	return uint32_t(mHeightFields.size());
+}
+
+void SwCloth::setCollisionShapeSet(const CollisionShapeSet* shapeSet, uint32_t sphereMask)
+{
+	NV_CLOTH_ASSERT(!shapeSet || (shapeSet->mNumSpheres <= 32 && shapeSet->mNumCapsules <= 32));
+	NV_CLOTH_ASSERT(!shapeSet || !shapeSet->mNumSpheres || shapeSet->mStartSpheres);
+
+	mCollisionShapeSet = shapeSet;
+	mCollisionShapeSetMask = sphereMask;
+
+	wakeUp();
+}
+
+const CollisionShapeSet* SwCloth::getCollisionShapeSet() const
+{
+	return mCollisionShapeSet;
+}
+
+uint32_t SwCloth::getCollisionShapeSetMask() const
+{
+	return mCollisionShapeSetMask;
+}
+
+void SwCloth::setBoneSpheres(Range<const PxVec4> localSpheres, Range<const uint32_t> boneIndices)
+{
+	NV_CLOTH_ASSERT(localSpheres.size() == boneIndices.size());
+	NV_CLOTH_ASSERT(localSpheres.size() <= 32);
+
+	ContextLockType lock(mFactory);
+	mBoneSpheres.assign(localSpheres.begin(), localSpheres.end());
+	mSphereBoneIndices.assign(boneIndices.begin(), boneIndices.end());
+
+	wakeUp();
+}
+
+uint32_t SwCloth::getNumBoneSpheres() const
+{
+	return uint32_t(mBoneSpheres.size());
+}
+
+void SwCloth::setBoneTransforms(Range<const PxMat44> transforms)
+{
+	if (transforms.size() != mStartBoneTransforms.size())
+	{
+		// no previous transforms to interpolate from
+		ContextLockType lock(mFactory);
+		mStartBoneTransforms.assign(transforms.begin(), transforms.end());
+		mTargetBoneTransforms.resize(0);
+	}
+	else
+	{
+		mTargetBoneTransforms.assign(transforms.begin(), transforms.end());
+	}
+
+	wakeUp();
+}
+
+uint32_t SwCloth::getNumBoneTransforms() const
+{
+	return uint32_t(mStartBoneTransforms.size());
+}
+
+void SwCloth::setParticleCollisionMasks(Range<const uint32_t> masks)
+{
+	NV_CLOTH_ASSERT(masks.empty() || masks.size() == mCurParticles.size());
+
+	ContextLockType lock(mFactory);
+	mParticleCollisionMasks.assign(masks.begin(), masks.end());
+
+	// virtual particles may reference the 3 dummy particles, which don't collide
+	if (!masks.empty())
+		mParticleCollisionMasks.resize(masks.size() + 3, 0);
+
+	wakeUp();
+}
+
+uint32_t SwCloth::getNumParticleCollisionMasks() const
+{
+	return mParticleCollisionMasks.empty() ? 0 : uint32_t(mParticleCollisionMasks.size()) - 3;
+}
+
+void SwCloth::setMotionConstraintIndices(Range<const uint32_t> indices)
+{
+	setIndices(mMotionConstraints, indices);
+}
+
+uint32_t SwCloth::getNumMotionConstraintIndices() const
+{
+	return uint32_t(mMotionConstraints.mIndices.size());
+}
+
+void SwCloth::setSeparationConstraintIndices(Range<const uint32_t> indices)
+{
+	setIndices(mSeparationConstraints, indices);
+}
+
+uint32_t SwCloth::getNumSeparationConstraintIndices() const
+{
+	return uint32_t(mSeparationConstraints.mIndices.size());
+}
+
+void SwCloth::setMotionConstraintBuffer(const ParticleDataBuffer* buffer)
+{
+	NV_CLOTH_ASSERT(!buffer || (buffer->mStart && buffer->mStride >= sizeof(PxVec4)));
+
+	mMotionConstraints.mBuffer = buffer;
+	wakeUp();
+}
+
+const ParticleDataBuffer* SwCloth::getMotionConstraintBuffer() const
+{
+	return mMotionConstraints.mBuffer;
+}
+
+void SwCloth::setSeparationConstraintBuffer(const ParticleDataBuffer* buffer)
+{
+	NV_CLOTH_ASSERT(!buffer || (buffer->mStart && buffer->mStride >= sizeof(PxVec4)));
+
+	mSeparationConstraints.mBuffer = buffer;
+	wakeUp();
+}
+
+const ParticleDataBuffer* SwCloth::getSeparationConstraintBuffer() const
+{
+	return mSeparationConstraints.mBuffer;
+}
+
+void SwCloth::setParticleAccelerationBuffer(const ParticleDataBuffer* buffer)
+{
+	NV_CLOTH_ASSERT(!buffer || (buffer->mStart && buffer->mStride >= sizeof(PxVec4)));
+
+	mParticleAccelerationBuffer = buffer;
+	wakeUp();
+}
+
+const ParticleDataBuffer* SwCloth::getParticleAccelerationBuffer() const
+{
+	return mParticleAccelerationBuffer;
+}
+
 void SwCloth::setSelfCollisionIndices(Range<const uint32_t> indices)
 {
 	ContextLockType lock(mFactory);
@@ -275,7 +762,7 @@ void SwCloth::setVirtualParticles(Range<const uint32_t[4]> indices, Range<const
 	mVirtualParticleIndices.swap(scheduler.mPaddedTriplets);
 
 	// precompute 1/dot(w,w)
-	Vector<PxVec4>::Type().swap(mVirtualParticleWeights); //clear and trim
+	mVirtualParticleWeights.reset(); //clear and trim
 	mVirtualParticleWeights.reserve(weights.size());
 	for (; !weights.empty(); weights.popFront())
 	{
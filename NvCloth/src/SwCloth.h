@@ -33,10 +33,12 @@
 #include "NvCloth/PhaseConfig.h"
 #include "MovingAverage.h"
 #include "IndexPair.h"
+#include "SharedArray.h"
 #include "Vec4T.h"
 #include <foundation/PxVec4.h>
 #include <foundation/PxVec3.h>
 #include <foundation/PxTransform.h>
+#include <foundation/PxMat44.h>
 #include "SwFactory.h"
 #include "SwFabric.h"
 #include "ClothImpl.h"
@@ -49,6 +51,10 @@ namespace cloth
 
 struct SwConstraints
 {
+	SwConstraints() : mBuffer(nullptr)
+	{
+	}
+
 	void pop()
 	{
 		if (!mTarget.empty())
@@ -60,6 +66,38 @@ struct SwConstraints
 
 	Vector<physx::PxVec4>::Type mStart;
 	Vector<physx::PxVec4>::Type mTarget;
+
+	// constrained particles if sparse, capacity padded to a multiple of 4 with a dummy particle
+	Vector<uint32_t>::Type mIndices;
+
+	const ParticleDataBuffer* mBuffer; // owned by the user, replaces mStart and mTarget if set
+};
+
+// sphere/cone acceleration grid of an unchanged set of collision spheres,
+// reused across iterations and frames while the particles stay inside its extent
+struct SwCollisionCache
+{
+	SwCollisionCache() : mSphereMask(0), mValid(false)
+	{
+	}
+
+	// invalidates the grid if the spheres or capsules differ from the cached ones
+	void update(const physx::PxVec4* spheres, uint32_t numSpheres, const IndexPair* capsuleIndices, uint32_t numCapsules,
+	            uint32_t sphereMask);
+
+	Vector<physx::PxVec4>::Type mSpheres;
+	Vector<IndexPair>::Type mCapsuleIndices;
+	uint32_t mSphereMask;
+
+	// right/left mask arrays before merging, see SwCollision::buildAcceleration()
+	uint32_t mSphereGrid[6 * 8];
+	uint32_t mConeGrid[6 * 8];
+	float mGridScale[4];
+	float mGridBias[4];
+
+	float mBounds[6]; // lower[3], upper[3] of the region covered by the grid
+	float mPadding;   // write as simd
+	bool mValid;
 };
 
 struct SwContextLock
@@ -71,6 +109,19 @@ struct SwContextLock
 
 class SwCloth;
 
+// previous particle as 16 bit float offset from the current one, the inverse mass is stored separately
+struct SwCompressedParticle
+{
+	uint16_t mOffset[3];
+};
+
+// single allocation holding the instances and particle arrays of cloths created in bulk,
+// released together with the last of its instances
+struct SwClothBlock
+{
+	int32_t mRefCount;
+};
+
 template<>
 class ClothTraits<SwCloth>
 {
@@ -94,10 +145,19 @@ class SwCloth : public ClothImpl<SwCloth>
 	typedef Vector<IndexPair>::Type& MappedIndexVectorType;
 	typedef Vector<uint32_t>::Type& MappedMaskVectorType;
 
-	SwCloth(SwFactory&, SwFabric&, Range<const physx::PxVec4>);
+	SwCloth(SwFactory&, SwFabric&, Range<const physx::PxVec4>, physx::PxVec4* particleMemory = nullptr);
 	SwCloth(SwFactory&, const SwCloth&);
 	~SwCloth(); // not virtual on purpose
 
+	// particle array capacity including the dummy particles of the SIMD solver
+	static uint32_t getParticleCapacity(uint32_t numParticles);
+
+	// every instance is preceded by a pointer to its SwClothBlock, or null if allocated on its own
+	static const uint32_t sAllocationHeaderSize = 16;
+	static void* operator new(size_t size, const char* fileName, int line, NvClothOverload overload);
+	static void operator delete(void* ptr, const char* fileName, int line, NvClothOverload overload);
+	static void operator delete(void* ptr);
+
   public:
 	virtual Cloth* clone(Factory& factory) const;
 	uint32_t getNumParticles() const;
@@ -110,8 +170,39 @@ class SwCloth : public ClothImpl<SwCloth>
 	MappedRange<physx::PxVec4> getPreviousParticles();
 	MappedRange<const physx::PxVec4> getPreviousParticles() const;
 	GpuParticles getGpuParticles();
+	void enableParticleHistoryCompression(bool enable);
+	bool isParticleHistoryCompressionEnabled() const;
+	uint32_t getStateSize() const;
+	uint32_t saveState(Range<uint8_t> buffer, Range<const uint8_t> reference) const;
+	bool loadState(Range<const uint8_t> buffer, Range<const uint8_t> reference);
 
 	void setPhaseConfig(Range<const PhaseConfig> configs);
+	void setConstraintCompliances(Range<const float> compliances);
+	uint32_t getNumConstraintCompliances() const;
+	void getConstraintMultipliers(Range<float> multipliers) const;
+	void setSignedDistanceFields(Range<const SignedDistanceField* const> fields, Range<const physx::PxTransform> poses);
+	uint32_t getNumSignedDistanceFields() const;
+	void setHeightFields(Range<const HeightField* const> heightFields, Range<const physx::PxTransform> poses);
+	uint32_t getNumHeightFields() const;
+	void setCollisionShapeSet(const CollisionShapeSet* shapeSet, uint32_t sphereMask);
+	const CollisionShapeSet* getCollisionShapeSet() const;
+	uint32_t getCollisionShapeSetMask() const;
+	void setBoneSpheres(Range<const physx::PxVec4> localSpheres, Range<const uint32_t> boneIndices);
+	uint32_t getNumBoneSpheres() const;
+	void setBoneTransforms(Range<const physx::PxMat44> transforms);
+	uint32_t getNumBoneTransforms() const;
+	void setParticleCollisionMasks(Range<const uint32_t> masks);
+	uint32_t getNumParticleCollisionMasks() const;
+	void setMotionConstraintIndices(Range<const uint32_t> indices);
+	uint32_t getNumMotionConstraintIndices() const;
+	void setSeparationConstraintIndices(Range<const uint32_t> indices);
+	uint32_t getNumSeparationConstraintIndices() const;
+	void setMotionConstraintBuffer(const ParticleDataBuffer* buffer);
+	const ParticleDataBuffer* getMotionConstraintBuffer() const;
+	void setSeparationConstraintBuffer(const ParticleDataBuffer* buffer);
+	const ParticleDataBuffer* getSeparationConstraintBuffer() const;
+	void setParticleAccelerationBuffer(const ParticleDataBuffer* buffer);
+	const ParticleDataBuffer* getParticleAccelerationBuffer() const;
 	void setSelfCollisionIndices(Range<const uint32_t> indices);
 	uint32_t getNumVirtualParticles() const;
 	Range<physx::PxVec4> getParticleAccelerations();
@@ -124,8 +215,15 @@ class SwCloth : public ClothImpl<SwCloth>
 
 	void setParticleBounds(const float*);
 
+	// previous particle history compression, see enableParticleHistoryCompression()
+	void allocatePrevParticles(physx::PxVec4* memory = nullptr);
+	void compressPrevParticles();
+	void decompressPrevParticles();
+	void decodePrevParticles(physx::PxVec4*) const;
+
 	Range<physx::PxVec4> push(SwConstraints&);
 	static void clear(SwConstraints&);
+	void setIndices(SwConstraints&, Range<const uint32_t>);
 
 	static Range<const physx::PxVec3> clampTriangleCount(Range<const physx::PxVec3>, uint32_t);
 
@@ -137,9 +235,20 @@ class SwCloth : public ClothImpl<SwCloth>
 
 	// current and previous-iteration particle positions
 	Vector<physx::PxVec4>::Type mCurParticles;
-	Vector<physx::PxVec4>::Type mPrevParticles;
+	Vector<physx::PxVec4>::Type mPrevParticles; // empty while compressed
+	physx::PxVec4* mPrevParticleMemory; // SwClothBlock region of mPrevParticles, or null
+
+	Vector<SwCompressedParticle>::Type mCompressedPrevParticles;
+	Vector<float>::Type mPrevInvMasses; // w of the compressed previous particles
+	bool mCompressPrevParticles;
+	mutable Vector<physx::PxVec4>::Type mDecodedPrevParticles; // returned by getPreviousParticles() const while compressed
+
+	// configuration shared with clones until modified
+	SharedArray<Vector<PhaseConfig>::Type> mPhaseConfigs; // transformed!
 
-	Vector<PhaseConfig>::Type mPhaseConfigs; // transformed!
+	// xpbd constraint data, padded like the fabric restvalues
+	SharedArray<SwFabric::RestvalueContainer> mConstraintCompliances; // uses phase config if empty
+	SwFabric::RestvalueContainer mConstraintMultipliers; // empty if no phase is compliant
 
 	// tether constraints stuff
 	float mTetherConstraintLogStiffness;
@@ -156,6 +265,7 @@ class SwCloth : public ClothImpl<SwCloth>
 
 	// particle acceleration stuff
 	Vector<physx::PxVec4>::Type mParticleAccelerations;
+	const ParticleDataBuffer* mParticleAccelerationBuffer; // owned by the user, replaces the above if set
 
 	// collision stuff
 	Vector<IndexPair>::Type mCapsuleIndices;
@@ -166,22 +276,36 @@ class SwCloth : public ClothImpl<SwCloth>
 	Vector<physx::PxVec4>::Type mTargetCollisionPlanes;
 	Vector<physx::PxVec3>::Type mStartCollisionTriangles;
 	Vector<physx::PxVec3>::Type mTargetCollisionTriangles;
+	Vector<const SignedDistanceField*>::Type mSignedDistanceFields; // owned by the user
+	Vector<physx::PxTransform>::Type mStartSignedDistanceFieldPoses;
+	Vector<physx::PxTransform>::Type mTargetSignedDistanceFieldPoses;
+	Vector<const HeightField*>::Type mHeightFields; // owned by the user
+	Vector<physx::PxTransform>::Type mStartHeightFieldPoses;
+	Vector<physx::PxTransform>::Type mTargetHeightFieldPoses;
+	const CollisionShapeSet* mCollisionShapeSet; // owned by the user, replaces spheres and capsules if set
+	uint32_t mCollisionShapeSetMask;
+	Vector<physx::PxVec4>::Type mBoneSpheres; // replace collision spheres if not empty
+	Vector<uint32_t>::Type mSphereBoneIndices;
+	Vector<physx::PxMat44>::Type mStartBoneTransforms;
+	Vector<physx::PxMat44>::Type mTargetBoneTransforms;
+	SharedArray<Vector<uint32_t>::Type> mParticleCollisionMasks; // padded for dummy particles, empty if all shapes collide
+	SwCollisionCache mCollisionCache;
 	bool mEnableContinuousCollision;
 	float mCollisionMassScale;
 	float mFriction;
 
 	// virtual particles
-	Vector<Vec4us>::Type mVirtualParticleIndices;
-	Vector<physx::PxVec4>::Type mVirtualParticleWeights;
+	SharedArray<Vector<Vec4us>::Type> mVirtualParticleIndices;
+	SharedArray<Vector<physx::PxVec4>::Type> mVirtualParticleWeights;
 	uint32_t mNumVirtualParticles;
 
 	// self collision
 	float mSelfCollisionDistance;
 	float mSelfCollisionLogStiffness;
 
-	Vector<uint32_t>::Type mSelfCollisionIndices;
+	SharedArray<Vector<uint32_t>::Type> mSelfCollisionIndices;
 
-	Vector<physx::PxVec4>::Type mRestPositions;
+	SharedArray<Vector<physx::PxVec4>::Type> mRestPositions;
 
 	// unused for CPU simulation
 	void* mUserData;
@@ -41,6 +41,8 @@ cloth::SwClothData::SwClothData(SwCloth& cloth, const SwFabric& fabric)
 	mNumParticles = uint32_t(cloth.mCurParticles.size());
 	mCurParticles = array(cloth.mCurParticles.front());
 	mPrevParticles = array(cloth.mPrevParticles.front());
+	mCompressedPrevParticles = 0;
+	mPrevInvMasses = 0;
 
 	const float* center = array(cloth.mParticleBoundsCenter);
 	const float* extent = array(cloth.mParticleBoundsHalfExtent);
@@ -62,17 +64,36 @@ cloth::SwClothData::SwClothData(SwCloth& cloth, const SwFabric& fabric)
 	mSets = &fabric.mSets.front();
 	mNumSets = uint32_t(fabric.mSets.size());
 
-	mRestvalues = &fabric.mRestvalues.front();
-	mNumRestvalues = uint32_t(fabric.mRestvalues.size());
+	mRestvalues = fabric.mRestvalues.empty() ? nullptr : &fabric.mRestvalues.front();
+	mNumRestvalues = fabric.getNumPaddedRestvalues();
 	mStiffnessValues = fabric.mStiffnessValues.empty()?nullptr:&fabric.mStiffnessValues.front();
 
+	mQuantizedRestvalues = fabric.mQuantized ? fabric.mQuantizedRestvalues.begin() : nullptr;
+	mQuantizedStiffnessValues = fabric.mQuantizedStiffnessValues.empty() ? nullptr : fabric.mQuantizedStiffnessValues.begin();
+	mQuantizationScales = fabric.mQuantized ? fabric.mQuantizationScales.begin() : nullptr;
+
+	mConstraintCompliances = cloth.mConstraintCompliances.empty() ? nullptr : cloth.mConstraintCompliances.begin();
+	mConstraintMultipliers = cloth.mConstraintMultipliers.empty() ? nullptr : cloth.mConstraintMultipliers.begin();
+
 	mIndices = &fabric.mIndices.front();
 	mNumIndices = uint32_t(fabric.mIndices.size());
 
+	mPackedConstraints = fabric.mPackedConstraints.empty() ? nullptr : fabric.mPackedConstraints.begin();
+	mPackedRecordSize = fabric.mPackedRecordSize;
+
+	mPhaseResiduals = nullptr;
+	if (cloth.isResidualMeasured())
+	{
+		cloth.mPhaseResiduals.resize(mNumPhases, 0.0f);
+		mPhaseResiduals = cloth.mPhaseResiduals.begin();
+	}
+	mResidual = cloth.mResidual;
+
 	float stiffnessExponent = cloth.mStiffnessFrequency * cloth.mPrevIterDt * 0.69314718055994531f; // logf(2.0f);
 
 	mTethers = fabric.mTethers.begin();
-	mNumTethers = uint32_t(fabric.mTethers.size());
+	mQuantizedTethers = fabric.mQuantized ? fabric.mQuantizedTethers.begin() : nullptr;
+	mNumTethers = fabric.getNumTethers();
 	//1-(1 - stiffness)^stiffnessExponent
 	mTetherConstraintStiffness = 1.0f - expf(stiffnessExponent * cloth.mTetherConstraintLogStiffness);
 	mTetherConstraintScale = cloth.mTetherConstraintScale * fabric.mTetherLengthScale;
@@ -87,13 +108,43 @@ cloth::SwClothData::SwClothData(SwCloth& cloth, const SwFabric& fabric)
 	mTargetMotionConstraints =
 	    !cloth.mMotionConstraints.mTarget.empty() ? array(cloth.mMotionConstraints.mTarget.front()) : 0;
 	mMotionConstraintStiffness = 1.0f - expf(stiffnessExponent * cloth.mMotionConstraintLogStiffness);
+	mMotionConstraintIndices = cloth.mMotionConstraints.mIndices.empty() ? 0 : cloth.mMotionConstraints.mIndices.begin();
+	mNumMotionConstraintIndices = uint32_t(cloth.mMotionConstraints.mIndices.size());
+	mMotionConstraintStride = sizeof(PxVec4);
+	mNumMotionConstraints = (uint32_t(cloth.mMotionConstraints.mStart.size()) + 3) & ~3;
+	if (const ParticleDataBuffer* buffer = cloth.mMotionConstraints.mBuffer)
+	{
+		// caller owned, one element per particle or index without padding
+		mStartMotionConstraints = static_cast<const float*>(buffer->mStart);
+		mTargetMotionConstraints = static_cast<const float*>(buffer->mTarget);
+		mMotionConstraintStride = buffer->mStride;
+		mNumMotionConstraints = mMotionConstraintIndices ? mNumMotionConstraintIndices : mNumParticles;
+	}
 
 	mStartSeparationConstraints =
 	    cloth.mSeparationConstraints.mStart.size() ? array(cloth.mSeparationConstraints.mStart.front()) : 0;
 	mTargetSeparationConstraints =
 	    !cloth.mSeparationConstraints.mTarget.empty() ? array(cloth.mSeparationConstraints.mTarget.front()) : 0;
+	mSeparationConstraintIndices =
+	    cloth.mSeparationConstraints.mIndices.empty() ? 0 : cloth.mSeparationConstraints.mIndices.begin();
+	mNumSeparationConstraintIndices = uint32_t(cloth.mSeparationConstraints.mIndices.size());
+	mSeparationConstraintStride = sizeof(PxVec4);
+	mNumSeparationConstraints = (uint32_t(cloth.mSeparationConstraints.mStart.size()) + 3) & ~3;
+	if (const ParticleDataBuffer* buffer = cloth.mSeparationConstraints.mBuffer)
+	{
+		mStartSeparationConstraints = static_cast<const float*>(buffer->mStart);
+		mTargetSeparationConstraints = static_cast<const float*>(buffer->mTarget);
+		mSeparationConstraintStride = buffer->mStride;
+		mNumSeparationConstraints = mSeparationConstraintIndices ? mNumSeparationConstraintIndices : mNumParticles;
+	}
 
 	mParticleAccelerations = cloth.mParticleAccelerations.size() ? array(cloth.mParticleAccelerations.front()) : 0;
+	mParticleAccelerationStride = sizeof(PxVec4);
+	if (const ParticleDataBuffer* buffer = cloth.mParticleAccelerationBuffer)
+	{
+		mParticleAccelerations = static_cast<const float*>(buffer->mStart);
+		mParticleAccelerationStride = buffer->mStride;
+	}
 
 	mStartCollisionSpheres = cloth.mStartCollisionSpheres.empty() ? 0 : array(cloth.mStartCollisionSpheres.front());
 	mTargetCollisionSpheres =
@@ -102,6 +153,41 @@ cloth::SwClothData::SwClothData(SwCloth& cloth, const SwFabric& fabric)
 
 	mCapsuleIndices = cloth.mCapsuleIndices.empty() ? 0 : &cloth.mCapsuleIndices.front();
 	mNumCapsules = uint32_t(cloth.mCapsuleIndices.size());
+	mSphereMask = 0xffffffff;
+
+	mBoneSpheres = 0;
+	mSphereBoneIndices = 0;
+	mStartBoneTransforms = mTargetBoneTransforms = 0;
+	mNumBoneTransforms = 0;
+	if (!cloth.mBoneSpheres.empty() && !cloth.mStartBoneTransforms.empty())
+	{
+		// spheres are generated from the bones in SwCollision
+		mBoneSpheres = array(cloth.mBoneSpheres.front());
+		mSphereBoneIndices = cloth.mSphereBoneIndices.begin();
+		mStartBoneTransforms = array(cloth.mStartBoneTransforms.front())[0];
+		mTargetBoneTransforms = cloth.mTargetBoneTransforms.empty() ? mStartBoneTransforms
+		                                                            : array(cloth.mTargetBoneTransforms.front())[0];
+		mNumBoneTransforms = uint32_t(cloth.mStartBoneTransforms.size());
+		mStartCollisionSpheres = mTargetCollisionSpheres = 0;
+		mNumSpheres = uint32_t(cloth.mBoneSpheres.size());
+	}
+
+	if (const CollisionShapeSet* shapeSet = cloth.mCollisionShapeSet)
+	{
+		mBoneSpheres = 0;
+
+		// shared shapes replace the ones of the cloth
+		mStartCollisionSpheres = shapeSet->mNumSpheres ? array(*shapeSet->mStartSpheres) : 0;
+		mTargetCollisionSpheres = shapeSet->mTargetSpheres ? array(*shapeSet->mTargetSpheres) : mStartCollisionSpheres;
+		mNumSpheres = shapeSet->mNumSpheres;
+		mCapsuleIndices = shapeSet->mNumCapsules ? reinterpret_cast<const IndexPair*>(shapeSet->mCapsuleIndices) : 0;
+		mNumCapsules = shapeSet->mNumCapsules;
+		mSphereMask = cloth.mCollisionShapeSetMask;
+	}
+
+	mCollisionCache = &cloth.mCollisionCache;
+
+	mParticleCollisionMasks = cloth.mParticleCollisionMasks.empty() ? nullptr : cloth.mParticleCollisionMasks.begin();
 
 	mStartCollisionPlanes = cloth.mStartCollisionPlanes.empty() ? 0 : array(cloth.mStartCollisionPlanes.front());
 	mTargetCollisionPlanes =
@@ -116,8 +202,24 @@ cloth::SwClothData::SwClothData(SwCloth& cloth, const SwFabric& fabric)
 	                                                                    : array(cloth.mTargetCollisionTriangles.front());
 	mNumCollisionTriangles = uint32_t(cloth.mStartCollisionTriangles.size()) / 3;
 
+	mSignedDistanceFields = cloth.mSignedDistanceFields.empty() ? nullptr : cloth.mSignedDistanceFields.begin();
+	mStartSignedDistanceFieldPoses =
+	    cloth.mStartSignedDistanceFieldPoses.empty() ? nullptr : cloth.mStartSignedDistanceFieldPoses.begin();
+	mTargetSignedDistanceFieldPoses = cloth.mTargetSignedDistanceFieldPoses.empty()
+	                                      ? mStartSignedDistanceFieldPoses
+	                                      : cloth.mTargetSignedDistanceFieldPoses.begin();
+	mNumSignedDistanceFields = uint32_t(cloth.mSignedDistanceFields.size());
+
+	mHeightFields = cloth.mHeightFields.empty() ? nullptr : cloth.mHeightFields.begin();
+	mStartHeightFieldPoses = cloth.mStartHeightFieldPoses.empty() ? nullptr : cloth.mStartHeightFieldPoses.begin();
+	mTargetHeightFieldPoses =
+	    cloth.mTargetHeightFieldPoses.empty() ? mStartHeightFieldPoses : cloth.mTargetHeightFieldPoses.begin();
+	mNumHeightFields = uint32_t(cloth.mHeightFields.size());
+
 	mVirtualParticlesBegin = cloth.mVirtualParticleIndices.empty() ? 0 : array(cloth.mVirtualParticleIndices.front());
-	mVirtualParticlesEnd = mVirtualParticlesBegin + 4 * cloth.mVirtualParticleIndices.size();
+	mVirtualParticlesEnd = mVirtualParticlesBegin;
+	if (cloth.isLodVirtualParticleCollisionEnabled())
+		mVirtualParticlesEnd += 4 * cloth.mVirtualParticleIndices.size();
 	mVirtualParticleWeights = cloth.mVirtualParticleWeights.empty() ? 0 : array(cloth.mVirtualParticleWeights.front());
 	mNumVirtualParticleWeights = uint32_t(cloth.mVirtualParticleWeights.size());
 
@@ -125,7 +227,7 @@ cloth::SwClothData::SwClothData(SwCloth& cloth, const SwFabric& fabric)
 	mCollisionMassScale = cloth.mCollisionMassScale;
 	mFrictionScale = cloth.mFriction;
 
-	mSelfCollisionDistance = cloth.mSelfCollisionDistance;
+	mSelfCollisionDistance = cloth.isLodSelfCollisionEnabled() ? cloth.mSelfCollisionDistance : 0.0f;
 	mSelfCollisionStiffness = 1.0f - expf(stiffnessExponent * cloth.mSelfCollisionLogStiffness);
 
 	mSelfCollisionIndices = cloth.mSelfCollisionIndices.empty() ? nullptr : cloth.mSelfCollisionIndices.begin();
@@ -142,6 +244,8 @@ void cloth::SwClothData::reconcile(SwCloth& cloth) const
 	cloth.setParticleBounds(mCurBounds);
 	cloth.mSleepTestCounter = mSleepTestCounter;
 	cloth.mSleepPassCounter = mSleepPassCounter;
+	if (mPhaseResiduals)
+		cloth.updateResidual(mResidual);
 }
 
 void cloth::SwClothData::verify() const
@@ -150,6 +254,9 @@ void cloth::SwClothData::verify() const
 	// data isn't immediately available on SPU at that stage
 	// perhaps a good reason to construct SwClothData on PPU instead
 
+	NV_CLOTH_ASSERT(!mBoneSpheres ||
+	          mNumBoneTransforms > *ps::maxElement(mSphereBoneIndices, mSphereBoneIndices + mNumSpheres));
+
 	NV_CLOTH_ASSERT(!mNumCapsules ||
 	          mNumSpheres > *ps::maxElement(&mCapsuleIndices->first, &(mCapsuleIndices + mNumCapsules)->first));
 
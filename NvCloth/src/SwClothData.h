@@ -48,6 +48,11 @@ class SwFabric;
 struct PhaseConfig;
 struct IndexPair;
 struct SwTether;
+struct SwQuantizedTether;
+struct SwCompressedParticle;
+struct SignedDistanceField;
+struct HeightField;
+struct SwCollisionCache;
 
 // reference to cloth instance bulk data (POD)
 struct SwClothData
@@ -60,6 +65,8 @@ struct SwClothData
 	uint32_t mNumParticles;
 	float* mCurParticles;
 	float* mPrevParticles;
+	const SwCompressedParticle* mCompressedPrevParticles; // decoded by the first integration if not null
+	const float* mPrevInvMasses; // w of mCompressedPrevParticles
 
 	float mCurBounds[6]; // lower[3], upper[3]
 	float mPrevBounds[6];
@@ -79,10 +86,28 @@ struct SwClothData
 	uint32_t mNumRestvalues;
 	const float* mStiffnessValues;
 
+	// 16 bit rest values and stiffness with a (rest value, stiffness) scale per set, null unless the fabric is quantized
+	const uint16_t* mQuantizedRestvalues;
+	const int16_t* mQuantizedStiffnessValues;
+	const float* mQuantizationScales;
+
+	// xpbd compliance per constraint (null uses phase config) and lagrange multipliers
+	const float* mConstraintCompliances;
+	float* mConstraintMultipliers;
+
 	const uint16_t* mIndices;
 	uint32_t mNumIndices;
 
+	// interleaved restvalue/index/stiffness records, null if the fabric has none
+	const float* mPackedConstraints;
+	uint32_t mPackedRecordSize;
+
+	// residual per phase, null if not measured
+	float* mPhaseResiduals;
+	float mResidual;
+
 	const SwTether* mTethers;
+	const SwQuantizedTether* mQuantizedTethers; // null unless the fabric is quantized
 	uint32_t mNumTethers;
 	float mTetherConstraintStiffness;
 	float mTetherConstraintScale;
@@ -97,14 +122,23 @@ struct SwClothData
 	// motion constraint data
 	const float* mStartMotionConstraints;
 	const float* mTargetMotionConstraints;
+	uint32_t mMotionConstraintStride; // in bytes
+	uint32_t mNumMotionConstraints;   // readable elements, including padding
 	float mMotionConstraintStiffness;
+	const uint32_t* mMotionConstraintIndices; // sparse constraints if not null
+	uint32_t mNumMotionConstraintIndices;
 
 	// separation constraint data
 	const float* mStartSeparationConstraints;
 	const float* mTargetSeparationConstraints;
+	uint32_t mSeparationConstraintStride;
+	uint32_t mNumSeparationConstraints;
+	const uint32_t* mSeparationConstraintIndices;
+	uint32_t mNumSeparationConstraintIndices;
 
 	// particle acceleration data
 	const float* mParticleAccelerations;
+	uint32_t mParticleAccelerationStride;
 
 	// collision stuff
 	const float* mStartCollisionSpheres;
@@ -113,6 +147,20 @@ struct SwClothData
 
 	const IndexPair* mCapsuleIndices;
 	uint32_t mNumCapsules;
+	uint32_t mSphereMask; // spheres selected from a collision shape set
+
+	// spheres in bone space replace the collision spheres if not null
+	const float* mBoneSpheres;
+	const uint32_t* mSphereBoneIndices;
+	const float* mStartBoneTransforms;
+	const float* mTargetBoneTransforms;
+	uint32_t mNumBoneTransforms;
+
+	// sphere mask per particle, null if all particles collide with all shapes
+	const uint32_t* mParticleCollisionMasks;
+
+	// sphere acceleration cache, used if the spheres don't move during the frame
+	SwCollisionCache* mCollisionCache;
 
 	const float* mStartCollisionPlanes;
 	const float* mTargetCollisionPlanes;
@@ -125,6 +173,16 @@ struct SwClothData
 	const float* mTargetCollisionTriangles;
 	uint32_t mNumCollisionTriangles;
 
+	const SignedDistanceField* const* mSignedDistanceFields;
+	const physx::PxTransform* mStartSignedDistanceFieldPoses;
+	const physx::PxTransform* mTargetSignedDistanceFieldPoses;
+	uint32_t mNumSignedDistanceFields;
+
+	const HeightField* const* mHeightFields;
+	const physx::PxTransform* mStartHeightFieldPoses;
+	const physx::PxTransform* mTargetHeightFieldPoses;
+	uint32_t mNumHeightFields;
+
 	const uint16_t* mVirtualParticlesBegin;
 	const uint16_t* mVirtualParticlesEnd;
 
@@ -141,7 +199,7 @@ struct SwClothData
 	uint32_t mNumSelfCollisionIndices;
 	const uint32_t* mSelfCollisionIndices;
 
-	float* mRestPositions;
+	const float* mRestPositions;
 
 	// sleep data
 	uint32_t mSleepPassCounter;
@@ -0,0 +1,744 @@
+// This code contains NVIDIA Confidential Information and is disclosed to you
+// under a form of NVIDIA software license agreement provided separately to you.
+//
+// Notice
+// NVIDIA Corporation and its licensors retain all intellectual property and
+// proprietary rights in and to this software and related documentation and
+// any modifications thereto. Any use, reproduction, disclosure, or
+// distribution of this software and related documentation without an express
+// license agreement from NVIDIA Corporation is strictly prohibited.
+//
+// ALL NVIDIA DESIGN SPECIFICATIONS, CODE ARE PROVIDED "AS IS.". NVIDIA MAKES
+// NO WARRANTIES, EXPRESSED, IMPLIED, STATUTORY, OR OTHERWISE WITH RESPECT TO
+// THE MATERIALS, AND EXPRESSLY DISCLAIMS ALL IMPLIED WARRANTIES OF NONINFRINGEMENT,
+// MERCHANTABILITY, AND FITNESS FOR A PARTICULAR PURPOSE.
+//
+// Information and code furnished is believed to be accurate and reliable.
+// However, NVIDIA Corporation assumes no responsibility for the consequences of use of such
+// information or for any infringement of patents or other rights of third parties that may
+// result from its use. No license is granted by implication or otherwise under any patent
+// or patent rights of NVIDIA Corporation. Details are subject to change without notice.
+// This code supersedes and replaces all information previously supplied.
+// NVIDIA Corporation products are not authorized for use as critical
+// components in life support devices or systems without express written approval of
+// NVIDIA Corporation.
+//
+// Copyright (c) 2008-2020 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.
+
+#include "SwCloth.h"
+#include "HalfFloat.h"
+#include "ps/PsUtilities.h"
+#include <string.h> // for memcpy
+
+using namespace physx;
+using namespace nv;
+using namespace cloth;
+
+/*
+   Cloth snapshots are a header followed by a payload of 32 bit words.
+
+   A full snapshot stores the payload as is. A delta snapshot xors every word with the word at the same
+   position in the payload of a full reference snapshot, and stores the result as runs of
+   [number of zero words][number of non-zero words][non-zero words...].
+
+   The payload starts with the element counts of all arrays and the scalar state, so that loadState()
+   can reject a snapshot before changing anything, followed by the array elements.
+ */
+
+namespace
+{
+const uint32_t sStateMagic = 0x53434e56; // "NVCS"
+const uint32_t sStateVersion = 2;
+const uint32_t sStateDelta = 1;
+
+// magic, version, flags, decoded payload words, stored payload words
+const uint32_t sStateHeaderWords = 5;
+
+class StateWriter
+{
+  public:
+	// counts the words without writing anything if capacity is 0
+	StateWriter(uint32_t* begin, uint32_t capacity, const uint32_t* reference, uint32_t referenceSize)
+	: mBegin(begin), mCapacity(capacity), mPos(0), mReference(reference), mReferenceSize(referenceSize), mSize(0), mRun(nullptr)
+	{
+	}
+
+	void write(uint32_t word)
+	{
+		if (mReference)
+		{
+			word ^= mSize < mReferenceSize ? mReference[mSize] : 0;
+			if (!mRun || (!word && mRun[1]))
+				beginRun();
+			++mRun[word ? 1 : 0];
+			if (word)
+				put(word);
+		}
+		else
+		{
+			put(word);
+		}
+		++mSize;
+	}
+
+	void write(float value)
+	{
+		uint32_t word;
+		memcpy(&word, &value, sizeof(word));
+		write(word);
+	}
+
+	void write(bool value)
+	{
+		write(uint32_t(value));
+	}
+
+	template <typename T>
+	void write(const T* data, uint32_t count)
+	{
+		PX_COMPILE_TIME_ASSERT(sizeof(T) % sizeof(uint32_t) == 0);
+		uint32_t numWords = count * uint32_t(sizeof(T) / sizeof(uint32_t));
+		if (!mReference)
+		{
+			if (mPos + numWords <= mCapacity && numWords)
+				memcpy(mBegin + mPos, data, numWords * sizeof(uint32_t));
+			mPos += numWords;
+			mSize += numWords;
+			return;
+		}
+
+		const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+		for (uint32_t i = 0; i < numWords; ++i, bytes += sizeof(uint32_t))
+		{
+			uint32_t word;
+			memcpy(&word, bytes, sizeof(word));
+			write(word);
+		}
+	}
+
+	template <typename T, typename Alloc>
+	void write(const ps::Array<T, Alloc>& array)
+	{
+		write(array.begin(), array.size());
+	}
+
+	void write(const PxVec3& v)
+	{
+		write(&v, 1);
+	}
+
+	void write(const PxTransform& t)
+	{
+		write(&t, 1);
+	}
+
+	// decoded payload size
+	uint32_t getSize() const
+	{
+		return mSize;
+	}
+
+	// stored payload size, larger than the capacity if the buffer was too small
+	uint32_t getNumWords() const
+	{
+		return mPos;
+	}
+
+  private:
+	void put(uint32_t word)
+	{
+		if (mPos < mCapacity)
+			mBegin[mPos] = word;
+		++mPos;
+	}
+
+	void beginRun()
+	{
+		mRun = mPos + 2 <= mCapacity ? mBegin + mPos : mOverflowRun;
+		mRun[0] = mRun[1] = 0;
+		mPos += 2;
+	}
+
+	uint32_t* mBegin;
+	uint32_t mCapacity;
+	uint32_t mPos;
+
+	const uint32_t* mReference;
+	uint32_t mReferenceSize;
+	uint32_t mSize;
+
+	uint32_t* mRun;
+	uint32_t mOverflowRun[2];
+};
+
+class StateReader
+{
+  public:
+	StateReader(const uint32_t* begin, uint32_t numWords, uint32_t size, const uint32_t* reference, uint32_t referenceSize)
+	: mBegin(begin), mNumWords(numWords), mPos(0), mReference(reference), mReferenceSize(referenceSize), mSize(size), mOutPos(0)
+	, mZeros(0), mLiterals(0), mError(false)
+	{
+	}
+
+	uint32_t read()
+	{
+		if (mOutPos >= mSize)
+		{
+			mError = true;
+			return 0;
+		}
+
+		if (!mReference)
+		{
+			++mOutPos;
+			return next();
+		}
+
+		uint32_t word = mOutPos < mReferenceSize ? mReference[mOutPos] : 0;
+		++mOutPos;
+
+		while (!mZeros && !mLiterals)
+		{
+			if (mPos + 2 > mNumWords)
+			{
+				mError = true;
+				return 0;
+			}
+			mZeros = next();
+			mLiterals = next();
+		}
+
+		if (mZeros)
+		{
+			--mZeros;
+			return word;
+		}
+
+		--mLiterals;
+		return word ^ next();
+	}
+
+	float readFloat()
+	{
+		uint32_t word = read();
+		float value;
+		memcpy(&value, &word, sizeof(value));
+		return value;
+	}
+
+	template <typename T>
+	void read(T* data, uint32_t count)
+	{
+		PX_COMPILE_TIME_ASSERT(sizeof(T) % sizeof(uint32_t) == 0);
+		uint32_t numWords = count * uint32_t(sizeof(T) / sizeof(uint32_t));
+		if (!mReference && mPos + numWords <= mNumWords && mOutPos + numWords <= mSize)
+		{
+			if (numWords)
+				memcpy(static_cast<void*>(data), mBegin + mPos, numWords * sizeof(uint32_t));
+			mPos += numWords;
+			mOutPos += numWords;
+			return;
+		}
+
+		uint8_t* bytes = reinterpret_cast<uint8_t*>(data);
+		for (uint32_t i = 0; i < numWords; ++i, bytes += sizeof(uint32_t))
+		{
+			uint32_t word = read();
+			memcpy(bytes, &word, sizeof(word));
+		}
+	}
+
+	// advances by numWords payload words without decoding them
+	void skip(uint64_t numWords)
+	{
+		if (numWords > mSize - mOutPos)
+		{
+			mError = true;
+			return;
+		}
+
+		while (numWords && !mError)
+		{
+			if (!mReference)
+			{
+				mError = numWords > mNumWords - mPos;
+				mPos += uint32_t(numWords);
+				mOutPos += uint32_t(numWords);
+				return;
+			}
+
+			while (!mZeros && !mLiterals)
+			{
+				if (mPos + 2 > mNumWords)
+				{
+					mError = true;
+					return;
+				}
+				mZeros = next();
+				mLiterals = next();
+			}
+
+			uint32_t count;
+			if (mZeros)
+			{
+				count = uint32_t(PxMin<uint64_t>(numWords, mZeros));
+				mZeros -= count;
+			}
+			else
+			{
+				count = uint32_t(PxMin<uint64_t>(numWords, mLiterals));
+				if (count > mNumWords - mPos)
+				{
+					mError = true;
+					return;
+				}
+				mLiterals -= count;
+				mPos += count;
+			}
+			mOutPos += count;
+			numWords -= count;
+		}
+	}
+
+	template <typename T, typename Alloc>
+	void read(ps::Array<T, Alloc>& array, uint32_t count)
+	{
+		array.resizeUninitialized(count);
+		read(array.begin(), count);
+	}
+
+	void read(PxVec3& v)
+	{
+		read(&v, 1);
+	}
+
+	void read(PxTransform& t)
+	{
+		read(&t, 1);
+	}
+
+	// number of decoded payload words not read yet
+	uint32_t getNumWordsLeft() const
+	{
+		return mSize - mOutPos;
+	}
+
+	// true if all stored words and runs have been consumed
+	bool isComplete() const
+	{
+		return mOutPos == mSize && mPos == mNumWords && !mZeros && !mLiterals;
+	}
+
+	bool hasError() const
+	{
+		return mError;
+	}
+
+  private:
+	uint32_t next()
+	{
+		if (mPos < mNumWords)
+			return mBegin[mPos++];
+		mError = true;
+		return 0;
+	}
+
+	const uint32_t* mBegin;
+	uint32_t mNumWords;
+	uint32_t mPos;
+
+	const uint32_t* mReference;
+	uint32_t mReferenceSize;
+	uint32_t mSize;
+	uint32_t mOutPos;
+
+	uint32_t mZeros;
+	uint32_t mLiterals;
+	bool mError;
+};
+
+// returns the payload of a full snapshot, or null
+const uint32_t* getReferencePayload(Range<const uint8_t> reference, uint32_t& size)
+{
+	const uint32_t* header = reinterpret_cast<const uint32_t*>(reference.begin());
+	if (reference.size() < sStateHeaderWords * sizeof(uint32_t) || header[0] != sStateMagic ||
+	    header[1] != sStateVersion || (header[2] & sStateDelta) || header[3] != header[4] ||
+	    reference.size() < (sStateHeaderWords + header[4]) * sizeof(uint32_t))
+		return nullptr;
+
+	NV_CLOTH_ASSERT((size_t(reference.begin()) & 3) == 0);
+	size = header[3];
+	return header + sStateHeaderWords;
+}
+
+// arrays in the order they are stored
+struct StateArrays
+{
+	StateArrays(const cloth::SwCloth& cloth)
+	{
+		mCounts[0] = cloth.mMotionConstraints.mStart.size();
+		mCounts[1] = cloth.mMotionConstraints.mTarget.size();
+		mCounts[2] = cloth.mSeparationConstraints.mStart.size();
+		mCounts[3] = cloth.mSeparationConstraints.mTarget.size();
+		mCounts[4] = cloth.mConstraintMultipliers.size();
+		mCounts[5] = cloth.mCapsuleIndices.size();
+		mCounts[6] = cloth.mStartCollisionSpheres.size();
+		mCounts[7] = cloth.mTargetCollisionSpheres.size();
+		mCounts[8] = cloth.mConvexMasks.size();
+		mCounts[9] = cloth.mStartCollisionPlanes.size();
+		mCounts[10] = cloth.mTargetCollisionPlanes.size();
+		mCounts[11] = cloth.mStartCollisionTriangles.size();
+		mCounts[12] = cloth.mTargetCollisionTriangles.size();
+		mCounts[13] = cloth.mStartBoneTransforms.size();
+		mCounts[14] = cloth.mTargetBoneTransforms.size();
+		mCounts[15] = cloth.mPhaseResiduals.size();
+		mCounts[16] = cloth.mStartSignedDistanceFieldPoses.size();
+		mCounts[17] = cloth.mTargetSignedDistanceFieldPoses.size();
+		mCounts[18] = cloth.mStartHeightFieldPoses.size();
+		mCounts[19] = cloth.mTargetHeightFieldPoses.size();
+		mCounts[20] = cloth.mParticleAccelerations.size();
+	}
+
+	// number of payload words used by the elements of arrays [first, last)
+	uint64_t getNumWords(uint32_t first = 0, uint32_t last = sNumArrays) const
+	{
+		static const uint32_t sWordsPerElement[sNumArrays] = { 4, 4, 4, 4, 1, 2, 4, 4, 1, 4, 4, 3, 3, 16, 16, 1, 7, 7, 7, 7, 4 };
+
+		uint64_t numWords = 0;
+		for (uint32_t i = first; i < last; ++i)
+			numWords += uint64_t(mCounts[i]) * sWordsPerElement[i];
+		return numWords;
+	}
+
+	static const uint32_t sNumArrays = 21;
+	uint32_t mCounts[sNumArrays];
+};
+
+// scalar state, read completely before the cloth is modified
+struct StateScalars
+{
+	StateScalars(const cloth::SwCloth& cloth)
+	: mParticleBoundsCenter(cloth.mParticleBoundsCenter)
+	, mParticleBoundsHalfExtent(cloth.mParticleBoundsHalfExtent)
+	, mTargetMotion(cloth.mTargetMotion)
+	, mCurrentMotion(cloth.mCurrentMotion)
+	, mLinearVelocity(cloth.mLinearVelocity)
+	, mAngularVelocity(cloth.mAngularVelocity)
+	, mIgnoreVelocityDiscontinuityNextFrame(cloth.mIgnoreVelocityDiscontinuityNextFrame)
+	, mPrevIterDt(cloth.mPrevIterDt)
+	, mIterDtAvg(cloth.mIterDtAvg.getState())
+	, mSleepPassCounter(cloth.mSleepPassCounter)
+	, mSleepTestCounter(cloth.mSleepTestCounter)
+	, mResidual(cloth.mResidual)
+	, mResidualFrequencyScale(cloth.mResidualFrequencyScale)
+	, mLodSkippedFrames(cloth.mLodSkippedFrames)
+	, mLodSkippedDt(cloth.mLodSkippedDt)
+	{
+	}
+
+	void write(StateWriter& writer) const
+	{
+		writer.write(mParticleBoundsCenter);
+		writer.write(mParticleBoundsHalfExtent);
+		writer.write(mTargetMotion);
+		writer.write(mCurrentMotion);
+		writer.write(mLinearVelocity);
+		writer.write(mAngularVelocity);
+		writer.write(mIgnoreVelocityDiscontinuityNextFrame);
+		writer.write(mPrevIterDt);
+		writer.write(mIterDtAvg.mSize);
+		writer.write(uint32_t(mIterDtAvg.mBegin));
+		writer.write(uint32_t(mIterDtAvg.mCount));
+		writer.write(mSleepPassCounter);
+		writer.write(mSleepTestCounter);
+		writer.write(mResidual);
+		writer.write(mResidualFrequencyScale);
+		writer.write(mLodSkippedFrames);
+		writer.write(mLodSkippedDt);
+	}
+
+	void read(StateReader& reader)
+	{
+		reader.read(mParticleBoundsCenter);
+		reader.read(mParticleBoundsHalfExtent);
+		reader.read(mTargetMotion);
+		reader.read(mCurrentMotion);
+		reader.read(mLinearVelocity);
+		reader.read(mAngularVelocity);
+		mIgnoreVelocityDiscontinuityNextFrame = reader.read() != 0;
+		mPrevIterDt = reader.readFloat();
+		mIterDtAvg.mSize = reader.read();
+		mIterDtAvg.mBegin = int32_t(reader.read());
+		mIterDtAvg.mCount = int32_t(reader.read());
+		mSleepPassCounter = reader.read();
+		mSleepTestCounter = reader.read();
+		mResidual = reader.readFloat();
+		mResidualFrequencyScale = reader.readFloat();
+		mLodSkippedFrames = reader.read();
+		mLodSkippedDt = reader.readFloat();
+	}
+
+	// the moving average data is read separately from the end of the payload
+	void apply(cloth::SwCloth& cloth) const
+	{
+		cloth.mParticleBoundsCenter = mParticleBoundsCenter;
+		cloth.mParticleBoundsHalfExtent = mParticleBoundsHalfExtent;
+		cloth.mTargetMotion = mTargetMotion;
+		cloth.mCurrentMotion = mCurrentMotion;
+		cloth.mLinearVelocity = mLinearVelocity;
+		cloth.mAngularVelocity = mAngularVelocity;
+		cloth.mIgnoreVelocityDiscontinuityNextFrame = mIgnoreVelocityDiscontinuityNextFrame;
+		cloth.mPrevIterDt = mPrevIterDt;
+		cloth.mSleepPassCounter = mSleepPassCounter;
+		cloth.mSleepTestCounter = mSleepTestCounter;
+		cloth.mResidual = mResidual;
+		cloth.mResidualFrequencyScale = mResidualFrequencyScale;
+		cloth.mLodSkippedFrames = mLodSkippedFrames;
+		cloth.mLodSkippedDt = mLodSkippedDt;
+	}
+
+	PxVec3 mParticleBoundsCenter;
+	PxVec3 mParticleBoundsHalfExtent;
+	PxTransform mTargetMotion;
+	PxTransform mCurrentMotion;
+	PxVec3 mLinearVelocity;
+	PxVec3 mAngularVelocity;
+	bool mIgnoreVelocityDiscontinuityNextFrame;
+	float mPrevIterDt;
+	MovingAverage::State mIterDtAvg;
+	uint32_t mSleepPassCounter;
+	uint32_t mSleepTestCounter;
+	float mResidual;
+	float mResidualFrequencyScale;
+	uint32_t mLodSkippedFrames;
+	float mLodSkippedDt;
+};
+
+void writeState(const cloth::SwCloth& cloth, StateWriter& writer)
+{
+	StateArrays arrays(cloth);
+	uint32_t numParticles = uint32_t(cloth.mCurParticles.size());
+
+	writer.write(numParticles);
+	for (uint32_t i = 0; i < StateArrays::sNumArrays; ++i)
+		writer.write(arrays.mCounts[i]);
+	StateScalars(cloth).write(writer);
+
+	writer.write(cloth.mCurParticles);
+	if (!cloth.mPrevParticles.empty())
+	{
+		writer.write(cloth.mPrevParticles);
+	}
+	else
+	{
+		// expand compressed history on the fly, the cloth stays compressed
+		const PxVec4* curIt = cloth.mCurParticles.begin();
+		const cloth::SwCompressedParticle* cIt = cloth.mCompressedPrevParticles.begin();
+		const float* wIt = cloth.mPrevInvMasses.begin();
+		for (const PxVec4* curEnd = cloth.mCurParticles.end(); curIt != curEnd; ++curIt, ++cIt, ++wIt)
+		{
+			writer.write(curIt->x + cloth::halfToFloat(cIt->mOffset[0]));
+			writer.write(curIt->y + cloth::halfToFloat(cIt->mOffset[1]));
+			writer.write(curIt->z + cloth::halfToFloat(cIt->mOffset[2]));
+			writer.write(*wIt);
+		}
+	}
+
+	writer.write(cloth.mMotionConstraints.mStart);
+	writer.write(cloth.mMotionConstraints.mTarget);
+	writer.write(cloth.mSeparationConstraints.mStart);
+	writer.write(cloth.mSeparationConstraints.mTarget);
+	writer.write(cloth.mConstraintMultipliers);
+	writer.write(cloth.mCapsuleIndices);
+	writer.write(cloth.mStartCollisionSpheres);
+	writer.write(cloth.mTargetCollisionSpheres);
+	writer.write(cloth.mConvexMasks);
+	writer.write(cloth.mStartCollisionPlanes);
+	writer.write(cloth.mTargetCollisionPlanes);
+	writer.write(cloth.mStartCollisionTriangles);
+	writer.write(cloth.mTargetCollisionTriangles);
+	writer.write(cloth.mStartBoneTransforms);
+	writer.write(cloth.mTargetBoneTransforms);
+	writer.write(cloth.mPhaseResiduals);
+	writer.write(cloth.mStartSignedDistanceFieldPoses);
+	writer.write(cloth.mTargetSignedDistanceFieldPoses);
+	writer.write(cloth.mStartHeightFieldPoses);
+	writer.write(cloth.mTargetHeightFieldPoses);
+	writer.write(cloth.mParticleAccelerations);
+
+	cloth.mIterDtAvg.writeData(writer);
+}
+
+// constraints keep their SIMD padding, see SwCloth::push()
+void readConstraints(Vector<PxVec4>::Type& constraints, uint32_t count, StateReader& reader)
+{
+	if (constraints.capacity() < ((count + 3) & ~3))
+	{
+		Vector<PxVec4>::Type().swap(constraints);
+		constraints.resize((count + 3) & ~3, PxVec4(0.0f));
+	}
+
+	reader.read(constraints, count);
+}
+}
+
+uint32_t cloth::SwCloth::getStateSize() const
+{
+	StateWriter counter(nullptr, 0, nullptr, 0);
+	writeState(*this, counter);
+	return (sStateHeaderWords + counter.getNumWords()) * sizeof(uint32_t);
+}
+
+uint32_t cloth::SwCloth::saveState(Range<uint8_t> buffer, Range<const uint8_t> reference) const
+{
+	NV_CLOTH_ASSERT((size_t(buffer.begin()) & 3) == 0);
+
+	uint32_t capacity = buffer.size() / sizeof(uint32_t);
+	if (capacity < sStateHeaderWords)
+		return 0;
+
+	uint32_t* header = reinterpret_cast<uint32_t*>(buffer.begin());
+	uint32_t* payload = header + sStateHeaderWords;
+	capacity -= sStateHeaderWords;
+
+	header[0] = sStateMagic;
+	header[1] = sStateVersion;
+
+	uint32_t referenceSize = 0;
+	if (const uint32_t* referencePayload = getReferencePayload(reference, referenceSize))
+	{
+		StateWriter writer(payload, capacity, referencePayload, referenceSize);
+		writeState(*this, writer);
+
+		// use the delta if it fits and is smaller than the full snapshot
+		if (writer.getNumWords() <= capacity && writer.getNumWords() < writer.getSize())
+		{
+			header[2] = sStateDelta;
+			header[3] = writer.getSize();
+			header[4] = writer.getNumWords();
+			return (sStateHeaderWords + writer.getNumWords()) * sizeof(uint32_t);
+		}
+	}
+
+	StateWriter writer(payload, capacity, nullptr, 0);
+	writeState(*this, writer);
+	if (writer.getNumWords() > capacity)
+		return 0;
+
+	header[2] = 0;
+	header[3] = header[4] = writer.getNumWords();
+	return (sStateHeaderWords + writer.getNumWords()) * sizeof(uint32_t);
+}
+
+bool cloth::SwCloth::loadState(Range<const uint8_t> buffer, Range<const uint8_t> reference)
+{
+	NV_CLOTH_ASSERT((size_t(buffer.begin()) & 3) == 0);
+
+	const uint32_t* header = reinterpret_cast<const uint32_t*>(buffer.begin());
+	if (buffer.size() < sStateHeaderWords * sizeof(uint32_t) || header[0] != sStateMagic || header[1] != sStateVersion ||
+	    buffer.size() < (sStateHeaderWords + header[4]) * sizeof(uint32_t))
+		return false;
+
+	uint32_t referenceSize = 0;
+	const uint32_t* referencePayload = nullptr;
+	if (header[2] & sStateDelta)
+	{
+		referencePayload = getReferencePayload(reference, referenceSize);
+		if (!referencePayload)
+			return false;
+	}
+
+	StateReader reader(header + sStateHeaderWords, header[4], header[3], referencePayload, referenceSize);
+
+	// validate the array sizes before changing anything
+	uint32_t numParticles = reader.read();
+	StateArrays arrays(*this);
+	for (uint32_t i = 0; i < StateArrays::sNumArrays; ++i)
+		arrays.mCounts[i] = reader.read();
+
+	uint32_t numMotionConstraints = mMotionConstraints.mIndices.empty() ? numParticles : mMotionConstraints.mIndices.size();
+	uint32_t numSeparationConstraints = mSeparationConstraints.mIndices.empty() ? numParticles : mSeparationConstraints.mIndices.size();
+	const uint32_t* counts = arrays.mCounts;
+	if (reader.hasError() || numParticles != mCurParticles.size() ||
+	    (counts[0] && counts[0] != numMotionConstraints) || (counts[1] && counts[1] != numMotionConstraints) ||
+	    (counts[2] && counts[2] != numSeparationConstraints) || (counts[3] && counts[3] != numSeparationConstraints) ||
+	    counts[4] != mConstraintMultipliers.size() || counts[16] != mSignedDistanceFields.size() ||
+	    (counts[17] && counts[17] != counts[16]) || counts[18] != mHeightFields.size() ||
+	    (counts[19] && counts[19] != counts[18]) || (counts[20] && counts[20] != numParticles) ||
+	    counts[6] > 32 || (counts[7] && counts[7] != counts[6]) || counts[9] > 32 ||
+	    (counts[10] && counts[10] != counts[9]) || (counts[12] && counts[12] != counts[11]) ||
+	    (counts[14] && counts[14] != counts[13]))
+		return false;
+
+	// bone spheres index into the bone transforms and replace the collision spheres
+	uint32_t numSpheres = counts[6];
+	if (!mBoneSpheres.empty() && counts[13])
+	{
+		if (counts[13] <= *ps::maxElement(mSphereBoneIndices.begin(), mSphereBoneIndices.end()))
+			return false;
+		numSpheres = mBoneSpheres.size();
+	}
+
+	StateScalars scalars(*this);
+	scalars.read(reader);
+	if (reader.hasError() || !scalars.mIterDtAvg.isValid())
+		return false;
+
+	uint64_t numWords = 8ull * numParticles + arrays.getNumWords() + scalars.mIterDtAvg.mSize;
+	if (numWords != reader.getNumWordsLeft())
+		return false;
+
+	// walk the payload once with a copy of the reader, so that malformed delta runs or
+	// out of range capsule indices and convex masks are rejected before anything is modified
+	StateReader validator = reader;
+	validator.skip(8ull * numParticles + arrays.getNumWords(0, 5));
+	for (uint32_t i = 0; i < 2 * counts[5]; ++i)
+		if (validator.read() >= numSpheres)
+			return false;
+	validator.skip(arrays.getNumWords(6, 8));
+	uint32_t planeMask = counts[9] < 32 ? (1u << counts[9]) - 1 : ~0u;
+	for (uint32_t i = 0; i < counts[8]; ++i)
+		if (validator.read() & ~planeMask)
+			return false;
+	validator.skip(arrays.getNumWords(9, StateArrays::sNumArrays) + scalars.mIterDtAvg.mSize);
+	if (validator.hasError() || !validator.isComplete())
+		return false;
+
+	ContextLockType lock(mFactory);
+
+	reader.read(mCurParticles, numParticles);
+	if (mPrevParticles.empty())
+		allocatePrevParticles();
+	reader.read(mPrevParticles, numParticles);
+	compressPrevParticles();
+
+	readConstraints(mMotionConstraints.mStart, counts[0], reader);
+	readConstraints(mMotionConstraints.mTarget, counts[1], reader);
+	readConstraints(mSeparationConstraints.mStart, counts[2], reader);
+	readConstraints(mSeparationConstraints.mTarget, counts[3], reader);
+	reader.read(mConstraintMultipliers, counts[4]);
+	reader.read(mCapsuleIndices, counts[5]);
+	reader.read(mStartCollisionSpheres, counts[6]);
+	reader.read(mTargetCollisionSpheres, counts[7]);
+	reader.read(mConvexMasks, counts[8]);
+	reader.read(mStartCollisionPlanes, counts[9]);
+	reader.read(mTargetCollisionPlanes, counts[10]);
+	reader.read(mStartCollisionTriangles, counts[11]);
+	reader.read(mTargetCollisionTriangles, counts[12]);
+	reader.read(mStartBoneTransforms, counts[13]);
+	reader.read(mTargetBoneTransforms, counts[14]);
+	reader.read(mPhaseResiduals, counts[15]);
+	reader.read(mStartSignedDistanceFieldPoses, counts[16]);
+	reader.read(mTargetSignedDistanceFieldPoses, counts[17]);
+	reader.read(mStartHeightFieldPoses, counts[18]);
+	reader.read(mTargetHeightFieldPoses, counts[19]);
+	reader.read(mParticleAccelerations, counts[20]);
+
+	mIterDtAvg.readData(scalars.mIterDtAvg, reader);
+	scalars.apply(*this);
+
+	NV_CLOTH_ASSERT(!reader.hasError());
+	return !reader.hasError();
+}
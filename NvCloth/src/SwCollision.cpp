@@ -34,8 +34,11 @@
 #include "BoundingBox.h"
 #include "PointInterpolator.h"
 #include "SwCollisionHelpers.h"
+#include "NvCloth/SignedDistanceField.h"
+#include "NvCloth/HeightField.h"
+#include <foundation/PxMat33.h>
 #include <foundation/PxProfiler.h>
-#include <cstring> // for memset
+#include <cstring> // for memset, memcpy
 #include "ps/PsSort.h"
 
 using namespace nv;
@@ -64,6 +67,7 @@ const Simd4fTupleFactory sMaskW = simd4f(simd4i(0, 0, 0, ~0));
 const Simd4fTupleFactory gSimd4fOneXYZ = simd4f(1.0f, 1.0f, 1.0f, 0.0f);
 const Simd4fScalarFactory sGridLength = simd4f(8 - 1e-3f); // sGridSize
 const Simd4fScalarFactory sGridExpand = simd4f(1e-4f);
+const float sGridCachePadding = 0.25f; // fraction of the particle bounds size
 const Simd4fTupleFactory sMinusFloatMaxXYZ = simd4f(-FLT_MAX, -FLT_MAX, -FLT_MAX, 0.0f);
 
 #if PX_PROFILE || PX_DEBUG
@@ -130,11 +134,15 @@ namespace nv
 namespace cloth
 {
 template <typename T4f>
-BoundingBox<T4f> expandBounds(const BoundingBox<T4f>& bbox, const SphereData* sIt, const SphereData* sEnd)
+BoundingBox<T4f> expandBounds(const BoundingBox<T4f>& bbox, const SphereData* sIt, const SphereData* sEnd,
+                              uint32_t sphereMask)
 {
 	BoundingBox<T4f> result = bbox;
-	for (; sIt != sEnd; ++sIt)
+	for (uint32_t mask = 0x1; sIt != sEnd; ++sIt, mask <<= 1)
 	{
+		if (!(mask & sphereMask))
+			continue;
+
 		T4f p = loadAligned(array(sIt->center));
 		T4f r = splat<3>(p);
 		result.mLower = min(result.mLower, p - r);
@@ -259,19 +267,44 @@ cloth::SwCollision<T4f>::CollisionData::CollisionData()
 
 template <typename T4f>
 cloth::SwCollision<T4f>::SwCollision(SwClothData& clothData, SwKernelAllocator& alloc)
-: mClothData(clothData), mAllocator(alloc)
+: mStartSpheres(reinterpret_cast<const T4f*>(clothData.mStartCollisionSpheres))
+, mTargetSpheres(reinterpret_cast<const T4f*>(clothData.mTargetCollisionSpheres))
+, mBoneSpheres(0)
+, mCache(0)
+, mParticleMasks(0)
+, mBoundsFused(false)
+, mClothData(clothData)
+, mAllocator(alloc)
 {
+	if (mClothData.mBoneSpheres)
+		transformBoneSpheres();
+
 	allocate(mCurData);
 
 	if (mClothData.mEnableContinuousCollision || mClothData.mFrictionScale > 0.0f)
 	{
 		allocate(mPrevData);
 
-		generateSpheres(reinterpret_cast<T4f*>(mPrevData.mSpheres),
-		                reinterpret_cast<const T4f*>(clothData.mStartCollisionSpheres), clothData.mNumSpheres);
+		generateSpheres(reinterpret_cast<T4f*>(mPrevData.mSpheres), mStartSpheres, clothData.mNumSpheres);
 
 		generateCones(mPrevData.mCones, mPrevData.mSpheres, clothData.mCapsuleIndices, clothData.mNumCapsules);
 	}
+
+	if (mStartSpheres == mTargetSpheres ||
+	    !memcmp(mStartSpheres, mTargetSpheres, sizeof(PxVec4) * clothData.mNumSpheres))
+	{
+		// spheres don't move during this frame, generate them once for all iterations
+		mCache = clothData.mCollisionCache;
+		mCache->update(reinterpret_cast<const PxVec4*>(mStartSpheres), clothData.mNumSpheres, clothData.mCapsuleIndices,
+		               clothData.mNumCapsules, clothData.mSphereMask);
+
+		generateSpheres(reinterpret_cast<T4f*>(mCurData.mSpheres), mStartSpheres, clothData.mNumSpheres);
+
+		generateCones(mCurData.mCones, mCurData.mSpheres, clothData.mCapsuleIndices, clothData.mNumCapsules);
+	}
+
+	if (clothData.mParticleCollisionMasks && clothData.mNumSpheres)
+		generateParticleMasks();
 }
 
 template <typename T4f>
@@ -279,42 +312,101 @@ cloth::SwCollision<T4f>::~SwCollision()
 {
 	deallocate(mCurData);
 	deallocate(mPrevData);
+	mAllocator.deallocate(mBoneSpheres);
+	mAllocator.deallocate(mParticleMasks);
 }
 
+// expand per particle sphere masks to sphere and cone masks of 4 particles each
 template <typename T4f>
-void cloth::SwCollision<T4f>::operator()(const IterationState<T4f>& state)
+void cloth::SwCollision<T4f>::generateParticleMasks()
 {
-	mNumCollisions = 0;
+	uint32_t numParticles = mClothData.mNumParticles;
+	uint32_t numGroups = (numParticles + 3) / 4;
+	mParticleMasks = static_cast<T4i*>(mAllocator.allocate(sizeof(T4i) * numGroups * 2));
 
-	collideConvexes(state);  // discrete convex collision, no friction
-	collideTriangles(state); // discrete triangle collision, no friction
+	const uint32_t* sIt = mClothData.mParticleCollisionMasks;
+	uint32_t* dIt = reinterpret_cast<uint32_t*>(mParticleMasks);
+	for (uint32_t i = 0; i < numGroups * 4; ++i)
+	{
+		uint32_t sphereMask = i < numParticles ? sIt[i] : 0;
 
-	computeBounds();
+		// capsules collide if both of their spheres do
+		uint32_t coneMask = 0;
+		for (uint32_t j = 0; j < mClothData.mNumCapsules; ++j)
+		{
+			uint32_t bothMask = 0x1u << mClothData.mCapsuleIndices[j].first | 0x1u << mClothData.mCapsuleIndices[j].second;
+			if ((sphereMask & bothMask) == bothMask)
+				coneMask |= 0x1u << j;
+		}
 
+		dIt[(i & ~3) * 2 + (i & 3)] = sphereMask;
+		dIt[(i & ~3) * 2 + (i & 3) + 4] = coneMask;
+	}
+}
+
+// transform bone space spheres to cloth space at the start and the end of the frame
+template <typename T4f>
+void cloth::SwCollision<T4f>::transformBoneSpheres()
+{
+	uint32_t numSpheres = mClothData.mNumSpheres;
+	mBoneSpheres = static_cast<T4f*>(mAllocator.allocate(sizeof(T4f) * numSpheres * 2));
+
+	const T4f* localIt = reinterpret_cast<const T4f*>(mClothData.mBoneSpheres);
+	const uint32_t* boneIt = mClothData.mSphereBoneIndices;
+	T4f* startIt = mBoneSpheres;
+	T4f* targetIt = mBoneSpheres + numSpheres;
+	for (uint32_t i = 0; i < numSpheres; ++i, ++localIt, ++boneIt, ++startIt, ++targetIt)
+	{
+		T4f local = *localIt;
+		T4f x = splat<0>(local);
+		T4f y = splat<1>(local);
+		T4f z = splat<2>(local);
+
+		// w of the translation column is 1, replaced by the radius
+		const float* start = mClothData.mStartBoneTransforms + 16 * *boneIt;
+		T4f center = load(start) * x + load(start + 4) * y + load(start + 8) * z + load(start + 12);
+		*startIt = select(sMaskW, local, center);
+
+		const float* target = mClothData.mTargetBoneTransforms + 16 * *boneIt;
+		center = load(target) * x + load(target + 4) * y + load(target + 8) * z + load(target + 12);
+		*targetIt = select(sMaskW, local, center);
+	}
+
+	mStartSpheres = mBoneSpheres;
+	mTargetSpheres = mClothData.mStartBoneTransforms == mClothData.mTargetBoneTransforms ? mStartSpheres
+	                                                                                     : mBoneSpheres + numSpheres;
+}
+
+template <typename T4f>
+void cloth::SwCollision<T4f>::collideSpheres(const IterationState<T4f>& state)
+{
 	if (!mClothData.mNumSpheres)
 		return;
 
-	bool lastIteration = state.mRemainingIterations == 1;
+	// static spheres have been generated in the constructor (current and previous data are identical)
+	if (!mCache)
+	{
+		bool lastIteration = state.mRemainingIterations == 1;
 
-	const T4f* targetSpheres = reinterpret_cast<const T4f*>(mClothData.mTargetCollisionSpheres);
+		const T4f* targetSpheres = mTargetSpheres;
 
-	// generate sphere and cone collision data
-	if (!lastIteration)
-	{
-		// interpolate spheres
-		LerpIterator<T4f, const T4f*> pIter(reinterpret_cast<const T4f*>(mClothData.mStartCollisionSpheres),
-		                                          targetSpheres, state.getCurrentAlpha());
-		generateSpheres(reinterpret_cast<T4f*>(mCurData.mSpheres), pIter, mClothData.mNumSpheres);
-	}
-	else
-	{
-		// otherwise use the target spheres directly
-		generateSpheres(reinterpret_cast<T4f*>(mCurData.mSpheres), targetSpheres, mClothData.mNumSpheres);
-	}
+		// generate sphere and cone collision data
+		if (!lastIteration)
+		{
+			// interpolate spheres
+			LerpIterator<T4f, const T4f*> pIter(mStartSpheres, targetSpheres, state.getCurrentAlpha());
+			generateSpheres(reinterpret_cast<T4f*>(mCurData.mSpheres), pIter, mClothData.mNumSpheres);
+		}
+		else
+		{
+			// otherwise use the target spheres directly
+			generateSpheres(reinterpret_cast<T4f*>(mCurData.mSpheres), targetSpheres, mClothData.mNumSpheres);
+		}
 
-	// generate cones even if test below fails because
-	// continuous collision might need it in next iteration
-	generateCones(mCurData.mCones, mCurData.mSpheres, mClothData.mCapsuleIndices, mClothData.mNumCapsules);
+		// generate cones even if test below fails because
+		// continuous collision might need it in next iteration
+		generateCones(mCurData.mCones, mCurData.mSpheres, mClothData.mCapsuleIndices, mClothData.mNumCapsules);
+	}
 
 	if (buildAcceleration())
 	{
@@ -327,7 +419,15 @@ void cloth::SwCollision<T4f>::operator()(const IterationState<T4f>& state)
 		if (!mClothData.mEnableContinuousCollision)
 			collideParticles();
 
-		collideVirtualParticles();
+		if (mClothData.mVirtualParticlesBegin != mClothData.mVirtualParticlesEnd)
+		{
+			// move dummy particles outside of collision range
+			T4f* __restrict dummy = mClothData.mNumParticles + reinterpret_cast<T4f*>(mClothData.mCurParticles);
+			T4f invGridScale = recip(mGridScale) & (mGridScale > gSimd4fEpsilon);
+			dummy[0] = dummy[1] = dummy[2] = invGridScale * mGridBias - invGridScale;
+
+			collideVirtualParticles(SphereCollider(*this), mClothData.mFrictionScale > 0.0f);
+		}
 	}
 
 	if (mPrevData.mSpheres)
@@ -340,8 +440,11 @@ size_t cloth::SwCollision<T4f>::estimateTemporaryMemory(const SwCloth& cloth)
 	size_t numTriangles = cloth.mStartCollisionTriangles.size();
 	size_t numPlanes = cloth.mStartCollisionPlanes.size();
 
-	const size_t kTriangleDataSize = sizeof(TriangleData) * numTriangles;
-	const size_t kPlaneDataSize = sizeof(PxVec4) * numPlanes * 2;
+	// continuous collision needs the shapes of the previous iteration as well
+	const size_t numCopies = cloth.mEnableContinuousCollision ? 2 : 1;
+
+	const size_t kTriangleDataSize = sizeof(TriangleData) * numTriangles * numCopies;
+	const size_t kPlaneDataSize = sizeof(PxVec4) * numPlanes * 2 * numCopies;
 
 	return std::max(kTriangleDataSize, kPlaneDataSize);
 }
@@ -349,13 +452,22 @@ size_t cloth::SwCollision<T4f>::estimateTemporaryMemory(const SwCloth& cloth)
 template <typename T4f>
 size_t cloth::SwCollision<T4f>::estimatePersistentMemory(const SwCloth& cloth)
 {
-	size_t numCapsules = cloth.mCapsuleIndices.size();
-	size_t numSpheres = cloth.mStartCollisionSpheres.size();
+	const CollisionShapeSet* shapeSet = cloth.mCollisionShapeSet;
+	size_t numCapsules = shapeSet ? shapeSet->mNumCapsules : cloth.mCapsuleIndices.size();
+	size_t numSpheres = shapeSet ? shapeSet->mNumSpheres : cloth.mStartCollisionSpheres.size();
+	if (!shapeSet && !cloth.mBoneSpheres.empty() && !cloth.mStartBoneTransforms.empty())
+		numSpheres = cloth.mBoneSpheres.size();
 
 	size_t sphereDataSize = sizeof(SphereData) * numSpheres * 2;
 	size_t coneDataSize = sizeof(ConeData) * numCapsules * 2;
 
-	return sphereDataSize + coneDataSize;
+	// sphere and cone mask per particle
+	size_t particleMaskSize = cloth.mParticleCollisionMasks.empty() ? 0 : sizeof(uint32_t) * 2 * (cloth.mCurParticles.size() + 3);
+
+	// start and target spheres transformed from bone space
+	size_t boneSphereSize = shapeSet || cloth.mStartBoneTransforms.empty() ? 0 : sizeof(PxVec4) * cloth.mBoneSpheres.size() * 2;
+
+	return sphereDataSize + coneDataSize + boneSphereSize + particleMaskSize;
 }
 
 template <typename T4f>
@@ -374,16 +486,27 @@ void cloth::SwCollision<T4f>::deallocate(const CollisionData& data)
 }
 
 template <typename T4f>
-void cloth::SwCollision<T4f>::computeBounds()
+bool cloth::SwCollision<T4f>::fuseBounds()
 {
-	NV_CLOTH_PROFILE_ZONE("cloth::SwSolverKernel::computeBounds", /*ProfileContext::None*/ 0);
+	if (mClothData.mNumConvexes || mClothData.mNumCollisionTriangles || mClothData.mNumSignedDistanceFields ||
+	    mClothData.mNumHeightFields)
+		return false;
+
+	mBounds = emptyBounds<T4f>();
+	mBoundsFused = true;
+	return true;
+}
 
-	T4f* prevIt = reinterpret_cast<T4f*>(mClothData.mPrevParticles);
-	T4f* curIt = reinterpret_cast<T4f*>(mClothData.mCurParticles);
-	T4f* curEnd = curIt + mClothData.mNumParticles;
+// expand the bounds by particles [first, last) and restore their invMass
+template <typename T4f>
+void cloth::SwCollision<T4f>::accumulateBounds(uint32_t first, uint32_t last)
+{
+	T4f* prevIt = reinterpret_cast<T4f*>(mClothData.mPrevParticles) + first;
+	T4f* curIt = reinterpret_cast<T4f*>(mClothData.mCurParticles) + first;
+	T4f* curEnd = reinterpret_cast<T4f*>(mClothData.mCurParticles) + last;
 	T4f floatMaxXYZ = -static_cast<T4f>(sMinusFloatMaxXYZ);
 
-	T4f lower = simd4f(FLT_MAX), upper = -lower;
+	T4f lower = mBounds.mLower, upper = mBounds.mUpper;
 	for (; curIt < curEnd; ++curIt, ++prevIt)
 	{
 		T4f current = *curIt;
@@ -393,13 +516,26 @@ void cloth::SwCollision<T4f>::computeBounds()
 		*curIt = select(current > floatMaxXYZ, *prevIt, current);
 	}
 
-	BoundingBox<T4f> curBounds;
-	curBounds.mLower = lower;
-	curBounds.mUpper = upper;
+	mBounds.mLower = lower;
+	mBounds.mUpper = upper;
+}
+
+template <typename T4f>
+void cloth::SwCollision<T4f>::computeBounds()
+{
+	NV_CLOTH_PROFILE_ZONE("cloth::SwSolverKernel::computeBounds", /*ProfileContext::None*/ 0);
+
+	// the solver kernel might have done the particle pass already
+	if (!mBoundsFused)
+	{
+		mBounds = emptyBounds<T4f>();
+		accumulateBounds(0, mClothData.mNumParticles);
+	}
+	mBoundsFused = false;
 
 	// don't change this order, storeBounds writes 7 floats
 	BoundingBox<T4f> prevBounds = loadBounds<T4f>(mClothData.mCurBounds);
-	storeBounds(mClothData.mCurBounds, curBounds);
+	storeBounds(mClothData.mCurBounds, mBounds);
 	storeBounds(mClothData.mPrevBounds, prevBounds);
 }
 
@@ -422,6 +558,9 @@ void cloth::SwCollision<T4f>::buildSphereAcceleration(const SphereData* sIt)
 	const SphereData* sEnd = sIt + mClothData.mNumSpheres;
 	for (; sIt != sEnd; ++sIt, mask <<= 1)
 	{
+		if (!(mask & mClothData.mSphereMask))
+			continue;
+
 		T4f sphere = loadAligned(array(sIt->center));
 		T4f radius = splat<3>(sphere);
 
@@ -457,11 +596,12 @@ void cloth::SwCollision<T4f>::buildConeAcceleration()
 	const ConeData* coneEnd = coneIt + mClothData.mNumCapsules;
 	for (uint32_t coneMask = 0x1; coneIt != coneEnd; ++coneIt, coneMask <<= 1)
 	{
-		if (coneIt->radius == 0.0f)
-			continue;
-
 		uint32_t spheresMask = coneIt->bothMask;
 
+		// skip degenerate cones and cones with a deselected sphere
+		if (coneIt->radius == 0.0f || (spheresMask & ~mClothData.mSphereMask))
+			continue;
+
 		uint32_t* sphereIt = reinterpret_cast<uint32_t*>(mSphereGrid);
 		uint32_t* sphereEnd = sphereIt + 6 * sGridSize;
 		uint32_t* gridIt = reinterpret_cast<uint32_t*>(mConeGrid);
@@ -485,9 +625,9 @@ void cloth::SwCollision<T4f>::mergeAcceleration(uint32_t* firstIt)
 template <typename T4f>
 bool cloth::SwCollision<T4f>::buildAcceleration()
 {
-	// determine single bounding box around all spheres
-	BoundingBox<T4f> sphereBounds =
-	    expandBounds(emptyBounds<T4f>(), mCurData.mSpheres, mCurData.mSpheres + mClothData.mNumSpheres);
+	// determine single bounding box around all selected spheres
+	BoundingBox<T4f> sphereBounds = expandBounds(emptyBounds<T4f>(), mCurData.mSpheres,
+	                                             mCurData.mSpheres + mClothData.mNumSpheres, mClothData.mSphereMask);
 
 	// determine single bounding box around all particles
 	BoundingBox<T4f> particleBounds = loadBounds<T4f>(mClothData.mCurBounds);
@@ -495,7 +635,8 @@ bool cloth::SwCollision<T4f>::buildAcceleration()
 	if (mClothData.mEnableContinuousCollision)
 	{
 		// extend bounds to include movement from previous frame
-		sphereBounds = expandBounds(sphereBounds, mPrevData.mSpheres, mPrevData.mSpheres + mClothData.mNumSpheres);
+		sphereBounds = expandBounds(sphereBounds, mPrevData.mSpheres, mPrevData.mSpheres + mClothData.mNumSpheres,
+		                            mClothData.mSphereMask);
 		particleBounds = expandBounds(particleBounds, loadBounds<T4f>(mClothData.mPrevBounds));
 	}
 
@@ -506,6 +647,32 @@ bool cloth::SwCollision<T4f>::buildAcceleration()
 	if (!allGreaterEqual(edgeLength, gSimd4fZero))
 		return false;
 
+	SwCollisionCache* cache = mCache;
+	if (cache)
+	{
+		// reuse the grid of the static spheres if it still covers the colliding region
+		BoundingBox<T4f> cachedBounds = loadBounds<T4f>(cache->mBounds);
+		if (cache->mValid &&
+		    allGreaterEqual((bounds.mLower - cachedBounds.mLower) & ~static_cast<T4f>(sMaskW), gSimd4fZero) &&
+		    allGreaterEqual((cachedBounds.mUpper - bounds.mUpper) & ~static_cast<T4f>(sMaskW), gSimd4fZero))
+		{
+			mGridScale = load(cache->mGridScale);
+			mGridBias = load(cache->mGridBias);
+			memcpy(mSphereGrid, cache->mSphereGrid, sizeof(uint32_t) * 6 * (sGridSize));
+			memcpy(mConeGrid, cache->mConeGrid, sizeof(uint32_t) * 6 * (sGridSize));
+			return true;
+		}
+
+		// grow the particle bounds so the new grid survives some cloth motion
+		T4f particleEdgeLength = particleBounds.mUpper - particleBounds.mLower;
+		const float* edgeLengths = array(particleEdgeLength);
+		T4f padding = simd4f(sGridCachePadding * std::max(std::max(edgeLengths[0], edgeLengths[1]), edgeLengths[2]));
+		particleBounds.mLower = particleBounds.mLower - padding;
+		particleBounds.mUpper = particleBounds.mUpper + padding;
+		bounds = intersectBounds(sphereBounds, particleBounds);
+		storeBounds(cache->mBounds, bounds);
+	}
+
 	// calculate an expanded bounds to account for numerical inaccuracy
 	const T4f expandedLower = bounds.mLower - abs(bounds.mLower) * sGridExpand;
 	const T4f expandedUpper = bounds.mUpper + abs(bounds.mUpper) * sGridExpand;
@@ -528,6 +695,15 @@ bool cloth::SwCollision<T4f>::buildAcceleration()
 	memset(mConeGrid, 0, sizeof(uint32_t) * 6 * (sGridSize));
 	buildConeAcceleration();
 
+	if (cache)
+	{
+		store(cache->mGridScale, mGridScale);
+		store(cache->mGridBias, mGridBias);
+		memcpy(cache->mSphereGrid, mSphereGrid, sizeof(uint32_t) * 6 * (sGridSize));
+		memcpy(cache->mConeGrid, mConeGrid, sizeof(uint32_t) * 6 * (sGridSize));
+		cache->mValid = true;
+	}
+
 	return true;
 }
 
@@ -537,6 +713,28 @@ bool cloth::SwCollision<T4f>::buildAcceleration()
 #define FORCE_INLINE inline __attribute__((always_inline))
 #endif
 
+// each pass transposes its blocks of 4 particles in registers, transposing the arrays in place once per
+// iteration costs 4 extra sweeps over the particles and didn't pay off even with 3 collision passes
+template <typename T4f>
+FORCE_INLINE void cloth::SwCollision<T4f>::loadParticles(const float* __restrict pIt, T4f* positions) const
+{
+	positions[0] = loadAligned(pIt, 0);
+	positions[1] = loadAligned(pIt, 16);
+	positions[2] = loadAligned(pIt, 32);
+	positions[3] = loadAligned(pIt, 48);
+	transpose(positions[0], positions[1], positions[2], positions[3]); //group values by axis in simd structure
+}
+
+template <typename T4f>
+FORCE_INLINE void cloth::SwCollision<T4f>::storeParticles(float* __restrict pIt, T4f* positions) const
+{
+	transpose(positions[0], positions[1], positions[2], positions[3]);
+	storeAligned(pIt, 0, positions[0]);
+	storeAligned(pIt, 16, positions[1]);
+	storeAligned(pIt, 32, positions[2]);
+	storeAligned(pIt, 48, positions[3]);
+}
+
 template <typename T4f>
 FORCE_INLINE typename cloth::SwCollision<T4f>::ShapeMask& cloth::SwCollision<T4f>::ShapeMask::
 operator = (const ShapeMask& right)
@@ -741,7 +939,8 @@ FORCE_INLINE void cloth::SwCollision<T4f>::collideSpheres(const T4i& sphereMask,
 
 template <typename T4f>
 FORCE_INLINE typename cloth::SwCollision<T4f>::T4i
-cloth::SwCollision<T4f>::collideCones(const T4f* __restrict positions, ImpulseAccumulator& accum) const
+cloth::SwCollision<T4f>::collideCones(const T4f* __restrict positions, const T4i* __restrict particleMask,
+                                         ImpulseAccumulator& accum) const
 {
 	const float* __restrict centerPtr = array(mCurData.mCones->center);
 	const float* __restrict axisPtr = array(mCurData.mCones->axis);
@@ -750,6 +949,12 @@ cloth::SwCollision<T4f>::collideCones(const T4f* __restrict positions, ImpulseAc
 	bool frictionEnabled = mClothData.mFrictionScale > 0.0f;
 
 	ShapeMask shapeMask = getShapeMask(positions);
+	if (particleMask)
+	{
+		shapeMask.mSpheres = shapeMask.mSpheres & particleMask[0];
+		shapeMask.mCones = shapeMask.mCones & particleMask[1];
+	}
+
 	T4i mask4 = horizontalOr(shapeMask.mCones);
 	uint32_t mask = uint32_t(array(mask4)[0]);
 	while (mask)
@@ -975,7 +1180,7 @@ FORCE_INLINE void cloth::SwCollision<T4f>::collideSpheres(const T4i& sphereMask,
 template <typename T4f>
 FORCE_INLINE typename cloth::SwCollision<T4f>::T4i
 cloth::SwCollision<T4f>::collideCones(const T4f* __restrict prevPos, T4f* __restrict curPos,
-                                         ImpulseAccumulator& accum) const
+                                         const T4i* __restrict particleMask, ImpulseAccumulator& accum) const
 {
 	const float* __restrict prevCenterPtr = array(mPrevData.mCones->center);
 	const float* __restrict prevAxisPtr = array(mPrevData.mCones->axis);
@@ -988,6 +1193,12 @@ cloth::SwCollision<T4f>::collideCones(const T4f* __restrict prevPos, T4f* __rest
 	bool frictionEnabled = mClothData.mFrictionScale > 0.0f;
 
 	ShapeMask shapeMask = getShapeMask(prevPos, curPos);
+	if (particleMask)
+	{
+		shapeMask.mSpheres = shapeMask.mSpheres & particleMask[0];
+		shapeMask.mCones = shapeMask.mCones & particleMask[1];
+	}
+
 	T4i mask4 = horizontalOr(shapeMask.mCones);
 	uint32_t mask = uint32_t(array(mask4)[0]);
 	while (mask)
@@ -1282,19 +1493,16 @@ void cloth::SwCollision<T4f>::collideParticles()
 	float* __restrict prevIt = mClothData.mPrevParticles;
 	float* __restrict pIt = mClothData.mCurParticles;
 	float* __restrict pEnd = pIt + mClothData.mNumParticles * 4;
+	const T4i* __restrict particleMask = mParticleMasks;
 	//loop over particles 4 at a time
-	for (; pIt < pEnd; pIt += 16, prevIt += 16)
+	for (; pIt < pEnd; pIt += 16, prevIt += 16, particleMask += particleMask ? 2 : 0)
 	{
-		curPos[0] = loadAligned(pIt, 0);
-		curPos[1] = loadAligned(pIt, 16);
-		curPos[2] = loadAligned(pIt, 32);
-		curPos[3] = loadAligned(pIt, 48);
-		transpose(curPos[0], curPos[1], curPos[2], curPos[3]); //group values by axis in simd structure
+		loadParticles(pIt, curPos);
 
 		ImpulseAccumulator accum;
 
 		//first collide cones
-		T4i sphereMask = collideCones(curPos, accum);
+		T4i sphereMask = collideCones(curPos, particleMask, accum);
 		//pass on hit mask to ignore sphere parts that are inside the cones
 		collideSpheres(sphereMask, curPos, accum);
 
@@ -1306,11 +1514,7 @@ void cloth::SwCollision<T4f>::collideParticles()
 
 		if (frictionEnabled)
 		{
-			prevPos[0] = loadAligned(prevIt, 0);
-			prevPos[1] = loadAligned(prevIt, 16);
-			prevPos[2] = loadAligned(prevIt, 32);
-			prevPos[3] = loadAligned(prevIt, 48);
-			transpose(prevPos[0], prevPos[1], prevPos[2], prevPos[3]);
+			loadParticles(prevIt, prevPos);
 
 			T4f frictionImpulse[3];
 			calculateFrictionImpulse(accum.mDeltaX, accum.mDeltaY, accum.mDeltaZ, accum.mVelX, accum.mVelY, accum.mVelZ,
@@ -1320,11 +1524,7 @@ void cloth::SwCollision<T4f>::collideParticles()
 			prevPos[1] = prevPos[1] - frictionImpulse[1];
 			prevPos[2] = prevPos[2] - frictionImpulse[2];
 
-			transpose(prevPos[0], prevPos[1], prevPos[2], prevPos[3]);
-			storeAligned(prevIt, 0, prevPos[0]);
-			storeAligned(prevIt, 16, prevPos[1]);
-			storeAligned(prevIt, 32, prevPos[2]);
-			storeAligned(prevIt, 48, prevPos[3]);
+			storeParticles(prevIt, prevPos);
 		}
 
 		if (massScalingEnabled)
@@ -1344,11 +1544,7 @@ void cloth::SwCollision<T4f>::collideParticles()
 		curPos[1] = curPos[1] + accum.mDeltaY * invNumCollisions;
 		curPos[2] = curPos[2] + accum.mDeltaZ * invNumCollisions;
 
-		transpose(curPos[0], curPos[1], curPos[2], curPos[3]);
-		storeAligned(pIt, 0, curPos[0]);
-		storeAligned(pIt, 16, curPos[1]);
-		storeAligned(pIt, 32, curPos[2]);
-		storeAligned(pIt, 48, curPos[3]);
+		storeParticles(pIt, curPos);
 
 #if PX_PROFILE || PX_DEBUG
 		mNumCollisions += horizontalSum(accum.mNumCollisions);
@@ -1356,13 +1552,55 @@ void cloth::SwCollision<T4f>::collideParticles()
 	}
 }
 
+// collides virtual particles with spheres and cones
+template <typename T4f>
+struct cloth::SwCollision<T4f>::SphereCollider
+{
+	SphereCollider(const SwCollision& collision) : mCollision(collision)
+	{
+	}
+
+	void operator()(T4f* curPos, const uint16_t* vpIt, ImpulseAccumulator& accum) const
+	{
+		const SwClothData& clothData = mCollision.mClothData;
+
+		// virtual particles collide with the shapes of any of their triangle corners
+		T4i particleMask[2];
+		if (mCollision.mParticleMasks)
+		{
+			const uint32_t* masks = clothData.mParticleCollisionMasks;
+			uint32_t sphereMasks[4];
+			for (uint32_t i = 0; i < 4; ++i)
+				sphereMasks[i] = masks[vpIt[i * 4]] | masks[vpIt[i * 4 + 1]] | masks[vpIt[i * 4 + 2]];
+			particleMask[0] = simd4i(int(sphereMasks[0]), int(sphereMasks[1]), int(sphereMasks[2]), int(sphereMasks[3]));
+
+			// capsules collide if both of their spheres do
+			uint32_t coneMasks[4] = { 0, 0, 0, 0 };
+			for (uint32_t j = 0; j < clothData.mNumCapsules; ++j)
+			{
+				uint32_t bothMask = 0x1u << clothData.mCapsuleIndices[j].first | 0x1u << clothData.mCapsuleIndices[j].second;
+				for (uint32_t i = 0; i < 4; ++i)
+					coneMasks[i] |= (sphereMasks[i] & bothMask) == bothMask ? 0x1u << j : 0;
+			}
+			particleMask[1] = simd4i(int(coneMasks[0]), int(coneMasks[1]), int(coneMasks[2]), int(coneMasks[3]));
+		}
+
+		T4i sphereMask = mCollision.collideCones(curPos, mCollision.mParticleMasks ? particleMask : 0, accum);
+		mCollision.collideSpheres(sphereMask, curPos, accum);
+	}
+
+	const SwCollision& mCollision;
+};
+
+// interpolate virtual particles 4 at a time, collide them with one shape type
+// and distribute the resulting displacement to the triangle particles
 template <typename T4f>
-void cloth::SwCollision<T4f>::collideVirtualParticles()
+template <typename ShapeCollider>
+void cloth::SwCollision<T4f>::collideVirtualParticles(const ShapeCollider& collider, bool frictionEnabled)
 {
 	const bool massScalingEnabled = mClothData.mCollisionMassScale > 0.0f;
 	const T4f massScale = simd4f(mClothData.mCollisionMassScale);
 
-	const bool frictionEnabled = mClothData.mFrictionScale > 0.0f;
 	const T4f frictionScale = simd4f(mClothData.mFrictionScale);
 
 	T4f curPos[3];
@@ -1371,11 +1609,6 @@ void cloth::SwCollision<T4f>::collideVirtualParticles()
 	float* __restrict particles = mClothData.mCurParticles;
 	float* __restrict prevParticles = mClothData.mPrevParticles;
 
-	// move dummy particles outside of collision range
-	T4f* __restrict dummy = mClothData.mNumParticles + reinterpret_cast<T4f*>(mClothData.mCurParticles);
-	T4f invGridScale = recip(mGridScale) & (mGridScale > gSimd4fEpsilon);
-	dummy[0] = dummy[1] = dummy[2] = invGridScale * mGridBias - invGridScale;
-
 	const uint16_t* __restrict vpIt = mClothData.mVirtualParticlesBegin;
 	const uint16_t* __restrict vpEnd = mClothData.mVirtualParticlesEnd;
 	for (; vpIt != vpEnd; vpIt += 16)
@@ -1413,8 +1646,7 @@ void cloth::SwCollision<T4f>::collideVirtualParticles()
 		curPos[2] = pz;
 
 		ImpulseAccumulator accum;
-		T4i sphereMask = collideCones(curPos, accum);
-		collideSpheres(sphereMask, curPos, accum);
+		collider(curPos, vpIt, accum);
 
 		T4f mask;
 		if (!anyGreater(accum.mNumCollisions, gSimd4fEpsilon, mask))
@@ -1591,23 +1823,16 @@ void cloth::SwCollision<T4f>::collideContinuousParticles()
 	float* __restrict prevIt = mClothData.mPrevParticles;
 	float* __restrict curIt = mClothData.mCurParticles;
 	float* __restrict curEnd = curIt + mClothData.mNumParticles * 4;
+	const T4i* __restrict particleMask = mParticleMasks;
 
-	for (; curIt < curEnd; curIt += 16, prevIt += 16)
+	for (; curIt < curEnd; curIt += 16, prevIt += 16, particleMask += particleMask ? 2 : 0)
 	{
-		prevPos[0] = loadAligned(prevIt, 0);
-		prevPos[1] = loadAligned(prevIt, 16);
-		prevPos[2] = loadAligned(prevIt, 32);
-		prevPos[3] = loadAligned(prevIt, 48);
-		transpose(prevPos[0], prevPos[1], prevPos[2], prevPos[3]);
-
-		curPos[0] = loadAligned(curIt, 0);
-		curPos[1] = loadAligned(curIt, 16);
-		curPos[2] = loadAligned(curIt, 32);
-		curPos[3] = loadAligned(curIt, 48);
-		transpose(curPos[0], curPos[1], curPos[2], curPos[3]);
+		loadParticles(prevIt, prevPos);
+
+		loadParticles(curIt, curPos);
 
 		ImpulseAccumulator accum;
-		T4i sphereMask = collideCones(prevPos, curPos, accum);
+		T4i sphereMask = collideCones(prevPos, curPos, particleMask, accum);
 		collideSpheres(sphereMask, prevPos, curPos, accum);
 
 		T4f mask;
@@ -1626,11 +1851,7 @@ void cloth::SwCollision<T4f>::collideContinuousParticles()
 			prevPos[1] = prevPos[1] - frictionImpulse[1];
 			prevPos[2] = prevPos[2] - frictionImpulse[2];
 
-			transpose(prevPos[0], prevPos[1], prevPos[2], prevPos[3]);
-			storeAligned(prevIt, 0, prevPos[0]);
-			storeAligned(prevIt, 16, prevPos[1]);
-			storeAligned(prevIt, 32, prevPos[2]);
-			storeAligned(prevIt, 48, prevPos[3]);
+			storeParticles(prevIt, prevPos);
 		}
 
 		if (massScalingEnabled)
@@ -1649,11 +1870,7 @@ void cloth::SwCollision<T4f>::collideContinuousParticles()
 		curPos[1] = curPos[1] + accum.mDeltaY * invNumCollisions;
 		curPos[2] = curPos[2] + accum.mDeltaZ * invNumCollisions;
 
-		transpose(curPos[0], curPos[1], curPos[2], curPos[3]);
-		storeAligned(curIt, 0, curPos[0]);
-		storeAligned(curIt, 16, curPos[1]);
-		storeAligned(curIt, 32, curPos[2]);
-		storeAligned(curIt, 48, curPos[3]);
+		storeParticles(curIt, curPos);
 
 #if PX_PROFILE || PX_DEBUG
 		mNumCollisions += horizontalSum(accum.mNumCollisions);
@@ -1661,15 +1878,37 @@ void cloth::SwCollision<T4f>::collideContinuousParticles()
 	}
 }
 
+// collides virtual particles with convexes
+template <typename T4f>
+struct cloth::SwCollision<T4f>::ConvexCollider
+{
+	ConvexCollider(SwCollision& collision, const T4f* planes) : mCollision(collision), mPlanes(planes)
+	{
+	}
+
+	void operator()(T4f* curPos, const uint16_t*, ImpulseAccumulator& accum) const
+	{
+		mCollision.collideConvexes(mPlanes, curPos, accum);
+	}
+
+	SwCollision& mCollision;
+	const T4f* mPlanes;
+};
+
 template <typename T4f>
 void cloth::SwCollision<T4f>::collideConvexes(const IterationState<T4f>& state)
 {
 	if (!mClothData.mNumConvexes)
 		return;
 
-	// times 2 for plane equation result buffer
-	T4f* planes = static_cast<T4f*>(mAllocator.allocate(sizeof(T4f) * mClothData.mNumPlanes * 2));
+	const bool continuousCollision = mClothData.mEnableContinuousCollision;
 
+	// times 2 for plane equation result buffer, times 2 again for the previous iteration planes
+	uint32_t numPlaneData = mClothData.mNumPlanes * 2;
+	T4f* planes = static_cast<T4f*>(mAllocator.allocate(sizeof(T4f) * numPlaneData * (continuousCollision ? 2 : 1)));
+	T4f* prevPlanes = planes + numPlaneData;
+
+	const T4f* startPlanes = reinterpret_cast<const T4f*>(mClothData.mStartCollisionPlanes);
 	const T4f* targetPlanes = reinterpret_cast<const T4f*>(mClothData.mTargetCollisionPlanes);
 
 	// generate plane collision data
@@ -1688,6 +1927,13 @@ void cloth::SwCollision<T4f>::collideConvexes(const IterationState<T4f>& state)
 		generatePlanes(planes, targetPlanes, mClothData.mNumPlanes);
 	}
 
+	if (continuousCollision)
+	{
+		// planes of the previous iteration
+		LerpIterator<T4f, const T4f*> prevPlaneIter(startPlanes, targetPlanes, state.getPreviousAlpha());
+		generatePlanes(prevPlanes, prevPlaneIter, mClothData.mNumPlanes);
+	}
+
 	T4f curPos[4], prevPos[4];
 
 	const bool frictionEnabled = mClothData.mFrictionScale > 0.0f;
@@ -1698,14 +1944,18 @@ void cloth::SwCollision<T4f>::collideConvexes(const IterationState<T4f>& state)
 	float* __restrict prevIt = mClothData.mPrevParticles;
 	for (; curIt < curEnd; curIt += 16, prevIt += 16)
 	{
-		curPos[0] = loadAligned(curIt, 0);
-		curPos[1] = loadAligned(curIt, 16);
-		curPos[2] = loadAligned(curIt, 32);
-		curPos[3] = loadAligned(curIt, 48);
-		transpose(curPos[0], curPos[1], curPos[2], curPos[3]);
+		loadParticles(curIt, curPos);
+
+		if (continuousCollision || frictionEnabled)
+		{
+			loadParticles(prevIt, prevPos);
+		}
 
 		ImpulseAccumulator accum;
-		collideConvexes(planes, curPos, accum);
+		if (continuousCollision)
+			collideConvexes(planes, prevPlanes, prevPos, curPos, accum);
+		else
+			collideConvexes(planes, curPos, accum);
 
 		T4f mask;
 		if (!anyGreater(accum.mNumCollisions, gSimd4fEpsilon, mask))
@@ -1715,12 +1965,6 @@ void cloth::SwCollision<T4f>::collideConvexes(const IterationState<T4f>& state)
 
 		if (frictionEnabled)
 		{
-			prevPos[0] = loadAligned(prevIt, 0);
-			prevPos[1] = loadAligned(prevIt, 16);
-			prevPos[2] = loadAligned(prevIt, 32);
-			prevPos[3] = loadAligned(prevIt, 48);
-			transpose(prevPos[0], prevPos[1], prevPos[2], prevPos[3]);
-
 			T4f frictionImpulse[3];
 			calculateFrictionImpulse(accum.mDeltaX, accum.mDeltaY, accum.mDeltaZ, accum.mVelX, accum.mVelY, accum.mVelZ,
 			                         curPos, prevPos, invNumCollisions, frictionScale, mask, frictionImpulse);
@@ -1729,28 +1973,23 @@ void cloth::SwCollision<T4f>::collideConvexes(const IterationState<T4f>& state)
 			prevPos[1] = prevPos[1] - frictionImpulse[1];
 			prevPos[2] = prevPos[2] - frictionImpulse[2];
 
-			transpose(prevPos[0], prevPos[1], prevPos[2], prevPos[3]);
-			storeAligned(prevIt, 0, prevPos[0]);
-			storeAligned(prevIt, 16, prevPos[1]);
-			storeAligned(prevIt, 32, prevPos[2]);
-			storeAligned(prevIt, 48, prevPos[3]);
+			storeParticles(prevIt, prevPos);
 		}
 
 		curPos[0] = curPos[0] + accum.mDeltaX * invNumCollisions;
 		curPos[1] = curPos[1] + accum.mDeltaY * invNumCollisions;
 		curPos[2] = curPos[2] + accum.mDeltaZ * invNumCollisions;
 
-		transpose(curPos[0], curPos[1], curPos[2], curPos[3]);
-		storeAligned(curIt, 0, curPos[0]);
-		storeAligned(curIt, 16, curPos[1]);
-		storeAligned(curIt, 32, curPos[2]);
-		storeAligned(curIt, 48, curPos[3]);
+		storeParticles(curIt, curPos);
 
 #if PX_PROFILE || PX_DEBUG
 		mNumCollisions += horizontalSum(accum.mNumCollisions);
 #endif
 	}
 
+	if (mClothData.mVirtualParticlesBegin != mClothData.mVirtualParticlesEnd)
+		collideVirtualParticles(ConvexCollider(*this, planes), frictionEnabled);
+
 	mAllocator.deallocate(planes);
 }
 
@@ -1806,46 +2045,175 @@ void cloth::SwCollision<T4f>::collideConvexes(const T4f* __restrict planes, T4f*
 	}
 }
 
+// swept convex collision: particles that entered a convex during the iteration
+// are pushed back through the plane they entered, instead of the closest one
+template <typename T4f>
+void cloth::SwCollision<T4f>::collideConvexes(const T4f* __restrict planes, const T4f* __restrict prevPlanes,
+                                                 const T4f* __restrict prevPos, T4f* __restrict curPos,
+                                                 ImpulseAccumulator& accum)
+{
+	T4i curResult = gSimd4iZero; // planes the current position is behind
+	T4i sweptResult = gSimd4iZero; // planes the particle path is partially behind
+	T4i mask4 = gSimd4iOne;
+
+	const T4f* __restrict pIt, *pEnd = planes + mClothData.mNumPlanes;
+	const T4f* __restrict qIt = prevPlanes, *qEnd = prevPlanes + mClothData.mNumPlanes;
+	T4f* __restrict dIt = const_cast<T4f*>(pEnd);
+	T4f* __restrict eIt = const_cast<T4f*>(qEnd);
+	for (pIt = planes; pIt != pEnd; ++pIt, ++qIt, ++dIt, ++eIt)
+	{
+		*dIt = splat<3>(*pIt) + curPos[2] * splat<2>(*pIt) + curPos[1] * splat<1>(*pIt) + curPos[0] * splat<0>(*pIt);
+		*eIt = splat<3>(*qIt) + prevPos[2] * splat<2>(*qIt) + prevPos[1] * splat<1>(*qIt) + prevPos[0] * splat<0>(*qIt);
+		curResult = curResult | (mask4 & simd4i(*dIt < gSimd4fZero));
+		sweptResult = sweptResult | (mask4 & simd4i(min(*dIt, *eIt) < gSimd4fZero));
+		mask4 = mask4 << 1; // todo: shift by T4i on consoles
+	}
+
+	if (allEqual(sweptResult, gSimd4iZero))
+		return;
+
+	const uint32_t* __restrict cIt = mClothData.mConvexMasks;
+	const uint32_t* __restrict cEnd = cIt + mClothData.mNumConvexes;
+	for (; cIt != cEnd; ++cIt)
+	{
+		uint32_t mask = *cIt;
+		mask4 = simd4i(int(mask));
+		T4i sweptMask4;
+		if (!anyEqual(mask4 & sweptResult, mask4, sweptMask4))
+			continue;
+
+		T4i curMask4;
+		anyEqual(mask4 & curResult, mask4, curMask4);
+
+		// closest plane at the current position, and the plane the path enters last
+		T4f planeX, planeY, planeZ, planeD = -gSimd4fFloatMax;
+		T4f entryX, entryY, entryZ, entryD = gSimd4fZero;
+		T4f entryTime = gSimd4fMinusOne;
+		T4f exitTime = gSimd4fOne;
+		planeX = planeY = planeZ = entryX = entryY = entryZ = gSimd4fZero;
+
+		do
+		{
+			uint32_t test = mask - 1;
+			uint32_t planeIndex = findBitSet(mask & ~test);
+			mask &= test;
+
+			T4f plane = planes[planeIndex];
+			T4f dist = pEnd[planeIndex];
+			T4f prevDist = qEnd[planeIndex];
+
+			T4f closer = dist > planeD;
+			planeX = select(closer, splat<0>(plane), planeX);
+			planeY = select(closer, splat<1>(plane), planeY);
+			planeZ = select(closer, splat<2>(plane), planeZ);
+			planeD = max(dist, planeD);
+
+			// time the path crosses the plane
+			T4f entering = (prevDist >= gSimd4fZero) & (gSimd4fZero > dist);
+			T4f exiting = (gSimd4fZero > prevDist) & (dist >= gSimd4fZero);
+			T4f denom = select(entering | exiting, prevDist - dist, gSimd4fOne);
+			T4f time = prevDist * recip(denom);
+
+			T4f later = entering & (time > entryTime);
+			entryX = select(later, splat<0>(plane), entryX);
+			entryY = select(later, splat<1>(plane), entryY);
+			entryZ = select(later, splat<2>(plane), entryZ);
+			entryD = select(later, dist, entryD);
+			entryTime = select(later, time, entryTime);
+			exitTime = select(exiting, min(time, exitTime), exitTime);
+		} while (mask);
+
+		// the path is inside all planes between entry and exit time
+		T4f hit = simd4f(sweptMask4) & (entryTime >= gSimd4fZero) & (exitTime >= entryTime);
+
+		planeX = select(hit, entryX, planeX);
+		planeY = select(hit, entryY, planeY);
+		planeZ = select(hit, entryZ, planeZ);
+		planeD = select(hit, entryD, planeD);
+
+		accum.subtract(planeX, planeY, planeZ, planeD, hit | simd4f(curMask4));
+	}
+}
+
+// collides virtual particles with collision triangles
+template <typename T4f>
+struct cloth::SwCollision<T4f>::TriangleCollider
+{
+	TriangleCollider(SwCollision& collision, const TriangleData* triangles) : mCollision(collision), mTriangles(triangles)
+	{
+	}
+
+	void operator()(T4f* curPos, const uint16_t*, ImpulseAccumulator& accum) const
+	{
+		mCollision.collideTriangles(mTriangles, curPos, accum);
+	}
+
+	SwCollision& mCollision;
+	const TriangleData* mTriangles;
+};
+
 template <typename T4f>
 void cloth::SwCollision<T4f>::collideTriangles(const IterationState<T4f>& state)
 {
 	if (!mClothData.mNumCollisionTriangles)
 		return;
 
-	TriangleData* triangles =
-	    static_cast<TriangleData*>(mAllocator.allocate(sizeof(TriangleData) * mClothData.mNumCollisionTriangles));
+	const bool continuousCollision = mClothData.mEnableContinuousCollision;
+
+	// times 2 for the previous iteration triangles
+	uint32_t numTriangles = mClothData.mNumCollisionTriangles;
+	TriangleData* triangles = static_cast<TriangleData*>(
+	    mAllocator.allocate(sizeof(TriangleData) * numTriangles * (continuousCollision ? 2 : 1)));
+	TriangleData* prevTriangles = triangles + numTriangles;
 
+	UnalignedIterator<T4f, 3> startTriangles(mClothData.mStartCollisionTriangles);
 	UnalignedIterator<T4f, 3> targetTriangles(mClothData.mTargetCollisionTriangles);
 
 	// generate triangle collision data
 	if (state.mRemainingIterations != 1)
 	{
 		// interpolate triangles
-		LerpIterator<T4f, UnalignedIterator<T4f, 3> > triangleIter(mClothData.mStartCollisionTriangles,
-		                                                                 targetTriangles, state.getCurrentAlpha());
+		LerpIterator<T4f, UnalignedIterator<T4f, 3> > triangleIter(startTriangles, targetTriangles,
+		                                                                 state.getCurrentAlpha());
 
-		generateTriangles<T4f>(triangles, triangleIter, mClothData.mNumCollisionTriangles);
+		generateTriangles<T4f>(triangles, triangleIter, numTriangles);
 	}
 	else
 	{
 		// otherwise use the target triangles directly
-		generateTriangles<T4f>(triangles, targetTriangles, mClothData.mNumCollisionTriangles);
+		generateTriangles<T4f>(triangles, targetTriangles, numTriangles);
 	}
 
-	T4f positions[4];
+	if (continuousCollision)
+	{
+		// triangles of the previous iteration
+		LerpIterator<T4f, UnalignedIterator<T4f, 3> > prevTriangleIter(startTriangles, targetTriangles,
+		                                                                     state.getPreviousAlpha());
+		generateTriangles<T4f>(prevTriangles, prevTriangleIter, numTriangles);
+	}
 
-	float* __restrict pIt = mClothData.mCurParticles;
-	float* __restrict pEnd = pIt + mClothData.mNumParticles * 4;
-	for (; pIt < pEnd; pIt += 16)
+	T4f curPos[4], prevPos[4];
+
+	const bool frictionEnabled = mClothData.mFrictionScale > 0.0f;
+	const T4f frictionScale = simd4f(mClothData.mFrictionScale);
+
+	float* __restrict curIt = mClothData.mCurParticles;
+	float* __restrict curEnd = curIt + mClothData.mNumParticles * 4;
+	float* __restrict prevIt = mClothData.mPrevParticles;
+	for (; curIt < curEnd; curIt += 16, prevIt += 16)
 	{
-		positions[0] = loadAligned(pIt, 0);
-		positions[1] = loadAligned(pIt, 16);
-		positions[2] = loadAligned(pIt, 32);
-		positions[3] = loadAligned(pIt, 48);
-		transpose(positions[0], positions[1], positions[2], positions[3]);
+		loadParticles(curIt, curPos);
+
+		if (continuousCollision || frictionEnabled)
+		{
+			loadParticles(prevIt, prevPos);
+		}
 
 		ImpulseAccumulator accum;
-		collideTriangles(triangles, positions, accum);
+		if (continuousCollision)
+			collideTriangles(triangles, prevTriangles, prevPos, curPos, accum);
+		else
+			collideTriangles(triangles, curPos, accum);
 
 		T4f mask;
 		if (!anyGreater(accum.mNumCollisions, gSimd4fEpsilon, mask))
@@ -1853,21 +2221,33 @@ void cloth::SwCollision<T4f>::collideTriangles(const IterationState<T4f>& state)
 
 		T4f invNumCollisions = recip(accum.mNumCollisions);
 
-		positions[0] = positions[0] + accum.mDeltaX * invNumCollisions;
-		positions[1] = positions[1] + accum.mDeltaY * invNumCollisions;
-		positions[2] = positions[2] + accum.mDeltaZ * invNumCollisions;
+		if (frictionEnabled)
+		{
+			T4f frictionImpulse[3];
+			calculateFrictionImpulse(accum.mDeltaX, accum.mDeltaY, accum.mDeltaZ, accum.mVelX, accum.mVelY, accum.mVelZ,
+			                         curPos, prevPos, invNumCollisions, frictionScale, mask, frictionImpulse);
+
+			prevPos[0] = prevPos[0] - frictionImpulse[0];
+			prevPos[1] = prevPos[1] - frictionImpulse[1];
+			prevPos[2] = prevPos[2] - frictionImpulse[2];
 
-		transpose(positions[0], positions[1], positions[2], positions[3]);
-		storeAligned(pIt, 0, positions[0]);
-		storeAligned(pIt, 16, positions[1]);
-		storeAligned(pIt, 32, positions[2]);
-		storeAligned(pIt, 48, positions[3]);
+			storeParticles(prevIt, prevPos);
+		}
+
+		curPos[0] = curPos[0] + accum.mDeltaX * invNumCollisions;
+		curPos[1] = curPos[1] + accum.mDeltaY * invNumCollisions;
+		curPos[2] = curPos[2] + accum.mDeltaZ * invNumCollisions;
+
+		storeParticles(curIt, curPos);
 
 #if PX_PROFILE || PX_DEBUG
 		mNumCollisions += horizontalSum(accum.mNumCollisions);
 #endif
 	}
 
+	if (mClothData.mVirtualParticlesBegin != mClothData.mVirtualParticlesEnd)
+		collideVirtualParticles(TriangleCollider(*this, triangles), frictionEnabled);
+
 	mAllocator.deallocate(triangles);
 }
 
@@ -1958,6 +2338,620 @@ void cloth::SwCollision<T4f>::collideTriangles(const TriangleData* __restrict tr
 	accum.subtract(normalX, normalY, normalZ, normalD, mask);
 }
 
+// swept triangle collision: particles that passed through the front of a triangle
+// during the iteration are pushed back to its front, otherwise resolve discretely
+template <typename T4f>
+void cloth::SwCollision<T4f>::collideTriangles(const TriangleData* __restrict triangles,
+                                                  const TriangleData* __restrict prevTriangles,
+                                                  const T4f* __restrict prevPos, T4f* __restrict curPos,
+                                                  ImpulseAccumulator& accum)
+{
+	T4f hitX, hitY, hitZ, hitD;
+	hitX = hitY = hitZ = hitD = gSimd4fZero;
+	T4f hitTime = gSimd4fOne;
+	T4f hit = gSimd4fZero;
+
+	T4f moveX = curPos[0] - prevPos[0];
+	T4f moveY = curPos[1] - prevPos[1];
+	T4f moveZ = curPos[2] - prevPos[2];
+
+	const TriangleData* __restrict tIt, *tEnd = triangles + mClothData.mNumCollisionTriangles;
+	const TriangleData* __restrict qIt = prevTriangles;
+	for (tIt = triangles; tIt != tEnd; ++tIt, ++qIt)
+	{
+		T4f base = loadAligned(&tIt->base.x);
+		T4f normal = loadAligned(&tIt->normal.x);
+		T4f prevBase = loadAligned(&qIt->base.x);
+		T4f prevNormal = loadAligned(&qIt->normal.x);
+
+		T4f nx = splat<0>(normal);
+		T4f ny = splat<1>(normal);
+		T4f nz = splat<2>(normal);
+
+		T4f dist = (curPos[0] - splat<0>(base)) * nx + (curPos[1] - splat<1>(base)) * ny +
+		           (curPos[2] - splat<2>(base)) * nz;
+		T4f prevDist = (prevPos[0] - splat<0>(prevBase)) * splat<0>(prevNormal) +
+		               (prevPos[1] - splat<1>(prevBase)) * splat<1>(prevNormal) +
+		               (prevPos[2] - splat<2>(prevBase)) * splat<2>(prevNormal);
+
+		// path goes from the front to the back of the triangle plane
+		T4f crossing = (prevDist >= gSimd4fZero) & (gSimd4fZero > dist);
+		if (!anyTrue(crossing))
+			continue;
+
+		T4f time = prevDist * recip(select(crossing, prevDist - dist, gSimd4fOne));
+
+		// barycentric coordinates of the crossing point
+		T4f edge0 = loadAligned(&tIt->edge0.x);
+		T4f edge1 = loadAligned(&tIt->edge1.x);
+		T4f aux = loadAligned(&tIt->det);
+
+		T4f dx = prevPos[0] + moveX * time - splat<0>(base);
+		T4f dy = prevPos[1] + moveY * time - splat<1>(base);
+		T4f dz = prevPos[2] + moveZ * time - splat<2>(base);
+
+		T4f deltaDotEdge0 = dx * splat<0>(edge0) + dy * splat<1>(edge0) + dz * splat<2>(edge0);
+		T4f deltaDotEdge1 = dx * splat<0>(edge1) + dy * splat<1>(edge1) + dz * splat<2>(edge1);
+
+		T4f edge0DotEdge1 = splat<3>(base);
+		T4f det = splat<0>(aux);
+
+		T4f s = (splat<3>(edge1) * deltaDotEdge0 - edge0DotEdge1 * deltaDotEdge1) * det;
+		T4f t = (splat<3>(edge0) * deltaDotEdge1 - edge0DotEdge1 * deltaDotEdge0) * det;
+
+		T4f inside = (s >= gSimd4fZero) & (t >= gSimd4fZero) & (gSimd4fOne >= s + t);
+		T4f mask = crossing & inside & (hitTime > time);
+
+		hitX = select(mask, nx, hitX);
+		hitY = select(mask, ny, hitY);
+		hitZ = select(mask, nz, hitZ);
+		hitD = select(mask, dist, hitD);
+		hitTime = select(mask, time, hitTime);
+		hit = hit | mask;
+	}
+
+	ImpulseAccumulator closest;
+	collideTriangles(triangles, curPos, closest);
+
+	T4f closestMask = (closest.mNumCollisions > gSimd4fEpsilon) & ~hit;
+	accum.subtract(hitX, hitY, hitZ, hitD, hit);
+	accum.add(closest.mDeltaX, closest.mDeltaY, closest.mDeltaZ, gSimd4fOne, closestMask);
+}
+
+namespace
+{
+
+// cloth space transforms of a signed distance field for one iteration, splatted for SIMD
+template <typename T4f>
+struct SignedDistanceFieldData
+{
+	T4f mToGrid[12];     // cloth space to grid coordinates, 3x4 row major
+	T4f mToCloth[9];     // field space to cloth space rotation, 3x3 row major
+	T4f mToPrevious[12]; // cloth space position of field points at the previous iteration, 3x4 row major
+	T4f mUpper[3];       // largest grid coordinate per axis
+	T4f mCellSize;
+};
+
+// cloth space transforms of a height field for one iteration, splatted for SIMD
+template <typename T4f>
+struct HeightFieldData
+{
+	T4f mToGrid[12];     // cloth space to (x grid coordinate, height, z grid coordinate), 3x4 row major
+	T4f mToCloth[9];     // height field space to cloth space rotation, 3x3 row major
+	T4f mToPrevious[12]; // cloth space position of height field points at the previous iteration, 3x4 row major
+	T4f mUpper[2];       // largest grid coordinate along x and z
+	T4f mGradientScale[2]; // height scale over sample distance along x and z
+	T4f mHeightScale;
+};
+
+PxTransform interpolatePose(const PxTransform& start, const PxTransform& target, float alpha)
+{
+	PxQuat targetRotation = start.q.dot(target.q) < 0.0f ? -target.q : target.q;
+	PxQuat rotation = start.q * (1.0f - alpha) + targetRotation * alpha;
+	return PxTransform(start.p + (target.p - start.p) * alpha, rotation.getNormalized());
+}
+
+// transform from the cloth space position of a shape point to its position at the previous iteration
+template <typename T4f>
+void generateShapeMotion(T4f* toPrevious, const PxTransform& pose, const PxTransform& prevPose)
+{
+	// previous = R' * R^T * (x - p) + p'
+	PxMat33 motion = PxMat33(prevPose.q) * PxMat33(pose.q).getTranspose();
+	PxVec3 offset = prevPose.p - motion * pose.p;
+
+	for (uint32_t i = 0; i < 3; ++i)
+	{
+		for (uint32_t j = 0; j < 3; ++j)
+			toPrevious[i * 4 + j] = simd4f(motion(i, j));
+		toPrevious[i * 4 + 3] = simd4f(offset[i]);
+	}
+}
+
+// movement of the shape at the given positions during this iteration, the velocity used for friction
+template <typename T4f>
+void addShapeVelocity(typename SwCollision<T4f>::ImpulseAccumulator& accum, const T4f* toPrevious,
+                      const T4f* position, const T4f& mask)
+{
+	const T4f* m = toPrevious;
+	T4f velX = position[0] - (m[0] * position[0] + m[1] * position[1] + m[2] * position[2] + m[3]);
+	T4f velY = position[1] - (m[4] * position[0] + m[5] * position[1] + m[6] * position[2] + m[7]);
+	T4f velZ = position[2] - (m[8] * position[0] + m[9] * position[1] + m[10] * position[2] + m[11]);
+	accum.addVelocity(velX, velY, velZ, mask);
+}
+
+template <typename T4f>
+void generateSignedDistanceFieldData(SignedDistanceFieldData<T4f>& data, const SignedDistanceField& field,
+                                     const PxTransform& pose, const PxTransform& prevPose)
+{
+	PxMat33 rotation(pose.q);
+	PxMat33 inverseRotation = rotation.getTranspose();
+	float invCellSize = 1.0f / field.mCellSize;
+
+	// grid = (R^T * (x - p) - lower) / cellSize
+	PxVec3 gridOffset = -(inverseRotation * pose.p + field.mLowerBound) * invCellSize;
+
+	for (uint32_t i = 0; i < 3; ++i)
+	{
+		for (uint32_t j = 0; j < 3; ++j)
+		{
+			data.mToGrid[i * 4 + j] = simd4f(inverseRotation(i, j) * invCellSize);
+			data.mToCloth[i * 3 + j] = simd4f(rotation(i, j));
+		}
+		data.mToGrid[i * 4 + 3] = simd4f(gridOffset[i]);
+		data.mUpper[i] = simd4f(float(field.mDimensions[i] - 1));
+	}
+	generateShapeMotion(data.mToPrevious, pose, prevPose);
+
+	data.mCellSize = simd4f(field.mCellSize);
+}
+
+/**
+    trilinear lookup of 4 particles at once
+    returns the signed distance and writes the normalized cloth space gradient to normal
+    outside receives the distance to the volume bounds, 0 for particles inside the volume
+ */
+template <typename T4f>
+T4f sampleSignedDistanceField(const SignedDistanceField& field, const SignedDistanceFieldData<T4f>& data,
+                              const T4f* __restrict position, T4f* __restrict normal, T4f& outside)
+{
+	typedef typename Simd4fToSimd4i<T4f>::Type T4i;
+
+	const T4f* m = data.mToGrid;
+	T4f base[3], frac[3];
+	outside = gSimd4fZero;
+	for (uint32_t i = 0; i < 3; ++i, m += 4)
+	{
+		T4f grid = m[0] * position[0] + m[1] * position[1] + m[2] * position[2] + m[3];
+		T4f clamped = max(gSimd4fZero, min(grid, data.mUpper[i]));
+		outside = outside + (grid - clamped) * (grid - clamped);
+		base[i] = min(floor(clamped), data.mUpper[i] - gSimd4fOne);
+		frac[i] = clamped - base[i];
+	}
+	outside = sqrt(outside) * data.mCellSize;
+
+	// gather the 8 cell corners, s[z * 4 + y * 2 + x]
+	// combine the cell coordinates in integers, float sums lose precision above 2^24 samples
+	T4i x = truncate(base[0]), y = truncate(base[1]), z = truncate(base[2]);
+	const uint32_t rowStride = field.mDimensions[0];
+	const uint32_t sliceStride = rowStride * field.mDimensions[1];
+	T4f s[8];
+	for (uint32_t k = 0; k < 4; ++k)
+	{
+		uint32_t index = uint32_t(array(x)[k]) + uint32_t(array(y)[k]) * rowStride + uint32_t(array(z)[k]) * sliceStride;
+		const float* __restrict sIt = field.mSamples + index;
+		array(s[0])[k] = sIt[0];
+		array(s[1])[k] = sIt[1];
+		array(s[2])[k] = sIt[rowStride];
+		array(s[3])[k] = sIt[rowStride + 1];
+		sIt += sliceStride;
+		array(s[4])[k] = sIt[0];
+		array(s[5])[k] = sIt[1];
+		array(s[6])[k] = sIt[rowStride];
+		array(s[7])[k] = sIt[rowStride + 1];
+	}
+
+	// interpolate along x, then y, then z
+	T4f dx00 = s[1] - s[0], dx10 = s[3] - s[2], dx01 = s[5] - s[4], dx11 = s[7] - s[6];
+	T4f x00 = s[0] + dx00 * frac[0];
+	T4f x10 = s[2] + dx10 * frac[0];
+	T4f x01 = s[4] + dx01 * frac[0];
+	T4f x11 = s[6] + dx11 * frac[0];
+	T4f dy0 = x10 - x00, dy1 = x11 - x01;
+	T4f y0 = x00 + dy0 * frac[1];
+	T4f y1 = x01 + dy1 * frac[1];
+
+	// analytic gradient of the trilinear interpolation
+	T4f dx0 = dx00 + (dx10 - dx00) * frac[1];
+	T4f dx1 = dx01 + (dx11 - dx01) * frac[1];
+	T4f gradX = dx0 + (dx1 - dx0) * frac[2];
+	T4f gradY = dy0 + (dy1 - dy0) * frac[2];
+	T4f gradZ = y1 - y0;
+
+	const T4f* r = data.mToCloth;
+	normal[0] = r[0] * gradX + r[1] * gradY + r[2] * gradZ;
+	normal[1] = r[3] * gradX + r[4] * gradY + r[5] * gradZ;
+	normal[2] = r[6] * gradX + r[7] * gradY + r[8] * gradZ;
+	T4f rcpLength = rsqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2] + gSimd4fEpsilon);
+	normal[0] = normal[0] * rcpLength;
+	normal[1] = normal[1] * rcpLength;
+	normal[2] = normal[2] * rcpLength;
+
+	return y0 + gradZ * frac[2];
+}
+
+/**
+    conservative advancement from the previous to the current particle positions
+    particles that start outside and hit the surface are projected onto the tangent plane at the entry point,
+    which keeps them on the entry side of thin geometry and preserves their tangential motion
+    returns the mask of moved particles
+ */
+template <typename T4f>
+T4f marchSignedDistanceField(const SignedDistanceField& field, const SignedDistanceFieldData<T4f>& data,
+                             const T4f* __restrict prevPos, T4f* __restrict curPos)
+{
+	const uint32_t kMaxSteps = 8;
+	const T4f restingDistance = data.mCellSize * simd4f(-0.25f);
+
+	T4f delta[3] = { curPos[0] - prevPos[0], curPos[1] - prevPos[1], curPos[2] - prevPos[2] };
+	T4f rcpLength = rsqrt(delta[0] * delta[0] + delta[1] * delta[1] + delta[2] * delta[2] + gSimd4fEpsilon);
+	// step at least half a cell, thinner features are not represented by the field
+	T4f minStep = data.mCellSize * gSimd4fHalf * rcpLength;
+
+	T4f position[4] = { prevPos[0], prevPos[1], prevPos[2], curPos[3] };
+	T4f normal[3], outside;
+	T4f hitNormal[3] = { gSimd4fZero, gSimd4fZero, gSimd4fZero };
+	T4f t = gSimd4fZero;
+	T4f active = gSimd4fOne > t;
+	T4f hit = gSimd4fZero;
+	for (uint32_t step = 0; step < kMaxSteps && anyTrue(active); ++step)
+	{
+		position[0] = prevPos[0] + delta[0] * t;
+		position[1] = prevPos[1] + delta[1] * t;
+		position[2] = prevPos[2] + delta[2] * t;
+
+		// outside of the volume the distance to its bounds is a lower bound
+		T4f distance = sampleSignedDistanceField(field, data, position, normal, outside);
+		distance = select(outside > gSimd4fZero, outside, distance);
+
+		// particles starting inside are left to the discrete collision, resting contacts are not inside
+		T4f inside = gSimd4fZero > distance;
+		if (!step)
+		{
+			inside = restingDistance > distance;
+		}
+		else
+		{
+			T4f entered = active & inside;
+			hitNormal[0] = select(entered, normal[0], hitNormal[0]);
+			hitNormal[1] = select(entered, normal[1], hitNormal[1]);
+			hitNormal[2] = select(entered, normal[2], hitNormal[2]);
+			hit = hit | entered;
+		}
+		active = active & ~inside;
+
+		t = select(active, t + max(distance * rcpLength, minStep), t);
+		active = active & (gSimd4fOne > t);
+	}
+
+	if (!anyTrue(hit))
+		return hit;
+
+	T4f depth = (curPos[0] - position[0]) * hitNormal[0] + (curPos[1] - position[1]) * hitNormal[1] +
+	            (curPos[2] - position[2]) * hitNormal[2];
+	depth = min(depth, gSimd4fZero) & hit;
+
+	curPos[0] = curPos[0] - hitNormal[0] * depth;
+	curPos[1] = curPos[1] - hitNormal[1] * depth;
+	curPos[2] = curPos[2] - hitNormal[2] * depth;
+
+	return hit;
+}
+
+template <typename T4f>
+void generateHeightFieldData(HeightFieldData<T4f>& data, const HeightField& heightField, const PxTransform& pose,
+                             const PxTransform& prevPose)
+{
+	PxMat33 rotation(pose.q);
+	PxMat33 inverseRotation = rotation.getTranspose();
+	PxVec3 invScale(1.0f / heightField.mScale.x, 1.0f, 1.0f / heightField.mScale.z);
+
+	// grid = R^T * (x - p) scaled to samples along x and z
+	PxVec3 gridOffset = -(inverseRotation * pose.p).multiply(invScale);
+
+	for (uint32_t i = 0; i < 3; ++i)
+	{
+		for (uint32_t j = 0; j < 3; ++j)
+		{
+			data.mToGrid[i * 4 + j] = simd4f(inverseRotation(i, j) * invScale[i]);
+			data.mToCloth[i * 3 + j] = simd4f(rotation(i, j));
+		}
+		data.mToGrid[i * 4 + 3] = simd4f(gridOffset[i]);
+	}
+	generateShapeMotion(data.mToPrevious, pose, prevPose);
+
+	data.mUpper[0] = simd4f(float(heightField.mDimensions[0] - 1));
+	data.mUpper[1] = simd4f(float(heightField.mDimensions[1] - 1));
+	data.mGradientScale[0] = simd4f(heightField.mScale.y * invScale.x);
+	data.mGradientScale[1] = simd4f(heightField.mScale.y * invScale.z);
+	data.mHeightScale = simd4f(heightField.mScale.y);
+}
+
+/**
+    bilinear lookup of 4 particles at once
+    returns the penetration depth along the surface normal (positive below the surface)
+    and writes the cloth space surface normal, particles outside of the grid are excluded from mask
+ */
+template <typename T4f>
+T4f sampleHeightField(const HeightField& heightField, const HeightFieldData<T4f>& data, const T4f* __restrict position,
+                      T4f* __restrict normal, T4f& mask)
+{
+	typedef typename Simd4fToSimd4i<T4f>::Type T4i;
+
+	const T4f* m = data.mToGrid;
+	T4f gridX = m[0] * position[0] + m[1] * position[1] + m[2] * position[2] + m[3];
+	T4f height = m[4] * position[0] + m[5] * position[1] + m[6] * position[2] + m[7];
+	T4f gridZ = m[8] * position[0] + m[9] * position[1] + m[10] * position[2] + m[11];
+
+	T4f clampedX = max(gSimd4fZero, min(gridX, data.mUpper[0]));
+	T4f clampedZ = max(gSimd4fZero, min(gridZ, data.mUpper[1]));
+	mask = (gridX == clampedX) & (gridZ == clampedZ);
+
+	T4f baseX = min(floor(clampedX), data.mUpper[0] - gSimd4fOne);
+	T4f baseZ = min(floor(clampedZ), data.mUpper[1] - gSimd4fOne);
+	T4f fracX = clampedX - baseX;
+	T4f fracZ = clampedZ - baseZ;
+
+	// gather the 4 cell corners, h[z * 2 + x]
+	// combine the cell coordinates in integers, float sums lose precision above 2^24 samples
+	T4i x = truncate(baseX), z = truncate(baseZ);
+	const uint32_t rowStride = heightField.mDimensions[0];
+	T4f h[4];
+	for (uint32_t k = 0; k < 4; ++k)
+	{
+		const float* __restrict hIt = heightField.mHeights + uint32_t(array(x)[k]) + uint32_t(array(z)[k]) * rowStride;
+		array(h[0])[k] = hIt[0];
+		array(h[1])[k] = hIt[1];
+		array(h[2])[k] = hIt[rowStride];
+		array(h[3])[k] = hIt[rowStride + 1];
+	}
+
+	T4f dx0 = h[1] - h[0], dx1 = h[3] - h[2];
+	T4f x0 = h[0] + dx0 * fracX;
+	T4f x1 = h[2] + dx1 * fracX;
+	T4f surface = (x0 + (x1 - x0) * fracZ) * data.mHeightScale;
+
+	// local normal (-dh/dx, 1, -dh/dz), rotated to cloth space
+	T4f gradX = (dx0 + (dx1 - dx0) * fracZ) * data.mGradientScale[0];
+	T4f gradZ = (x1 - x0) * data.mGradientScale[1];
+	T4f rcpLength = rsqrt(gradX * gradX + gradZ * gradZ + gSimd4fOne);
+	T4f localX = -gradX * rcpLength;
+	T4f localZ = -gradZ * rcpLength;
+
+	const T4f* r = data.mToCloth;
+	normal[0] = r[0] * localX + r[1] * rcpLength + r[2] * localZ;
+	normal[1] = r[3] * localX + r[4] * rcpLength + r[5] * localZ;
+	normal[2] = r[6] * localX + r[7] * rcpLength + r[8] * localZ;
+
+	// distance to the tangent plane
+	T4f depth = (surface - height) * rcpLength;
+	mask = mask & (depth > gSimd4fZero);
+	return depth;
+}
+
+} // anonymous namespace
+
+// collides virtual particles with a signed distance field, without continuous collision
+template <typename T4f>
+struct cloth::SwCollision<T4f>::SignedDistanceFieldCollider
+{
+	SignedDistanceFieldCollider(const SignedDistanceField& field, const SignedDistanceFieldData<T4f>& data)
+	: mField(field), mData(data)
+	{
+	}
+
+	void operator()(T4f* curPos, const uint16_t*, ImpulseAccumulator& accum) const
+	{
+		T4f normal[3], outside;
+		T4f distance = sampleSignedDistanceField(mField, mData, curPos, normal, outside);
+
+		T4f mask = (gSimd4fZero > distance) & ~(outside > gSimd4fZero);
+		if (!anyTrue(mask))
+			return;
+
+		accum.subtract(normal[0], normal[1], normal[2], distance, mask);
+		addShapeVelocity<T4f>(accum, mData.mToPrevious, curPos, mask);
+	}
+
+	const SignedDistanceField& mField;
+	const SignedDistanceFieldData<T4f>& mData;
+};
+
+template <typename T4f>
+void cloth::SwCollision<T4f>::collideSignedDistanceFields(const IterationState<T4f>& state)
+{
+	if (!mClothData.mNumSignedDistanceFields)
+		return;
+
+	const bool frictionEnabled = mClothData.mFrictionScale > 0.0f;
+	const T4f frictionScale = simd4f(mClothData.mFrictionScale);
+
+	// interpolate poses like the other shapes, the last iteration uses the target poses
+	float alpha = state.mRemainingIterations != 1 ? state.getCurrentAlpha() : 1.0f;
+	float prevAlpha = state.getPreviousAlpha();
+
+	for (uint32_t i = 0; i < mClothData.mNumSignedDistanceFields; ++i)
+	{
+		const SignedDistanceField& field = *mClothData.mSignedDistanceFields[i];
+		const PxTransform& startPose = mClothData.mStartSignedDistanceFieldPoses[i];
+		const PxTransform& targetPose = mClothData.mTargetSignedDistanceFieldPoses[i];
+
+		SignedDistanceFieldData<T4f> data;
+		generateSignedDistanceFieldData(data, field, interpolatePose(startPose, targetPose, alpha),
+		                                interpolatePose(startPose, targetPose, prevAlpha));
+
+		T4f curPos[4], normal[3], outside;
+		T4f prevPos[4] = { gSimd4fZero, gSimd4fZero, gSimd4fZero, gSimd4fZero };
+
+		float* __restrict curIt = mClothData.mCurParticles;
+		float* __restrict curEnd = curIt + mClothData.mNumParticles * 4;
+		float* __restrict prevIt = mClothData.mPrevParticles;
+		for (; curIt < curEnd; curIt += 16, prevIt += 16)
+		{
+			loadParticles(curIt, curPos);
+
+			if (mClothData.mEnableContinuousCollision || frictionEnabled)
+			{
+				loadParticles(prevIt, prevPos);
+			}
+
+			T4f moved = gSimd4fZero;
+			if (mClothData.mEnableContinuousCollision)
+				moved = marchSignedDistanceField(field, data, prevPos, curPos);
+
+			T4f distance = sampleSignedDistanceField(field, data, curPos, normal, outside);
+
+			T4f mask = (gSimd4fZero > distance) & ~(outside > gSimd4fZero);
+			if (anyTrue(mask))
+			{
+				ImpulseAccumulator accum;
+				accum.subtract(normal[0], normal[1], normal[2], distance, mask);
+				T4f invNumCollisions = recip(accum.mNumCollisions);
+
+				if (frictionEnabled)
+				{
+					addShapeVelocity<T4f>(accum, data.mToPrevious, curPos, mask);
+
+					T4f frictionImpulse[3];
+					calculateFrictionImpulse(accum.mDeltaX, accum.mDeltaY, accum.mDeltaZ, accum.mVelX, accum.mVelY,
+					                         accum.mVelZ, curPos, prevPos, invNumCollisions, frictionScale, mask,
+					                         frictionImpulse);
+
+					prevPos[0] = prevPos[0] - frictionImpulse[0];
+					prevPos[1] = prevPos[1] - frictionImpulse[1];
+					prevPos[2] = prevPos[2] - frictionImpulse[2];
+
+					storeParticles(prevIt, prevPos);
+				}
+
+				curPos[0] = curPos[0] + accum.mDeltaX * invNumCollisions;
+				curPos[1] = curPos[1] + accum.mDeltaY * invNumCollisions;
+				curPos[2] = curPos[2] + accum.mDeltaZ * invNumCollisions;
+
+#if PX_PROFILE || PX_DEBUG
+				mNumCollisions += horizontalSum(accum.mNumCollisions);
+#endif
+			}
+			else if (!anyTrue(moved))
+			{
+				continue;
+			}
+
+			storeParticles(curIt, curPos);
+		}
+
+		if (mClothData.mVirtualParticlesBegin != mClothData.mVirtualParticlesEnd)
+			collideVirtualParticles(SignedDistanceFieldCollider(field, data), frictionEnabled);
+	}
+}
+
+// collides virtual particles with a height field
+template <typename T4f>
+struct cloth::SwCollision<T4f>::HeightFieldCollider
+{
+	HeightFieldCollider(const HeightField& heightField, const HeightFieldData<T4f>& data)
+	: mHeightField(heightField), mData(data)
+	{
+	}
+
+	void operator()(T4f* curPos, const uint16_t*, ImpulseAccumulator& accum) const
+	{
+		T4f normal[3], mask;
+		T4f depth = sampleHeightField(mHeightField, mData, curPos, normal, mask);
+		if (!anyTrue(mask))
+			return;
+
+		accum.add(normal[0], normal[1], normal[2], depth, mask);
+		addShapeVelocity<T4f>(accum, mData.mToPrevious, curPos, mask);
+	}
+
+	const HeightField& mHeightField;
+	const HeightFieldData<T4f>& mData;
+};
+
+template <typename T4f>
+void cloth::SwCollision<T4f>::collideHeightFields(const IterationState<T4f>& state)
+{
+	if (!mClothData.mNumHeightFields)
+		return;
+
+	const bool frictionEnabled = mClothData.mFrictionScale > 0.0f;
+	const T4f frictionScale = simd4f(mClothData.mFrictionScale);
+
+	// interpolate poses like the other shapes, the last iteration uses the target poses
+	float alpha = state.mRemainingIterations != 1 ? state.getCurrentAlpha() : 1.0f;
+	float prevAlpha = state.getPreviousAlpha();
+
+	for (uint32_t i = 0; i < mClothData.mNumHeightFields; ++i)
+	{
+		const HeightField& heightField = *mClothData.mHeightFields[i];
+		const PxTransform& startPose = mClothData.mStartHeightFieldPoses[i];
+		const PxTransform& targetPose = mClothData.mTargetHeightFieldPoses[i];
+
+		HeightFieldData<T4f> data;
+		generateHeightFieldData(data, heightField, interpolatePose(startPose, targetPose, alpha),
+		                        interpolatePose(startPose, targetPose, prevAlpha));
+
+		T4f curPos[4], prevPos[4], normal[3], mask;
+
+		float* __restrict curIt = mClothData.mCurParticles;
+		float* __restrict curEnd = curIt + mClothData.mNumParticles * 4;
+		float* __restrict prevIt = mClothData.mPrevParticles;
+		for (; curIt < curEnd; curIt += 16, prevIt += 16)
+		{
+			loadParticles(curIt, curPos);
+
+			T4f depth = sampleHeightField(heightField, data, curPos, normal, mask);
+			if (!anyTrue(mask))
+				continue;
+
+			ImpulseAccumulator accum;
+			accum.add(normal[0], normal[1], normal[2], depth, mask);
+			T4f invNumCollisions = recip(accum.mNumCollisions);
+
+			if (frictionEnabled)
+			{
+				loadParticles(prevIt, prevPos);
+
+				addShapeVelocity<T4f>(accum, data.mToPrevious, curPos, mask);
+
+				T4f frictionImpulse[3];
+				calculateFrictionImpulse(accum.mDeltaX, accum.mDeltaY, accum.mDeltaZ, accum.mVelX, accum.mVelY,
+				                         accum.mVelZ, curPos, prevPos, invNumCollisions, frictionScale, mask,
+				                         frictionImpulse);
+
+				prevPos[0] = prevPos[0] - frictionImpulse[0];
+				prevPos[1] = prevPos[1] - frictionImpulse[1];
+				prevPos[2] = prevPos[2] - frictionImpulse[2];
+
+				storeParticles(prevIt, prevPos);
+			}
+
+			curPos[0] = curPos[0] + accum.mDeltaX * invNumCollisions;
+			curPos[1] = curPos[1] + accum.mDeltaY * invNumCollisions;
+			curPos[2] = curPos[2] + accum.mDeltaZ * invNumCollisions;
+
+			storeParticles(curIt, curPos);
+
+#if PX_PROFILE || PX_DEBUG
+			mNumCollisions += horizontalSum(accum.mNumCollisions);
+#endif
+		}
+
+		if (mClothData.mVirtualParticlesBegin != mClothData.mVirtualParticlesEnd)
+			collideVirtualParticles(HeightFieldCollider(heightField, data), frictionEnabled);
+	}
+}
+
 // explicit template instantiation
 #if NV_SIMD_SIMD
 template class cloth::SwCollision<Simd4f>;
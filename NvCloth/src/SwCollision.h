@@ -32,6 +32,7 @@
 #include <foundation/Px.h>
 #include "StackAllocator.h"
 #include "Simd.h"
+#include "BoundingBox.h"
 
 namespace nv
 {
@@ -40,6 +41,7 @@ namespace cloth
 
 class SwCloth;
 struct SwClothData;
+struct SwCollisionCache;
 template <typename>
 struct IterationState;
 struct IndexPair;
@@ -76,11 +78,34 @@ class SwCollision
 
 	struct ImpulseAccumulator;
 
+	// collide virtual particles with one shape type, see collideVirtualParticles()
+	struct SphereCollider;
+	struct ConvexCollider;
+	struct TriangleCollider;
+	struct SignedDistanceFieldCollider;
+	struct HeightFieldCollider;
+
   public:
+	// collision shape types, the passes of the types not in Shapes are compiled out of collide()
+	enum
+	{
+		eSpheres = 1 << 0, // spheres and capsules
+		eConvexes = 1 << 1,
+		eTriangles = 1 << 2,
+		eFields = 1 << 3, // signed distance and height fields
+		eAllShapes = (1 << 4) - 1
+	};
+
 	SwCollision(SwClothData& clothData, SwKernelAllocator& alloc);
 	~SwCollision();
 
-	void operator()(const IterationState<T4f>& state);
+	template <uint32_t Shapes>
+	void collide(const IterationState<T4f>& state);
+
+	// lets the solver kernel compute the particle bounds in its own particle passes,
+	// returns false if a collision pass moves the particles before the bounds are needed
+	bool fuseBounds();
+	void accumulateBounds(uint32_t first, uint32_t last);
 
 	static size_t estimateTemporaryMemory(const SwCloth& cloth);
 	static size_t estimatePersistentMemory(const SwCloth& cloth);
@@ -90,7 +115,11 @@ class SwCollision
 	void allocate(CollisionData&);
 	void deallocate(const CollisionData&);
 
+	void loadParticles(const float*, T4f*) const;
+	void storeParticles(float*, T4f*) const;
+
 	void computeBounds();
+	void transformBoneSpheres();
 
 	void buildSphereAcceleration(const SphereData*);
 	void buildConeAcceleration();
@@ -102,20 +131,29 @@ class SwCollision
 	ShapeMask getShapeMask(const T4f*, const T4f*) const;
 
 	void collideSpheres(const T4i&, const T4f*, ImpulseAccumulator&) const;
-	T4i collideCones(const T4f*, ImpulseAccumulator&) const;
+	T4i collideCones(const T4f*, const T4i*, ImpulseAccumulator&) const;
 
 	void collideSpheres(const T4i&, const T4f*, T4f*, ImpulseAccumulator&) const;
-	T4i collideCones(const T4f*, T4f*, ImpulseAccumulator&) const;
+	T4i collideCones(const T4f*, T4f*, const T4i*, ImpulseAccumulator&) const;
+
+	void generateParticleMasks();
 
+	void collideSpheres(const IterationState<T4f>&);
 	void collideParticles();
-	void collideVirtualParticles();
+	template <typename ShapeCollider>
+	void collideVirtualParticles(const ShapeCollider&, bool frictionEnabled);
 	void collideContinuousParticles();
 
 	void collideConvexes(const IterationState<T4f>&);
 	void collideConvexes(const T4f*, T4f*, ImpulseAccumulator&);
+	void collideConvexes(const T4f*, const T4f*, const T4f*, T4f*, ImpulseAccumulator&);
 
 	void collideTriangles(const IterationState<T4f>&);
 	void collideTriangles(const TriangleData*, T4f*, ImpulseAccumulator&);
+	void collideTriangles(const TriangleData*, const TriangleData*, const T4f*, T4f*, ImpulseAccumulator&);
+
+	void collideSignedDistanceFields(const IterationState<T4f>&);
+	void collideHeightFields(const IterationState<T4f>&);
 
   public:
 	// acceleration structure
@@ -124,6 +162,19 @@ class SwCollision
 	T4i mConeGrid[6 * sGridSize / 4];
 	T4f mGridScale, mGridBias;
 
+	const T4f* mStartSpheres;
+	const T4f* mTargetSpheres;
+	T4f* mBoneSpheres; // start and target spheres transformed from bone space
+
+	SwCollisionCache* mCache; // null if the spheres move during the frame
+
+	// per particle sphere and cone masks, 4 particles each, null if all particles collide with all shapes
+	T4i* mParticleMasks;
+
+	// particle bounds accumulated by the solver kernel, see fuseBounds()
+	BoundingBox<T4f> mBounds;
+	bool mBoundsFused;
+
 	CollisionData mPrevData;
 	CollisionData mCurData;
 
@@ -135,6 +186,28 @@ class SwCollision
 	static const T4f sSkeletonWidth;
 };
 
+template <typename T4f>
+template <uint32_t Shapes>
+void SwCollision<T4f>::collide(const IterationState<T4f>& state)
+{
+	mNumCollisions = 0;
+
+	if (Shapes & eConvexes)
+		collideConvexes(state); // convex collision, with friction
+	if (Shapes & eTriangles)
+		collideTriangles(state); // triangle collision, with friction
+	if (Shapes & eFields)
+	{
+		collideSignedDistanceFields(state); // signed distance field collision, with friction
+		collideHeightFields(state); // height field collision, with friction
+	}
+
+	computeBounds();
+
+	if (Shapes & eSpheres)
+		collideSpheres(state); // sphere and capsule collision, with friction
+}
+
 //explicit template instantiation declaration
 #if NV_SIMD_SIMD
 extern template class SwCollision<Simd4f>;
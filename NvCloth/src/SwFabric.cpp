@@ -30,13 +30,23 @@
 #include "SwFabric.h"
 #include "SwFactory.h"
 #include "ps/PsSort.h"
-#include "limits.h" // for USHRT_MAX
+#include "limits.h" // for USHRT_MAX, SHRT_MAX
 #include <algorithm>
+#include <cstring> // for memcpy
 #include "../../src/ps/PsUtilities.h"
 
 using namespace nv;
 using namespace physx;
 
+namespace
+{
+// stiffness values are log2(1 - stiffness), with -FLT_MAX_EXP for a stiffness of 1
+bool isRigidStiffness(float value)
+{
+	return value <= -FLT_MAX_EXP;
+}
+}
+
 cloth::SwTether::SwTether(uint16_t anchor, float length) : mAnchor(anchor), mLength(length)
 {
 }
@@ -47,6 +57,8 @@ cloth::SwFabric::SwFabric(SwFactory& factory, uint32_t numParticles, Range<const
                           Range<const uint32_t> triangles, uint32_t id)
 : mFactory(factory)
 , mNumParticles(numParticles)
+, mPackedRecordSize(stiffnessValues.empty() ? 8u : 12u)
+, mQuantized(false)
 , mTetherLengthScale(1.0f), mId(id)
 {
 	// should no longer be prefixed with 0
@@ -119,8 +131,7 @@ cloth::SwFabric::SwFabric(SwFactory& factory, uint32_t numParticles, Range<const
 	// tethers
 	NV_CLOTH_ASSERT(anchors.size() == tetherLengths.size());
 
-	// pad to allow for direct 16 byte (unaligned) loads
-	mTethers.reserve(anchors.size() + 2);
+	mTethers.reserve(anchors.size());
 	for (; !anchors.empty(); anchors.popFront(), tetherLengths.popFront())
 		mTethers.pushBack(SwTether(uint16_t(anchors.front()), tetherLengths.front()));
 
@@ -157,7 +168,7 @@ uint32_t cloth::SwFabric::getNumRestvalues() const
 
 uint32_t cloth::SwFabric::getNumStiffnessValues() const
 {
-	return mStiffnessValues.size()?mOriginalNumRestvalues:0;
+	return (mStiffnessValues.size() || mQuantizedStiffnessValues.size())?mOriginalNumRestvalues:0;
 }
 
 uint32_t cloth::SwFabric::getNumSets() const
@@ -177,7 +188,7 @@ uint32_t cloth::SwFabric::getNumParticles() const
 
 uint32_t cloth::SwFabric::getNumTethers() const
 {
-	return uint32_t(mTethers.size());
+	return uint32_t(mQuantized ? mQuantizedTethers.size() : mTethers.size());
 }
 
 uint32_t cloth::SwFabric::getNumTriangles() const
@@ -187,12 +198,135 @@ uint32_t cloth::SwFabric::getNumTriangles() const
 
 void cloth::SwFabric::scaleRestvalues(float scale)
 {
+	// quantized rest values are relative to the per set scales
+	Vector<float>::Type::Iterator qIt, qEnd = mQuantizationScales.end();
+	for (qIt = mQuantizationScales.begin(); qIt < qEnd; qIt += 2)
+		*qIt *= scale;
+
 	RestvalueContainer::Iterator rIt, rEnd = mRestvalues.end();
 	for (rIt = mRestvalues.begin(); rIt != rEnd; ++rIt)
 		*rIt *= scale;
+
+	// restvalues are the first 4 floats of each packed record
+	float* kEnd = mPackedConstraints.end();
+	for (float* kIt = mPackedConstraints.begin(); kIt != kEnd; kIt += mPackedRecordSize)
+		for (uint32_t i = 0; i < 4; ++i)
+			kIt[i] *= scale;
 }
 
 void cloth::SwFabric::scaleTetherLengths(float scale)
 {
 	mTetherLengthScale *= scale;
 }
+
+bool cloth::SwFabric::quantize()
+{
+	if (mQuantized)
+		return true;
+
+	uint32_t numSets = getNumSets();
+	bool hasStiffness = !mStiffnessValues.empty();
+
+	mQuantizationScales.resize(numSets * 2);
+	mQuantizedRestvalues.resize(mRestvalues.size());
+	mQuantizedStiffnessValues.resize(mStiffnessValues.size());
+
+	for (uint32_t s = 0; s < numSets; ++s)
+	{
+		uint32_t first = mSets[s], last = mSets[s + 1];
+
+		// padding constraints only have to decode to a rest length below epsilon
+		float maxRestvalue = 0.0f, maxStiffness = 0.0f;
+		for (uint32_t i = first; i < last; ++i)
+		{
+			if (std::max(mIndices[i * 2], mIndices[i * 2 + 1]) >= mNumParticles)
+				continue;
+			maxRestvalue = std::max(maxRestvalue, mRestvalues[i]);
+			if (hasStiffness && !isRigidStiffness(mStiffnessValues[i]))
+				maxStiffness = std::max(maxStiffness, PxAbs(mStiffnessValues[i]));
+		}
+
+		float restvalueScale = maxRestvalue / float(USHRT_MAX);
+		float stiffnessScale = maxStiffness / float(SHRT_MAX);
+		mQuantizationScales[s * 2] = restvalueScale;
+		mQuantizationScales[s * 2 + 1] = stiffnessScale;
+
+		float invRestvalueScale = restvalueScale > 0.0f ? 1.0f / restvalueScale : 0.0f;
+		float invStiffnessScale = stiffnessScale > 0.0f ? 1.0f / stiffnessScale : 0.0f;
+		for (uint32_t i = first; i < last; ++i)
+		{
+			// negative rest values solve like zero ones
+			float restvalue = PxClamp(mRestvalues[i] * invRestvalueScale, 0.0f, float(USHRT_MAX));
+			mQuantizedRestvalues[i] = uint16_t(restvalue + 0.5f);
+			if (hasStiffness && isRigidStiffness(mStiffnessValues[i]))
+			{
+				mQuantizedStiffnessValues[i] = sQuantizedRigidStiffness;
+			}
+			else if (hasStiffness)
+			{
+				float stiffness = PxClamp(mStiffnessValues[i] * invStiffnessScale, -float(SHRT_MAX), float(SHRT_MAX));
+				mQuantizedStiffnessValues[i] = int16_t(PxFloor(stiffness + 0.5f));
+			}
+		}
+	}
+
+	// tether lengths share one scale, folded into mTetherLengthScale
+	float maxTetherLength = 0.0f;
+	for (uint32_t i = 0; i < mTethers.size(); ++i)
+		maxTetherLength = std::max(maxTetherLength, mTethers[i].mLength);
+	float tetherLengthScale = maxTetherLength / float(USHRT_MAX);
+	float invTetherLengthScale = tetherLengthScale > 0.0f ? 1.0f / tetherLengthScale : 0.0f;
+
+	mQuantizedTethers.resize(mTethers.size());
+	for (uint32_t i = 0; i < mTethers.size(); ++i)
+	{
+		float length = PxClamp(mTethers[i].mLength * invTetherLengthScale, 0.0f, float(USHRT_MAX));
+		mQuantizedTethers[i].mAnchor = mTethers[i].mAnchor;
+		mQuantizedTethers[i].mLength = uint16_t(length + 0.5f);
+	}
+	mTetherLengthScale *= tetherLengthScale;
+
+	// release the float data
+	RestvalueContainer().swap(mRestvalues);
+	RestvalueContainer().swap(mStiffnessValues);
+	RestvalueContainer().swap(mPackedConstraints);
+	Vector<SwTether>::Type().swap(mTethers);
+
+	mQuantized = true;
+	return true;
+}
+
+bool cloth::SwFabric::isQuantized() const
+{
+	return mQuantized;
+}
+
+// interleave batches of 4 constraints so the solver reads one stream per set
+bool cloth::SwFabric::packConstraints()
+{
+	// only float rest values are packed
+	if (mQuantized)
+		return false;
+
+	uint32_t numRecords = uint32_t(mRestvalues.size()) / 4;
+	mPackedConstraints.resize(numRecords * mPackedRecordSize);
+	for (uint32_t i = 0; i < numRecords; ++i)
+	{
+		float* record = mPackedConstraints.begin() + i * mPackedRecordSize;
+		memcpy(record, mRestvalues.begin() + i * 4, 4 * sizeof(float));
+		memcpy(record + 4, mIndices.begin() + i * 8, 8 * sizeof(uint16_t));
+		if (!mStiffnessValues.empty())
+			memcpy(record + 8, mStiffnessValues.begin() + i * 4, 4 * sizeof(float));
+	}
+	return true;
+}
+
+bool cloth::SwFabric::hasPackedConstraints() const
+{
+	return !mPackedConstraints.empty();
+}
+
+uint32_t cloth::SwFabric::getNumPaddedRestvalues() const
+{
+	return mSets.back();
+}
@@ -31,6 +31,7 @@
 
 #include "NvCloth/Fabric.h"
 #include "NvCloth/Range.h"
+#include "limits.h" // for SHRT_MIN
 
 namespace nv
 {
@@ -47,6 +48,12 @@ struct SwTether
 	float mLength;
 };
 
+struct SwQuantizedTether
+{
+	uint16_t mAnchor;
+	uint16_t mLength; // in units of the fabric's tether length scale
+};
+
 class SwFabric : public Fabric
 {
   public:
@@ -82,6 +89,14 @@ class SwFabric : public Fabric
 	virtual void scaleRestvalues(float);
 	virtual void scaleTetherLengths(float);
 
+	virtual bool quantize();
+	virtual bool isQuantized() const;
+
+	virtual bool packConstraints();
+	virtual bool hasPackedConstraints() const;
+
+	uint32_t getNumPaddedRestvalues() const;
+
   public:
 	SwFactory& mFactory;
 
@@ -94,7 +109,22 @@ class SwFabric : public Fabric
 	RestvalueContainer mStiffnessValues;  // constraint stiffnesses, uses phase config if empty
 	Vector<uint16_t>::Type mIndices; // particle index pairs
 
+	// the above interleaved per batch of 4 constraints into records of 4 restvalues, 8 indices
+	// and 4 optional stiffness values, empty unless packConstraints() has been called
+	RestvalueContainer mPackedConstraints;
+	uint32_t mPackedRecordSize; // in floats
+
+	// 16 bit encoding of the above after quantize(), the float containers are empty then
+	Vector<uint16_t>::Type mQuantizedRestvalues; // in units of the set's rest value scale
+	Vector<int16_t>::Type mQuantizedStiffnessValues; // in units of the set's stiffness scale, or sQuantizedRigidStiffness
+	Vector<float>::Type mQuantizationScales; // (rest value, stiffness) scale per set
+	bool mQuantized;
+
+	// stiffness code of rigid constraints, log2(1 - 1) doesn't fit into any stiffness scale
+	static const int16_t sQuantizedRigidStiffness = SHRT_MIN;
+
 	Vector<SwTether>::Type mTethers;
+	Vector<SwQuantizedTether>::Type mQuantizedTethers; // replaces mTethers after quantize()
 	float mTetherLengthScale;
 
 	Vector<uint16_t>::Type mTriangles;
@@ -68,6 +68,43 @@ cloth::Cloth* cloth::SwFactory::createCloth(Range<const PxVec4> particles, Fabri
 	return NV_CLOTH_NEW(SwCloth)(*this, static_cast<SwFabric&>(fabric), particles);
 }
 
+void cloth::SwFactory::createCloths(Range<Cloth*> cloths, Range<const PxVec4> particles, Fabric& fabric)
+{
+	SwFabric& swFabric = static_cast<SwFabric&>(fabric);
+	uint32_t numCloths = cloths.size();
+	uint32_t numParticles = swFabric.getNumParticles();
+
+	NV_CLOTH_ASSERT(particles.size() == numCloths * numParticles);
+
+	if (!numCloths)
+		return;
+
+	// block header, followed by all instances (each preceded by the block pointer), followed by their particles
+	const size_t headerSize = SwCloth::sAllocationHeaderSize;
+	const size_t instanceSize = (headerSize + sizeof(SwCloth) + 15) & ~size_t(15);
+	const uint32_t capacity = SwCloth::getParticleCapacity(numParticles);
+	size_t size = headerSize + numCloths * (instanceSize + 2 * capacity * sizeof(PxVec4));
+
+	char* memory = reinterpret_cast<char*>(NV_CLOTH_ALLOC(size, "SwClothBlock"));
+	SwClothBlock* block = reinterpret_cast<SwClothBlock*>(memory);
+	block->mRefCount = int32_t(numCloths);
+
+	char* instanceIt = memory + headerSize;
+	PxVec4* particleIt = reinterpret_cast<PxVec4*>(instanceIt + numCloths * instanceSize);
+	for (uint32_t i = 0; i < numCloths; ++i, instanceIt += instanceSize, particleIt += 2 * capacity)
+	{
+		*reinterpret_cast<SwClothBlock**>(instanceIt) = block;
+		Range<const PxVec4> clothParticles(particles.begin() + i * numParticles, particles.begin() + (i + 1) * numParticles);
+		cloths[i] = ::new (instanceIt + headerSize) SwCloth(*this, swFabric, clothParticles, particleIt);
+	}
+}
+
+void cloth::SwFactory::destroyCloths(Range<Cloth* const> cloths)
+{
+	for (; !cloths.empty(); cloths.popFront())
+		NV_CLOTH_DELETE(cloths.front());
+}
+
 cloth::Solver* cloth::SwFactory::createSolver()
 {
 	return NV_CLOTH_NEW(SwSolver)();
@@ -99,11 +136,7 @@ void cloth::SwFactory::extractFabricData(const Fabric& fabric, Range<uint32_t> p
 	for (uint32_t i = 0; !phaseIndices.empty(); ++i, phaseIndices.popFront())
 		phaseIndices.front() = swFabric.mPhases[i];
 
-	typedef SwFabric::RestvalueContainer::ConstIterator RestvalueIterator;
-	
-	Vector<uint32_t>::Type::ConstIterator sEnd = swFabric.mSets.end(), sIt;
-	RestvalueIterator rBegin = swFabric.mRestvalues.begin(), rIt = rBegin;
-	RestvalueIterator stIt = swFabric.mStiffnessValues.begin();
+	Vector<uint32_t>::Type::ConstIterator sBegin = swFabric.mSets.begin(), sEnd = swFabric.mSets.end(), sIt;
 	Vector<uint16_t>::Type::ConstIterator iIt = swFabric.mIndices.begin();
 
 	uint32_t* sDst = sets.begin();
@@ -111,11 +144,13 @@ void cloth::SwFactory::extractFabricData(const Fabric& fabric, Range<uint32_t> p
 	float* stDst = stiffnessValues.begin();
 	uint32_t* iDst = indices.begin();
 
-	uint32_t numConstraints = 0;
-	for (sIt = swFabric.mSets.begin(); ++sIt != sEnd;)
+	uint32_t numConstraints = 0, c = 0;
+	for (sIt = sBegin; ++sIt != sEnd;)
 	{
-		RestvalueIterator rEnd = rBegin + *sIt;
-		for (; rIt != rEnd; ++rIt, ++stIt)
+		// quantized fabrics store rest values and stiffness relative to the scales of the set
+		const float* scales = swFabric.mQuantized ? &swFabric.mQuantizationScales[uint32_t(sIt - sBegin - 1) * 2] : nullptr;
+
+		for (; c != *sIt; ++c)
 		{
 			uint16_t i0 = *iIt++;
 			uint16_t i1 = *iIt++;
@@ -124,9 +159,16 @@ void cloth::SwFactory::extractFabricData(const Fabric& fabric, Range<uint32_t> p
 				continue;
 
 			if (!restvalues.empty())
-				*rDst++ = *rIt;
+				*rDst++ = scales ? swFabric.mQuantizedRestvalues[c] * scales[0] : swFabric.mRestvalues[c];
 			if (!stiffnessValues.empty())
-				*stDst++ = *stIt;
+			{
+				if (!scales)
+					*stDst++ = swFabric.mStiffnessValues[c];
+				else if (swFabric.mQuantizedStiffnessValues[c] == SwFabric::sQuantizedRigidStiffness)
+					*stDst++ = -FLT_MAX_EXP;
+				else
+					*stDst++ = swFabric.mQuantizedStiffnessValues[c] * scales[1];
+			}
 
 			if (!indices.empty())
 			{
@@ -142,10 +184,13 @@ void cloth::SwFactory::extractFabricData(const Fabric& fabric, Range<uint32_t> p
 	}
 
 	for (uint32_t i = 0; !anchors.empty(); ++i, anchors.popFront())
-		anchors.front() = swFabric.mTethers[i].mAnchor;
+		anchors.front() = swFabric.mQuantized ? swFabric.mQuantizedTethers[i].mAnchor : swFabric.mTethers[i].mAnchor;
 
 	for (uint32_t i = 0; !tetherLengths.empty(); ++i, tetherLengths.popFront())
-		tetherLengths.front() = swFabric.mTethers[i].mLength * swFabric.mTetherLengthScale;
+	{
+		float length = swFabric.mQuantized ? float(swFabric.mQuantizedTethers[i].mLength) : swFabric.mTethers[i].mLength;
+		tetherLengths.front() = length * swFabric.mTetherLengthScale;
+	}
 
 	for (uint32_t i = 0; !triangles.empty(); ++i, triangles.popFront())
 		triangles.front() = swFabric.mTriangles[i];
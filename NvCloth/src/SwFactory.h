@@ -62,6 +62,10 @@ class SwFactory : public Factory
 
 	virtual Cloth* createCloth(Range<const physx::PxVec4> particles, Fabric& fabric);
 
+	virtual void createCloths(Range<Cloth*> cloths, Range<const physx::PxVec4> particles, Fabric& fabric);
+
+	virtual void destroyCloths(Range<Cloth* const> cloths);
+
 	virtual Solver* createSolver();
 
 	virtual Cloth* clone(const Cloth& cloth);
@@ -52,7 +52,7 @@ struct SwInterCollisionData
 	SwInterCollisionData()
 	{
 	}
-	SwInterCollisionData(physx::PxVec4* particles, physx::PxVec4* prevParticles, uint32_t numParticles, uint32_t* indices,
+	SwInterCollisionData(physx::PxVec4* particles, physx::PxVec4* prevParticles, uint32_t numParticles, const uint32_t* indices,
 	                     const physx::PxTransform& globalPose, const physx::PxVec3& boundsCenter, const physx::PxVec3& boundsHalfExtents,
 	                     float impulseScale, void* userData)
 	: mParticles(particles)
@@ -70,7 +70,7 @@ struct SwInterCollisionData
 	physx::PxVec4* mParticles;
 	physx::PxVec4* mPrevParticles;
 	uint32_t mNumParticles;
-	uint32_t* mIndices;
+	const uint32_t* mIndices;
 	physx::PxTransform mGlobalPose;
 	physx::PxVec3 mBoundsCenter;
 	physx::PxVec3 mBoundsHalfExtent;
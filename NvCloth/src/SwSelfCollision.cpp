@@ -339,8 +339,8 @@ void cloth::SwSelfCollision<T4f>::collideParticles(const uint32_t* keys, uint16_
 	//collisionDistance is the number of buckets along the sweep axis we need to search after the current one
 
 	T4f* __restrict particles = reinterpret_cast<T4f*>(mClothData.mCurParticles);
-	T4f* __restrict restParticles =
-	    useRestParticles ? reinterpret_cast<T4f*>(mClothData.mRestPositions) : particles;
+	const T4f* __restrict restParticles =
+	    useRestParticles ? reinterpret_cast<const T4f*>(mClothData.mRestPositions) : particles;
 
 	//16 lsb's are for the bucket
 	const uint32_t bucketMask = 0x0000ffff;
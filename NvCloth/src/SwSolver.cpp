@@ -36,8 +36,11 @@
 #include "SwClothData.h"
 #include "SwSolverKernel.h"
 #include "SwInterCollision.h"
+#include "HalfFloat.h"
 #include "ps/PsFPU.h"
 #include "ps/PsSort.h"
+#include "NvCloth/ps/PsAtomic.h"
+#include <chrono>
 
 using namespace physx;
 
@@ -64,6 +67,7 @@ cloth::SwSolver::SwSolver()
 , mInterCollisionFilter(nullptr)
 , mInterCollisionScratchMem(nullptr)
 , mInterCollisionScratchMemSize(0)
+, mFrameTimeBudget(0.0f)
 , mSimulateProfileEventData(nullptr)
 {
 }
@@ -73,6 +77,10 @@ cloth::SwSolver::~SwSolver()
 	if (mInterCollisionScratchMem)
 		NV_CLOTH_FREE(mInterCollisionScratchMem);
 
+	for (uint32_t i = 0; i < mPrevParticleBuffers.size(); ++i)
+		if (mPrevParticleBuffers[i].mMemory)
+			NV_CLOTH_FREE(mPrevParticleBuffers[i].mMemory);
+
 	NV_CLOTH_ASSERT(mSimulatedCloths.empty());
 }
 
@@ -84,6 +92,49 @@ bool clothSizeGreater(const T& t0, const T& t1)
 	return t0.mCloth->mCurParticles.size() > t1.mCloth->mCurParticles.size();
 }
 
+bool budgetWeightLess(const BudgetAllocation* a0, const BudgetAllocation* a1)
+{
+	return a0->mWeight < a1->mWeight;
+}
+
+// advance particles along their last iteration velocity, used for frames skipped by the level of detail
+void extrapolateParticles(SwCloth& cloth, float dt)
+{
+	PxVec4* curIt = cloth.mCurParticles.begin();
+	PxVec4* curEnd = cloth.mCurParticles.end();
+	PxVec4* prevIt = cloth.mPrevParticles.begin();
+
+	float scale = dt / cloth.mPrevIterDt;
+	PxVec3 lower(FLT_MAX), upper(-FLT_MAX);
+	if (cloth.mPrevParticles.empty())
+	{
+		// compressed history, the offsets from the current to the previous particles don't change
+		const SwCompressedParticle* cIt = cloth.mCompressedPrevParticles.begin();
+		for (; curIt != curEnd; ++curIt, ++cIt)
+		{
+			PxVec4 offset(halfToFloat(cIt->mOffset[0]), halfToFloat(cIt->mOffset[1]), halfToFloat(cIt->mOffset[2]), 0.0f);
+			*curIt -= offset * scale;
+			lower = lower.minimum(curIt->getXYZ());
+			upper = upper.maximum(curIt->getXYZ());
+		}
+	}
+	for (; curIt != curEnd; ++curIt, ++prevIt)
+	{
+		PxVec4 delta = (*curIt - *prevIt) * scale;
+		delta.w = 0.0f;
+		*curIt += delta;
+		*prevIt += delta;
+		lower = lower.minimum(curIt->getXYZ());
+		upper = upper.maximum(curIt->getXYZ());
+	}
+
+	if (!cloth.mCurParticles.empty())
+	{
+		float bounds[6] = { lower.x, lower.y, lower.z, upper.x, upper.y, upper.z };
+		cloth.setParticleBounds(bounds);
+	}
+}
+
 template <typename T>
 void sortTasks(ps::Array<T, nv::cloth::ps::NonTrackingAllocator>& tasks)
 {
@@ -137,6 +188,25 @@ void cloth::SwSolver::removeCloth(Cloth* cloth)
 	}
 }
 
+void cloth::SwSolver::setClothBudgetWeight(Cloth* cloth, float weight)
+{
+	for (uint32_t i = 0; i < mSimulatedCloths.size(); ++i)
+	{
+		if (mSimulatedCloths[i].mCloth == cloth)
+			mSimulatedCloths[i].mBudgetWeight = weight;
+	}
+}
+
+float cloth::SwSolver::getClothBudgetWeight(const Cloth* cloth) const
+{
+	for (uint32_t i = 0; i < mSimulatedCloths.size(); ++i)
+	{
+		if (mSimulatedCloths[i].mCloth == cloth)
+			return mSimulatedCloths[i].mBudgetWeight;
+	}
+	return 1.0f;
+}
+
 int cloth::SwSolver::getNumCloths() const
 {
 	return mCloths.size();
@@ -157,6 +227,13 @@ bool cloth::SwSolver::beginSimulation(float dt)
 	mCurrentDt = dt;
 	beginFrame();
 
+	// at most one previous particle buffer per concurrently simulated cloth
+	PrevParticleBuffer buffer = { nullptr, 0, 0 };
+	while (mPrevParticleBuffers.size() < mSimulatedCloths.size())
+		mPrevParticleBuffers.pushBack(buffer);
+
+	allocateBudget();
+
 	return true;
 }
 void cloth::SwSolver::simulateChunk(int idx)
@@ -169,9 +246,42 @@ void cloth::SwSolver::endSimulation()
 {
 	NV_CLOTH_ASSERT(!mSimulatedCloths.empty());
 	interCollision();
+
+	// inter-collision needs the full previous particles, compress them afterwards
+	for (uint32_t i = 0; i < mSimulatedCloths.size(); ++i)
+		mSimulatedCloths[i].compressPrevParticles();
 	endFrame();
 }
 
+// called concurrently by the simulating cloths, takes the first free buffer and grows it if needed
+int32_t cloth::SwSolver::acquirePrevParticleBuffer(uint32_t capacity)
+{
+	for (uint32_t i = 0; i < mPrevParticleBuffers.size(); ++i)
+	{
+		PrevParticleBuffer& buffer = mPrevParticleBuffers[i];
+		if (ps::atomicCompareExchange(&buffer.mInUse, 1, 0))
+			continue;
+
+		if (buffer.mCapacity < capacity)
+		{
+			if (buffer.mMemory)
+				NV_CLOTH_FREE(buffer.mMemory);
+			buffer.mMemory = reinterpret_cast<PxVec4*>(
+			    NV_CLOTH_ALLOC(capacity * sizeof(PxVec4), "cloth::SwSolver::mPrevParticleBuffers"));
+			buffer.mCapacity = capacity;
+		}
+		return int32_t(i);
+	}
+
+	NV_CLOTH_ASSERT(false); // beginSimulation() allocates one per cloth
+	return -1;
+}
+
+void cloth::SwSolver::releasePrevParticleBuffer(int32_t index)
+{
+	ps::atomicExchange(&mPrevParticleBuffers[uint32_t(index)].mInUse, 0);
+}
+
 int cloth::SwSolver::getSimulationChunkCount() const
 {
 	return static_cast<int>(mSimulatedCloths.size());
@@ -226,6 +336,72 @@ void cloth::SwSolver::interCollision()
 	collider();
 }
 
+// distribute solver iterations so that the estimated cost of the frame fits mFrameTimeBudget
+void cloth::SwSolver::allocateBudget()
+{
+	mBudgetAllocations.resize(0);
+	for (uint32_t i = 0; i < mSimulatedCloths.size(); ++i)
+		mSimulatedCloths[i].mMaxIterations = INT_MAX;
+
+	if (mFrameTimeBudget <= 0.0f || mCurrentDt == 0.0f)
+		return;
+
+	// cloths that haven't been simulated yet are estimated from the average cost per particle
+	float measuredCost = 0.0f;
+	uint32_t measuredParticles = 0;
+	for (uint32_t i = 0; i < mSimulatedCloths.size(); ++i)
+	{
+		if (mSimulatedCloths[i].mCostPerIteration > 0.0f)
+		{
+			measuredCost += mSimulatedCloths[i].mCostPerIteration;
+			measuredParticles += mSimulatedCloths[i].mCloth->mCurParticles.size();
+		}
+	}
+	float costPerParticle = measuredParticles ? measuredCost / measuredParticles : 0.0f;
+
+	float totalCost = 0.0f;
+	mBudgetAllocations.resize(mSimulatedCloths.size());
+	for (uint32_t i = 0; i < mSimulatedCloths.size(); ++i)
+	{
+		const SimulatedCloth& simulatedCloth = mSimulatedCloths[i];
+		BudgetAllocation& allocation = mBudgetAllocations[i];
+		allocation.mCloth = simulatedCloth.mCloth;
+		allocation.mWeight = simulatedCloth.mBudgetWeight;
+		allocation.mCostPerIteration = simulatedCloth.mCostPerIteration > 0.0f
+		                                   ? simulatedCloth.mCostPerIteration
+		                                   : costPerParticle * simulatedCloth.mCloth->mCurParticles.size();
+		allocation.mRequestedIterations = simulatedCloth.getRequestedIterations();
+		allocation.mNumIterations = allocation.mRequestedIterations;
+		totalCost += allocation.mCostPerIteration * allocation.mRequestedIterations;
+	}
+
+	float excess = totalCost - mFrameTimeBudget;
+	if (excess > 0.0f)
+	{
+		// degrade cloths with the lowest weight first, down to one iteration
+		Vector<BudgetAllocation*>::Type order;
+		order.reserve(mBudgetAllocations.size());
+		for (uint32_t i = 0; i < mBudgetAllocations.size(); ++i)
+			order.pushBack(&mBudgetAllocations[i]);
+		ps::sort(order.begin(), order.size(), &budgetWeightLess, ps::NonTrackingAllocator());
+
+		for (uint32_t i = 0; i < order.size() && excess > 0.0f; ++i)
+		{
+			BudgetAllocation& allocation = *order[i];
+			if (allocation.mRequestedIterations <= 1 || allocation.mCostPerIteration <= 0.0f)
+				continue;
+
+			uint32_t reduction = std::min(allocation.mRequestedIterations - 1,
+			                              uint32_t(PxCeil(excess / allocation.mCostPerIteration)));
+			allocation.mNumIterations -= reduction;
+			excess -= reduction * allocation.mCostPerIteration;
+		}
+	}
+
+	for (uint32_t i = 0; i < mSimulatedCloths.size(); ++i)
+		mSimulatedCloths[i].mMaxIterations = mBudgetAllocations[i].mNumIterations;
+}
+
 void cloth::SwSolver::addClothAppend(Cloth* cloth)
 {
 	SwCloth& swCloth = *static_cast<SwCloth*>(cloth);
@@ -247,13 +423,50 @@ void cloth::SwSolver::endFrame() const
 }
 
 cloth::SwSolver::SimulatedCloth::SimulatedCloth(SwCloth& cloth, SwSolver* parent)
-	: mCloth(&cloth), mScratchMemorySize(0), mScratchMemory(0), mInvNumIterations(0.0f), mParent(parent)
+	: mCloth(&cloth), mScratchMemorySize(0), mScratchMemory(0), mInvNumIterations(0.0f)
+	, mBudgetWeight(1.0f), mCostPerIteration(0.0f), mMaxIterations(INT_MAX), mPrevParticleBuffer(-1)
+	, mParent(parent)
 {
 
 }
 
+bool cloth::SwSolver::SimulatedCloth::isLodFrameSkipped() const
+{
+	return mCloth->mPrevIterDt > 0.0f && mCloth->mLodSkippedFrames + 1 < mCloth->getLodFrameInterval();
+}
+
+// number of iterations the solver frequency asks for this frame, matches IterationStateFactory
+uint32_t cloth::SwSolver::SimulatedCloth::getRequestedIterations() const
+{
+	if (isLodFrameSkipped())
+		return 0;
+
+	float dt = mParent->mCurrentDt + mCloth->mLodSkippedDt;
+	return uint32_t(std::max(1, int(dt * mCloth->getEffectiveSolverFrequency() + 0.5f)));
+}
+
+// compresses the history and returns the borrowed buffer, if any
+void cloth::SwSolver::SimulatedCloth::compressPrevParticles()
+{
+	mCloth->compressPrevParticles();
+	if (mPrevParticleBuffer < 0)
+		return;
+
+	NV_CLOTH_ASSERT(mCloth->mPrevParticles.empty());
+	mParent->releasePrevParticleBuffer(mPrevParticleBuffer);
+	mPrevParticleBuffer = -1;
+}
+
 void cloth::SwSolver::SimulatedCloth::Destroy()
 {
+	if (!mParent->mInterCollisionIterations || mParent->mInterCollisionDistance == 0.0f)
+		compressPrevParticles();
+
+	// frames skipped by the level of detail keep the start state, new inputs only replace the targets,
+	// so the frame that catches up interpolates over the whole skipped interval
+	if (mCloth->mLodSkippedFrames)
+		return;
+
 	mCloth->mMotionConstraints.pop();
 	mCloth->mSeparationConstraints.pop();
 
@@ -274,6 +487,24 @@ void cloth::SwSolver::SimulatedCloth::Destroy()
 		swap(mCloth->mStartCollisionTriangles, mCloth->mTargetCollisionTriangles);
 		mCloth->mTargetCollisionTriangles.resize(0);
 	}
+
+	if (!mCloth->mTargetSignedDistanceFieldPoses.empty())
+	{
+		swap(mCloth->mStartSignedDistanceFieldPoses, mCloth->mTargetSignedDistanceFieldPoses);
+		mCloth->mTargetSignedDistanceFieldPoses.resize(0);
+	}
+
+	if (!mCloth->mTargetHeightFieldPoses.empty())
+	{
+		swap(mCloth->mStartHeightFieldPoses, mCloth->mTargetHeightFieldPoses);
+		mCloth->mTargetHeightFieldPoses.resize(0);
+	}
+
+	if (!mCloth->mTargetBoneTransforms.empty())
+	{
+		swap(mCloth->mStartBoneTransforms, mCloth->mTargetBoneTransforms);
+		mCloth->mTargetBoneTransforms.resize(0);
+	}
 }
 void cloth::SwSolver::SimulatedCloth::Simulate()
 {
@@ -292,12 +523,54 @@ void cloth::SwSolver::SimulatedCloth::Simulate()
 	if (mParent->mCurrentDt == 0.0f)
 		return;
 
-	IterationStateFactory factory(*mCloth, mParent->mCurrentDt);
+	float dt = mParent->mCurrentDt;
+
+	// level of detail: only simulate every nth frame and extrapolate in between
+	if (isLodFrameSkipped())
+	{
+		++mCloth->mLodSkippedFrames;
+		mCloth->mLodSkippedDt += dt;
+		extrapolateParticles(*mCloth, dt);
+		return;
+	}
+
+	if (mCloth->mLodSkippedFrames)
+	{
+		// rewind the extrapolation and simulate the skipped frames in one step,
+		// the frame velocity then matches the accumulated motion and doesn't pop
+		extrapolateParticles(*mCloth, -mCloth->mLodSkippedDt);
+		dt += mCloth->mLodSkippedDt;
+		mCloth->mLodSkippedFrames = 0;
+		mCloth->mLodSkippedDt = 0.0f;
+	}
+
+	std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+
+	IterationStateFactory factory(*mCloth, dt, int(std::min(mMaxIterations, uint32_t(INT_MAX))));
 	mInvNumIterations = factory.mInvNumIterations;
 
 	ps::SIMDGuard simdGuard;
 
+	// compressed history is expanded by the first integration of the frame,
+	// into a buffer shared with the other cloths unless the cloth has block memory for it
+	bool compressed = mCloth->mPrevParticles.empty();
+	if (compressed)
+	{
+		PxVec4* memory = nullptr;
+		if (!mCloth->mPrevParticleMemory)
+		{
+			mPrevParticleBuffer = mParent->acquirePrevParticleBuffer(mCloth->mCurParticles.capacity());
+			memory = mParent->mPrevParticleBuffers[mPrevParticleBuffer].mMemory;
+		}
+		mCloth->allocatePrevParticles(memory);
+	}
+
 	SwClothData data(*mCloth, mCloth->mFabric);
+	if (compressed)
+	{
+		data.mCompressedPrevParticles = mCloth->mCompressedPrevParticles.begin();
+		data.mPrevInvMasses = mCloth->mPrevInvMasses.begin();
+	}
 	SwKernelAllocator allocator(mScratchMemory, uint32_t(mScratchMemorySize));
 
 	// construct kernel functor and execute
@@ -312,4 +585,9 @@ void cloth::SwSolver::SimulatedCloth::Simulate()
 #endif
 
 	data.reconcile(*mCloth); // update cloth
+
+	// measure cost for the frame time budget
+	float cost = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count() *
+	             factory.mInvNumIterations;
+	mCostPerIteration = mCostPerIteration > 0.0f ? mCostPerIteration + (cost - mCostPerIteration) * 0.25f : cost;
 }
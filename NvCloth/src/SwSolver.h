@@ -49,16 +49,36 @@ class SwSolver : public Solver
 		SimulatedCloth(SwCloth& cloth, SwSolver* parent);
 		void Destroy();
 		void Simulate();
+		void compressPrevParticles();
+
+		bool isLodFrameSkipped() const;
+		uint32_t getRequestedIterations() const;
 
 		SwCloth* mCloth;
 		uint32_t mScratchMemorySize;
 		void* mScratchMemory;
 		float mInvNumIterations;
 
+		// frame time budget
+		float mBudgetWeight;
+		float mCostPerIteration; // smoothed measured time per iteration in milliseconds, 0 if not measured yet
+		uint32_t mMaxIterations; // iterations allocated for the current frame
+
+		int32_t mPrevParticleBuffer; // borrowed from mParent while the history is expanded, -1 otherwise
+
 		SwSolver* mParent;
 	};
 	friend struct SimulatedCloth;
 
+	// full precision previous particles of compressed cloths during simulation,
+	// shared so that only the cloths simulating at the same time need one
+	struct PrevParticleBuffer
+	{
+		physx::PxVec4* mMemory;
+		uint32_t mCapacity;
+		volatile int32_t mInUse;
+	};
+
   public:
 	SwSolver();
 	virtual ~SwSolver() override;
@@ -107,6 +127,23 @@ class SwSolver : public Solver
 		mInterCollisionFilter = filter;
 	}
 
+	virtual void setFrameTimeBudget(float milliseconds) override
+	{
+		mFrameTimeBudget = milliseconds;
+	}
+	virtual float getFrameTimeBudget() const override
+	{
+		return mFrameTimeBudget;
+	}
+
+	virtual void setClothBudgetWeight(Cloth* cloth, float weight) override;
+	virtual float getClothBudgetWeight(const Cloth* cloth) const override;
+
+	virtual Range<const BudgetAllocation> getBudgetAllocations() const override
+	{
+		return Range<const BudgetAllocation>(mBudgetAllocations.begin(), mBudgetAllocations.end());
+	}
+
 	virtual bool hasError() const override
 	{
 		return false;
@@ -122,6 +159,11 @@ class SwSolver : public Solver
 
 	void interCollision();
 
+	void allocateBudget();
+
+	int32_t acquirePrevParticleBuffer(uint32_t capacity);
+	void releasePrevParticleBuffer(int32_t index);
+
   private:
 	Vector<SimulatedCloth>::Type mSimulatedCloths;
 	typedef Vector<SwCloth*>::Type ClothVector;
@@ -139,6 +181,11 @@ class SwSolver : public Solver
 
 	float mCurrentDt; //The delta time for the current simulated frame
 
+	float mFrameTimeBudget; // in milliseconds, 0 if disabled
+	Vector<BudgetAllocation>::Type mBudgetAllocations;
+
+	Vector<PrevParticleBuffer>::Type mPrevParticleBuffers;
+
 	mutable void* mSimulateProfileEventData;
 };
 }
@@ -34,6 +34,7 @@
 #include "SwFactory.h"
 #include "PointInterpolator.h"
 #include "BoundingBox.h"
+#include "HalfFloat.h"
 #include <foundation/PxProfiler.h>
 
 using namespace physx;
@@ -99,6 +100,35 @@ uint32_t getAvxSupport()
 }
 
 const uint32_t sAvxSupport = getAvxSupport(); // 0: no AVX, 1: AVX, 2: AVX+FMA
+
+// returns false if the portable solver has to be used instead
+template <bool useMultiplier>
+bool solveConstraintsAvx(float* __restrict posIt, const float* __restrict rIt, const float* __restrict stIt,
+                         const float* __restrict rEnd, const uint16_t* __restrict iIt, const __m128& stiffnessEtc,
+                         const __m128& stiffnessExponent)
+{
+	switch(sAvxSupport)
+	{
+	case 2:
+#if _MSC_VER >= 1700
+		avx::solveConstraints<useMultiplier, 2>(posIt, rIt, stIt, rEnd, iIt, stiffnessEtc, stiffnessExponent);
+		return true;
+#endif
+	case 1:
+		avx::solveConstraints<useMultiplier, 1>(posIt, rIt, stIt, rEnd, iIt, stiffnessEtc, stiffnessExponent);
+		return true;
+	default:
+		return false;
+	}
+}
+
+// the avx kernels don't decode quantized rest values
+template <bool useMultiplier, typename RestvalueType, typename StiffnessType>
+bool solveConstraintsAvx(float*, const RestvalueType*, const StiffnessType*, const RestvalueType*, const uint16_t*,
+                         const __m128&, const __m128&)
+{
+	return false;
+}
 }
 #endif
 
@@ -109,6 +139,7 @@ namespace
 {
 /* simd constants */
 
+const Simd4fTupleFactory sMaskX = simd4f(simd4i(~0, 0, 0, 0));
 const Simd4fTupleFactory sMaskW = simd4f(simd4i(0, 0, 0, ~0));
 const Simd4fTupleFactory sMaskXY = simd4f(simd4i(~0, ~0, 0, 0));
 const Simd4fTupleFactory sMaskXYZ = simd4f(simd4i(~0, ~0, ~0, 0));
@@ -117,6 +148,10 @@ const Simd4fTupleFactory sMinusOneXYZOneW = simd4f(-1.0f, -1.0f, -1.0f, 1.0f);
 const Simd4fTupleFactory sFloatMaxW = simd4f(0.0f, 0.0f, 0.0f, FLT_MAX);
 const Simd4fTupleFactory sMinusFloatMaxXYZ = simd4f(-FLT_MAX, -FLT_MAX, -FLT_MAX, 0.0f);
 
+// particles per batch when running particle local passes back to back,
+// current and previous positions of a batch fit into L1 (multiple of 4)
+const uint32_t sParticleBatchSize = 256;
+
 /* static worker functions */
 
 /**
@@ -167,6 +202,75 @@ void integrateParticles(T4f* __restrict curIt, T4f* __restrict curEnd, T4f* __re
 	}
 }
 
+// expands the compressed previous particles, stored as half precision offsets from the current ones
+// and their inverse masses, same conversion as halfToFloat() for all xyz at once
+template <typename T4f>
+void decodePrevParticles(const T4f* __restrict curIt, const T4f* curEnd, T4f* __restrict prevIt,
+                         const SwCompressedParticle* cIt, const float* wIt)
+{
+	typedef typename Simd4fToSimd4i<T4f>::Type T4i;
+
+	const T4i magnitudeMask = simd4i(0x7fff);
+	const T4i signMask = simd4i(0x8000);
+	const T4f rebias = simd4f(simd4i((254 - 15) << 23));
+
+	for (; curIt != curEnd; ++curIt, ++prevIt, ++cIt, ++wIt)
+	{
+		T4i half = simd4i(cIt->mOffset[0], cIt->mOffset[1], cIt->mOffset[2], 0);
+		T4f offset = simd4f((half & magnitudeMask) << 13) * rebias;
+		offset = offset | simd4f((half & signMask) << 16);
+		*prevIt = select(sMaskXYZ, *curIt + offset, simd4f(*wIt));
+	}
+}
+
+// moves 4 particles inside their motion constraint spheres, returns false if none of them is outside
+template <typename T4f, typename ConstraintIterator>
+inline bool constrainMotion(T4f& curPos0, T4f& curPos1, T4f& curPos2, T4f& curPos3, ConstraintIterator& sphIt,
+                            const T4f& scale, const T4f& bias, const T4f& stiffness)
+{
+	//delta.xyz = sphereCenter - currentPosition
+	//delta.w = sphereRadius
+	T4f delta0 = *sphIt - (sMaskXYZ & curPos0);
+	++sphIt;
+	T4f delta1 = *sphIt - (sMaskXYZ & curPos1);
+	++sphIt;
+	T4f delta2 = *sphIt - (sMaskXYZ & curPos2);
+	++sphIt;
+	T4f delta3 = *sphIt - (sMaskXYZ & curPos3);
+	++sphIt;
+
+	T4f deltaX = delta0, deltaY = delta1, deltaZ = delta2, deltaW = delta3;
+	transpose(deltaX, deltaY, deltaZ, deltaW);
+
+	T4f sqrLength = gSimd4fEpsilon + deltaX * deltaX + deltaY * deltaY + deltaZ * deltaZ;
+	T4f radius = max(gSimd4fZero, deltaW * scale + bias);
+
+	T4f slack = gSimd4fOne - radius * rsqrt(sqrLength);
+
+	// if slack <= 0.0f then we don't want to affect particle
+	// and can skip if all particles are unaffected
+	T4f isPositive;
+	if (!anyGreater(slack, gSimd4fZero, isPositive))
+		return false;
+
+	// set invMass to zero if radius is zero (xyz will be unchanged)
+	// curPos.w = radius > 0 ? curPos.w : 0
+	// the first three components are compared against -FLT_MAX which is always true
+	curPos0 = curPos0 & (splat<0>(radius) > sMinusFloatMaxXYZ);
+	curPos1 = curPos1 & (splat<1>(radius) > sMinusFloatMaxXYZ);
+	curPos2 = curPos2 & (splat<2>(radius) > sMinusFloatMaxXYZ);
+	curPos3 = curPos3 & ((radius) > sMinusFloatMaxXYZ);
+	// we don't have to splat the last one as the 4th element is already in the right place
+
+	slack = slack * stiffness & isPositive;
+
+	curPos0 = curPos0 + (delta0 & sMaskXYZ) * splat<0>(slack);
+	curPos1 = curPos1 + (delta1 & sMaskXYZ) * splat<1>(slack);
+	curPos2 = curPos2 + (delta2 & sMaskXYZ) * splat<2>(slack);
+	curPos3 = curPos3 + (delta3 & sMaskXYZ) * splat<3>(slack);
+	return true;
+}
+
 template <typename T4f, typename ConstraintIterator>
 void constrainMotion(T4f* __restrict curIt, const T4f* __restrict curEnd, const ConstraintIterator& spheres,
                      const T4f& scaleBiasStiffness)
@@ -186,49 +290,81 @@ void constrainMotion(T4f* __restrict curIt, const T4f* __restrict curEnd, const
 		T4f curPos2 = curIt[2];
 		T4f curPos3 = curIt[3];
 
-		//delta.xyz = sphereCenter - currentPosition
-		//delta.w = sphereRadius
-		T4f delta0 = *sphIt - (sMaskXYZ & curPos0);
-		++sphIt;
-		T4f delta1 = *sphIt - (sMaskXYZ & curPos1);
-		++sphIt;
-		T4f delta2 = *sphIt - (sMaskXYZ & curPos2);
-		++sphIt;
-		T4f delta3 = *sphIt - (sMaskXYZ & curPos3);
-		++sphIt;
-
-		T4f deltaX = delta0, deltaY = delta1, deltaZ = delta2, deltaW = delta3;
-		transpose(deltaX, deltaY, deltaZ, deltaW);
-
-		T4f sqrLength = gSimd4fEpsilon + deltaX * deltaX + deltaY * deltaY + deltaZ * deltaZ;
-		T4f radius = max(gSimd4fZero, deltaW * scale + bias);
-
-		T4f slack = gSimd4fOne - radius * rsqrt(sqrLength);
-
-		// if slack <= 0.0f then we don't want to affect particle
-		// and can skip if all particles are unaffected
-		T4f isPositive;
-		if (anyGreater(slack, gSimd4fZero, isPositive))
+		if (constrainMotion(curPos0, curPos1, curPos2, curPos3, sphIt, scale, bias, stiffness))
+		{
+			curIt[0] = curPos0;
+			curIt[1] = curPos1;
+			curIt[2] = curPos2;
+			curIt[3] = curPos3;
+		}
+	}
+}
+
+// sparse variant, sphere i constrains particle iIt[i], indices are padded to a multiple of 4
+template <typename T4f, typename ConstraintIterator>
+void constrainMotion(T4f* __restrict particles, const uint32_t* __restrict iIt, const uint32_t* __restrict iEnd,
+                     const ConstraintIterator& spheres, const T4f& scaleBiasStiffness)
+{
+	T4f scale = splat<0>(scaleBiasStiffness);
+	T4f bias = splat<1>(scaleBiasStiffness);
+	T4f stiffness = splat<3>(scaleBiasStiffness);
+
+	ConstraintIterator sphIt = spheres;
+
+	for (; iIt < iEnd; iIt += 4)
+	{
+		T4f curPos0 = particles[iIt[0]];
+		T4f curPos1 = particles[iIt[1]];
+		T4f curPos2 = particles[iIt[2]];
+		T4f curPos3 = particles[iIt[3]];
+
+		if (constrainMotion(curPos0, curPos1, curPos2, curPos3, sphIt, scale, bias, stiffness))
 		{
-			// set invMass to zero if radius is zero (xyz will be unchanged)
-			// curPos.w = radius > 0 ? curPos.w : 0
-			// the first three components are compared against -FLT_MAX which is always true
-			curPos0 = curPos0 & (splat<0>(radius) > sMinusFloatMaxXYZ);
-			curPos1 = curPos1 & (splat<1>(radius) > sMinusFloatMaxXYZ);
-			curPos2 = curPos2 & (splat<2>(radius) > sMinusFloatMaxXYZ);
-			curPos3 = curPos3 & ((radius) > sMinusFloatMaxXYZ);
-			// we don't have to splat the last one as the 4th element is already in the right place
-
-			slack = slack * stiffness & isPositive;
-
-			curIt[0] = curPos0 + (delta0 & sMaskXYZ) * splat<0>(slack);
-			curIt[1] = curPos1 + (delta1 & sMaskXYZ) * splat<1>(slack);
-			curIt[2] = curPos2 + (delta2 & sMaskXYZ) * splat<2>(slack);
-			curIt[3] = curPos3 + (delta3 & sMaskXYZ) * splat<3>(slack);
+			particles[iIt[0]] = curPos0;
+			particles[iIt[1]] = curPos1;
+			particles[iIt[2]] = curPos2;
+			particles[iIt[3]] = curPos3;
 		}
 	}
 }
 
+// pushes 4 particles out of their separation constraint spheres, returns false if none of them is inside
+template <typename T4f, typename ConstraintIterator>
+inline bool constrainSeparation(T4f& curPos0, T4f& curPos1, T4f& curPos2, T4f& curPos3, ConstraintIterator& sphIt)
+{
+	//delta.xyz = sphereCenter - currentPosition
+	//delta.w = sphereRadius
+	T4f delta0 = *sphIt - (sMaskXYZ & curPos0);
+	++sphIt;
+	T4f delta1 = *sphIt - (sMaskXYZ & curPos1);
+	++sphIt;
+	T4f delta2 = *sphIt - (sMaskXYZ & curPos2);
+	++sphIt;
+	T4f delta3 = *sphIt - (sMaskXYZ & curPos3);
+	++sphIt;
+
+	T4f deltaX = delta0, deltaY = delta1, deltaZ = delta2, deltaW = delta3;
+	transpose(deltaX, deltaY, deltaZ, deltaW);
+
+	T4f sqrLength = gSimd4fEpsilon + deltaX * deltaX + deltaY * deltaY + deltaZ * deltaZ;
+
+	T4f slack = gSimd4fOne - deltaW * rsqrt<1>(sqrLength);
+
+	// if slack >= 0.0f then we don't want to affect particle
+	// and can skip if all particles are unaffected
+	T4f isNegative;
+	if (!anyGreater(gSimd4fZero, slack, isNegative))
+		return false;
+
+	slack = slack & isNegative;
+
+	curPos0 = curPos0 + (delta0 & sMaskXYZ) * splat<0>(slack);
+	curPos1 = curPos1 + (delta1 & sMaskXYZ) * splat<1>(slack);
+	curPos2 = curPos2 + (delta2 & sMaskXYZ) * splat<2>(slack);
+	curPos3 = curPos3 + (delta3 & sMaskXYZ) * splat<3>(slack);
+	return true;
+}
+
 template <typename T4f, typename ConstraintIterator>
 void constrainSeparation(T4f* __restrict curIt, const T4f* __restrict curEnd, const ConstraintIterator& spheres)
 {
@@ -243,47 +379,181 @@ void constrainSeparation(T4f* __restrict curIt, const T4f* __restrict curEnd, co
 		T4f curPos2 = curIt[2];
 		T4f curPos3 = curIt[3];
 
-		//delta.xyz = sphereCenter - currentPosition
-		//delta.w = sphereRadius
-		T4f delta0 = *sphIt - (sMaskXYZ & curPos0);
-		++sphIt;
-		T4f delta1 = *sphIt - (sMaskXYZ & curPos1);
-		++sphIt;
-		T4f delta2 = *sphIt - (sMaskXYZ & curPos2);
-		++sphIt;
-		T4f delta3 = *sphIt - (sMaskXYZ & curPos3);
-		++sphIt;
-
-		T4f deltaX = delta0, deltaY = delta1, deltaZ = delta2, deltaW = delta3;
-		transpose(deltaX, deltaY, deltaZ, deltaW);
+		if (constrainSeparation(curPos0, curPos1, curPos2, curPos3, sphIt))
+		{
+			curIt[0] = curPos0;
+			curIt[1] = curPos1;
+			curIt[2] = curPos2;
+			curIt[3] = curPos3;
+		}
+	}
+}
 
-		T4f sqrLength = gSimd4fEpsilon + deltaX * deltaX + deltaY * deltaY + deltaZ * deltaZ;
+// sparse variant, sphere i constrains particle iIt[i], indices are padded to a multiple of 4
+template <typename T4f, typename ConstraintIterator>
+void constrainSeparation(T4f* __restrict particles, const uint32_t* __restrict iIt, const uint32_t* __restrict iEnd,
+                         const ConstraintIterator& spheres)
+{
+	ConstraintIterator sphIt = spheres;
 
-		T4f slack = gSimd4fOne - deltaW * rsqrt<1>(sqrLength);
+	for (; iIt < iEnd; iIt += 4)
+	{
+		T4f curPos0 = particles[iIt[0]];
+		T4f curPos1 = particles[iIt[1]];
+		T4f curPos2 = particles[iIt[2]];
+		T4f curPos3 = particles[iIt[3]];
 
-		// if slack >= 0.0f then we don't want to affect particle
-		// and can skip if all particles are unaffected
-		T4f isNegative;
-		if (anyGreater(gSimd4fZero, slack, isNegative))
+		if (constrainSeparation(curPos0, curPos1, curPos2, curPos3, sphIt))
 		{
-			slack = slack & isNegative;
-
-			curIt[0] = curPos0 + (delta0 & sMaskXYZ) * splat<0>(slack);
-			curIt[1] = curPos1 + (delta1 & sMaskXYZ) * splat<1>(slack);
-			curIt[2] = curPos2 + (delta2 & sMaskXYZ) * splat<2>(slack);
-			curIt[3] = curPos3 + (delta3 & sMaskXYZ) * splat<3>(slack);
+			particles[iIt[0]] = curPos0;
+			particles[iIt[1]] = curPos1;
+			particles[iIt[2]] = curPos2;
+			particles[iIt[3]] = curPos3;
 		}
 	}
 }
 
+// applies the motion constraints [first, last) to the particles, or to the particles they are indexed by
+template <typename T4f>
+struct MotionConstraintPass
+{
+	MotionConstraintPass(T4f* particles, const uint32_t* indices, const T4f& scaleBiasStiffness)
+	: mParticles(particles), mIndices(indices), mScaleBiasStiffness(scaleBiasStiffness)
+	{
+	}
 
+	template <typename ConstraintIterator>
+	void operator()(uint32_t first, uint32_t last, const ConstraintIterator& sphIt) const
+	{
+		if (mIndices)
+			constrainMotion(mParticles, mIndices + first, mIndices + last, sphIt, mScaleBiasStiffness);
+		else
+			constrainMotion(mParticles + first, mParticles + last, sphIt, mScaleBiasStiffness);
+	}
+
+	T4f* mParticles;
+	const uint32_t* mIndices; // null if there is one constraint per particle
+	T4f mScaleBiasStiffness;
+};
+
+// same for the separation constraints
+template <typename T4f>
+struct SeparationConstraintPass
+{
+	SeparationConstraintPass(T4f* particles, const uint32_t* indices) : mParticles(particles), mIndices(indices)
+	{
+	}
+
+	template <typename ConstraintIterator>
+	void operator()(uint32_t first, uint32_t last, const ConstraintIterator& sphIt) const
+	{
+		if (mIndices)
+			constrainSeparation(mParticles, mIndices + first, mIndices + last, sphIt);
+		else
+			constrainSeparation(mParticles + first, mParticles + last, sphIt);
+	}
+
+	T4f* mParticles;
+	const uint32_t* mIndices;
+};
+
+// runs pass with the start, target or interpolated constraints of the current iteration
+template <typename T4f, typename Pass, typename ConstraintIterator>
+void constrainParticles(const Pass& pass, uint32_t first, uint32_t last, const ConstraintIterator& startIt,
+                        const ConstraintIterator* targetIt, const cloth::IterationState<T4f>& state)
+{
+	// no interpolation, use the start positions
+	if (!targetIt)
+		return pass(first, last, startIt);
+
+	// use the target positions on last iteration
+	if (state.mRemainingIterations == 1)
+		return pass(first, last, *targetIt);
+
+	// otherwise use an interpolating iterator
+	pass(first, last, cloth::LerpIterator<T4f, ConstraintIterator>(startIt, *targetIt, state.getCurrentAlpha()));
+}
+
+// copies the last count - first (at most 4) elements of a caller buffer and repeats the last one to fill a batch
+template <typename T4f>
+void loadLastBatch(T4f (&batch)[4], const float* pointer, uint32_t stride, uint32_t first, uint32_t count)
+{
+	cloth::StridedIterator<T4f> it(pointer, stride, first);
+	for (uint32_t i = 0; i < 4; ++i)
+		batch[i] = it[std::min(i, count - first - 1)];
+}
+
+/**
+    runs pass on the constraints [first, last), first is a multiple of 4 and the passes read batches of 4.
+    internal arrays are aligned and padded to a multiple of 4 and are read directly.
+    caller buffers hold count elements without padding and are read strided, the batch
+    that would read past the end reads from a padded copy instead.
+ */
+template <typename T4f, typename Pass>
+void constrainParticles(const Pass& pass, uint32_t first, uint32_t last, const float* start, const float* target,
+                        uint32_t stride, uint32_t count, bool isBuffer, const cloth::IterationState<T4f>& state)
+{
+	if (!isBuffer)
+	{
+		const T4f* startIt = reinterpret_cast<const T4f*>(start) + first;
+		const T4f* targetIt = reinterpret_cast<const T4f*>(target) + first;
+		return constrainParticles(pass, first, last, startIt, target ? &targetIt : nullptr, state);
+	}
+
+	uint32_t split = std::max(first, std::min(last, count & ~3u));
+	if (first < split)
+	{
+		cloth::StridedIterator<T4f> startIt(start, stride, first);
+		cloth::StridedIterator<T4f> targetIt(target, stride, first);
+		constrainParticles(pass, first, split, startIt, target ? &targetIt : nullptr, state);
+	}
+
+	if (split < last)
+	{
+		T4f startBatch[4], targetBatch[4];
+		loadLastBatch(startBatch, start, stride, split, count);
+		if (target)
+			loadLastBatch(targetBatch, target, stride, split, count);
+		const T4f* startIt = startBatch;
+		const T4f* targetIt = targetBatch;
+		constrainParticles(pass, split, last, startIt, target ? &targetIt : nullptr, state);
+	}
+}
+
+// loads 4 rest or stiffness values, quantized fabrics store them as 16 bit integers relative to scale
+template <typename T4f>
+inline T4f loadConstraintValues(const float* it, const T4f&)
+{
+	return static_cast<T4f>(loadAligned(it));
+}
+
+template <typename T4f, typename QuantizedType>
+inline T4f loadConstraintValues(const QuantizedType* it, const T4f& scale)
+{
+	return static_cast<T4f>(simd4f(float(it[0]), float(it[1]), float(it[2]), float(it[3]))) * scale;
+}
+
+// rigid constraints are stored as a separate code, see SwFabric::quantize()
+template <typename T4f>
+inline T4f loadConstraintValues(const int16_t* it, const T4f& scale)
+{
+	T4f values = static_cast<T4f>(simd4f(float(it[0]), float(it[1]), float(it[2]), float(it[3])));
+	T4f isRigid = values == static_cast<T4f>(simd4f(float(SwFabric::sQuantizedRigidStiffness)));
+	return select(isRigid, static_cast<T4f>(simd4f(-float(FLT_MAX_EXP))), values * scale);
+}
 
 /**
     traditional gauss-seidel internal constraint solver
+    optionally accumulates the relative length error before solving into residual
+    relaxation scales the per constraint stiffness, a uniform stiffness is expected to be relaxed already
+    recordSize is the stride in values between batches, 4 for separate arrays or the packed record size
+    scales.xy decode quantized rest and stiffness values
  */
-template <bool useMultiplier, typename T4f>
-void solveConstraints(float* __restrict posIt, const float* __restrict rIt, const float* __restrict stIt, const float* __restrict rEnd,
-                      const uint16_t* __restrict iIt, const T4f& stiffnessEtc, const T4f& stiffnessExponent)
+template <bool useMultiplier, bool useResidual, bool useStiffnessPerConstraint, uint32_t recordSize, typename T4f,
+          typename RestvalueType, typename StiffnessType>
+void solveConstraints(float* __restrict posIt, const RestvalueType* __restrict rIt, const StiffnessType* __restrict stIt,
+                      const RestvalueType* __restrict rEnd, const uint16_t* __restrict iIt, const T4f& scales,
+                      const T4f& stiffnessEtc, const T4f& stiffnessExponent, const T4f& relaxation, T4f& residual)
 {
 	//posIt		particle position (and invMass) iterator
 	//rIt,rEnd	edge rest length iterator
@@ -297,9 +567,10 @@ void solveConstraints(float* __restrict posIt, const float* __restrict rIt, cons
 		multiplier = splat<1>(stiffnessEtc);
 	}
 	T4f stiffness = splat<0>(stiffnessEtc);
-	bool useStiffnessPerConstraint = stIt!=nullptr;
+	T4f restvalueScale = splat<0>(scales);
+	T4f stiffnessScale = splat<1>(scales);
 
-	for (; rIt != rEnd; rIt += 4, stIt += 4, iIt += 8)
+	for (; rIt != rEnd; rIt += recordSize, stIt += recordSize, iIt += recordSize * 2)
 	{
 		//Calculate particle indices
 		uint32_t p0i = iIt[0] * sizeof(PxVec4);
@@ -335,10 +606,10 @@ void solveConstraints(float* __restrict posIt, const float* __restrict rIt, cons
 		transpose(hxij, hyij, hzij, vwij);
 
 		//load rest lengths
-		T4f rij = loadAligned(rIt);
+		T4f rij = loadConstraintValues(rIt, restvalueScale);
 
 		//Load/calculate the constraint stiffness
-		T4f stij = useStiffnessPerConstraint ? gSimd4fOne - exp2(stiffnessExponent * static_cast<T4f>(loadAligned(stIt))) : stiffness;
+		T4f stij = useStiffnessPerConstraint ? (gSimd4fOne - exp2(stiffnessExponent * loadConstraintValues(stIt, stiffnessScale))) * relaxation : stiffness;
 
 		//squared distance between particles: e2 = epsilon + |h|^2
 		T4f e2ij = gSimd4fEpsilon + hxij * hxij + hyij * hyij + hzij * hzij;
@@ -347,6 +618,11 @@ void solveConstraints(float* __restrict posIt, const float* __restrict rIt, cons
 		//       or er = 0 if rest length < epsilon
 		T4f erij = (gSimd4fOne - rij * rsqrt(e2ij)) & (rij > gSimd4fEpsilon);
 
+		if (useResidual)
+		{
+			residual = residual + abs(erij);
+		}
+
 		if (useMultiplier)
 		{
 			erij = erij - multiplier * max(compressionLimit, min(erij, stretchLimit));
@@ -373,6 +649,168 @@ void solveConstraints(float* __restrict posIt, const float* __restrict rIt, cons
 	}
 }
 
+// picks the variant with or without per constraint stiffness outside of the loop
+template <bool useMultiplier, bool useResidual, typename T4f, typename RestvalueType, typename StiffnessType>
+void solveConstraints(float* __restrict posIt, const RestvalueType* __restrict rIt, const StiffnessType* __restrict stIt,
+                      const RestvalueType* __restrict rEnd, const uint16_t* __restrict iIt, uint32_t recordSize,
+                      const T4f& scales, const T4f& stiffnessEtc, const T4f& stiffnessExponent, const T4f& relaxation,
+                      T4f& residual)
+{
+	// only float rest values are packed
+	NV_CLOTH_ASSERT(recordSize == 4);
+	PX_UNUSED(recordSize);
+	if (stIt)
+		solveConstraints<useMultiplier, useResidual, true, 4>(posIt, rIt, stIt, rEnd, iIt, scales, stiffnessEtc,
+		                                                      stiffnessExponent, relaxation, residual);
+	else
+		solveConstraints<useMultiplier, useResidual, false, 4>(posIt, rIt, stIt, rEnd, iIt, scales, stiffnessEtc,
+		                                                       stiffnessExponent, relaxation, residual);
+}
+
+// float rest values, additionally picks the packed record layout outside of the loop
+template <bool useMultiplier, bool useResidual, typename T4f>
+void solveConstraints(float* __restrict posIt, const float* __restrict rIt, const float* __restrict stIt,
+                      const float* __restrict rEnd, const uint16_t* __restrict iIt, uint32_t recordSize,
+                      const T4f& scales, const T4f& stiffnessEtc, const T4f& stiffnessExponent, const T4f& relaxation,
+                      T4f& residual)
+{
+	switch (recordSize)
+	{
+	case 12: // packed, with stiffness
+		solveConstraints<useMultiplier, useResidual, true, 12>(posIt, rIt, stIt, rEnd, iIt, scales, stiffnessEtc,
+		                                                       stiffnessExponent, relaxation, residual);
+		break;
+	case 8: // packed
+		solveConstraints<useMultiplier, useResidual, false, 8>(posIt, rIt, stIt, rEnd, iIt, scales, stiffnessEtc,
+		                                                       stiffnessExponent, relaxation, residual);
+		break;
+	default:
+		NV_CLOTH_ASSERT(recordSize == 4);
+		if (stIt)
+			solveConstraints<useMultiplier, useResidual, true, 4>(posIt, rIt, stIt, rEnd, iIt, scales, stiffnessEtc,
+			                                                      stiffnessExponent, relaxation, residual);
+		else
+			solveConstraints<useMultiplier, useResidual, false, 4>(posIt, rIt, stIt, rEnd, iIt, scales, stiffnessEtc,
+			                                                       stiffnessExponent, relaxation, residual);
+	}
+}
+
+template <bool useMultiplier, typename T4f, typename RestvalueType, typename StiffnessType>
+void solveConstraints(float* __restrict posIt, const RestvalueType* __restrict rIt, const StiffnessType* __restrict stIt,
+                      const RestvalueType* __restrict rEnd, const uint16_t* __restrict iIt, uint32_t recordSize,
+                      const T4f& scales, const T4f& stiffnessEtc, const T4f& stiffnessExponent)
+{
+	T4f residual;
+	solveConstraints<useMultiplier, false>(posIt, rIt, stIt, rEnd, iIt, recordSize, scales, stiffnessEtc,
+	                                       stiffnessExponent, static_cast<T4f>(gSimd4fOne), residual);
+}
+
+/**
+    xpbd variant of the constraint solver, the correction uses compliance / iterDt^2 instead of a stiffness
+    every iteration is a substep visiting each constraint once, so the lagrange multipliers start from zero
+    and the multiplier of the substep is stored for force queries
+ */
+template <bool useMultiplier, bool useResidual, typename T4f, typename RestvalueType>
+void solveCompliantConstraints(float* __restrict posIt, const RestvalueType* __restrict rIt, const float* __restrict ctIt,
+                               const RestvalueType* __restrict rEnd, const uint16_t* __restrict iIt,
+                               float* __restrict lambdaIt, const T4f& scales, const T4f& stiffnessEtc,
+                               const T4f& compliance, const T4f& invSqrIterDt, T4f& residual)
+{
+	T4f stretchLimit, compressionLimit, multiplier;
+	if (useMultiplier)
+	{
+		stretchLimit = splat<3>(stiffnessEtc);
+		compressionLimit = splat<2>(stiffnessEtc);
+		multiplier = splat<1>(stiffnessEtc);
+	}
+	T4f alpha = compliance * invSqrIterDt;
+	bool useCompliancePerConstraint = ctIt != nullptr;
+	T4f restvalueScale = splat<0>(scales);
+
+	for (; rIt != rEnd; rIt += 4, ctIt += 4, lambdaIt += 4, iIt += 8)
+	{
+		uint32_t p0i = iIt[0] * sizeof(PxVec4);
+		uint32_t p0j = iIt[1] * sizeof(PxVec4);
+		uint32_t p1i = iIt[2] * sizeof(PxVec4);
+		uint32_t p1j = iIt[3] * sizeof(PxVec4);
+		uint32_t p2i = iIt[4] * sizeof(PxVec4);
+		uint32_t p2j = iIt[5] * sizeof(PxVec4);
+		uint32_t p3i = iIt[6] * sizeof(PxVec4);
+		uint32_t p3j = iIt[7] * sizeof(PxVec4);
+
+		T4f v0i = loadAligned(posIt, p0i);
+		T4f v0j = loadAligned(posIt, p0j);
+		T4f v1i = loadAligned(posIt, p1i);
+		T4f v1j = loadAligned(posIt, p1j);
+		T4f v2i = loadAligned(posIt, p2i);
+		T4f v2j = loadAligned(posIt, p2j);
+		T4f v3i = loadAligned(posIt, p3i);
+		T4f v3j = loadAligned(posIt, p3j);
+
+		T4f h0ij = v0j + v0i * sMinusOneXYZOneW;
+		T4f h1ij = v1j + v1i * sMinusOneXYZOneW;
+		T4f h2ij = v2j + v2i * sMinusOneXYZOneW;
+		T4f h3ij = v3j + v3i * sMinusOneXYZOneW;
+
+		T4f hxij = h0ij, hyij = h1ij, hzij = h2ij, vwij = h3ij;
+		transpose(hxij, hyij, hzij, vwij);
+
+		T4f rij = loadConstraintValues(rIt, restvalueScale);
+
+		//alpha = compliance / iterDt^2
+		T4f alphaij = useCompliancePerConstraint ? static_cast<T4f>(loadAligned(ctIt)) * invSqrIterDt : alpha;
+
+		T4f e2ij = gSimd4fEpsilon + hxij * hxij + hyij * hyij + hzij * hzij;
+		T4f erij = (gSimd4fOne - rij * rsqrt(e2ij)) & (rij > gSimd4fEpsilon);
+
+		if (useResidual)
+		{
+			residual = residual + abs(erij);
+		}
+
+		if (useMultiplier)
+		{
+			erij = erij - multiplier * max(compressionLimit, min(erij, stretchLimit));
+		}
+
+		//C = er * |h|, lambda = -C / (invMass sum + alpha), ex = -lambda / |h|
+		T4f exij = erij * recip(gSimd4fEpsilon + vwij + alphaij);
+		storeAligned(lambdaIt, gSimd4fZero - exij * sqrt(e2ij));
+
+		h0ij = h0ij * splat<0>(exij) & sMaskXYZ;
+		h1ij = h1ij * splat<1>(exij) & sMaskXYZ;
+		h2ij = h2ij * splat<2>(exij) & sMaskXYZ;
+		h3ij = h3ij * splat<3>(exij) & sMaskXYZ;
+
+		storeAligned(posIt, p0i, v0i + h0ij * splat<3>(v0i));
+		storeAligned(posIt, p0j, v0j - h0ij * splat<3>(v0j));
+		storeAligned(posIt, p1i, v1i + h1ij * splat<3>(v1i));
+		storeAligned(posIt, p1j, v1j - h1ij * splat<3>(v1j));
+		storeAligned(posIt, p2i, v2i + h2ij * splat<3>(v2i));
+		storeAligned(posIt, p2j, v2j - h2ij * splat<3>(v2j));
+		storeAligned(posIt, p3i, v3i + h3ij * splat<3>(v3i));
+		storeAligned(posIt, p3j, v3j - h3ij * splat<3>(v3j));
+	}
+}
+
+/**
+    over-relaxation factor for the given iteration of a frame
+    ramps up from 1 to target following the chebyshev semi-iterative recurrence
+    for the spectral radius that makes target the optimal SOR factor
+ */
+float chebyshevRelaxation(float target, uint32_t iteration)
+{
+	if (target <= 1.0f || iteration == 0)
+		return 1.0f;
+
+	float rhoSqr = 4.0f * (target - 1.0f) / (target * target);
+	float omega = 2.0f / (2.0f - rhoSqr);
+	for (uint32_t i = 1; i < iteration && omega < target; ++i)
+		omega = 4.0f / (4.0f - rhoSqr * omega);
+
+	return std::min(omega, target);
+}
+
 #if PX_WINDOWS_FAMILY && NV_SIMD_SSE2
 #include "sse2/SwSolveConstraints.h"
 #endif
@@ -504,11 +942,16 @@ size_t cloth::SwSolverKernel<T4f>::estimateTemporaryMemory(const SwCloth& cloth)
 
 template <typename T4f>
 template <typename AccelerationIterator>
-void cloth::SwSolverKernel<T4f>::integrateParticles(AccelerationIterator& accelIt, const T4f& prevBias)
+void cloth::SwSolverKernel<T4f>::integrateParticles(AccelerationIterator& accelIt, const T4f& prevBias,
+                                                    uint32_t first, uint32_t last)
 {
-	T4f* curIt = reinterpret_cast<T4f*>(mClothData.mCurParticles);
-	T4f* curEnd = curIt + mClothData.mNumParticles;
-	T4f* prevIt = reinterpret_cast<T4f*>(mClothData.mPrevParticles);
+	T4f* curIt = reinterpret_cast<T4f*>(mClothData.mCurParticles) + first;
+	T4f* curEnd = reinterpret_cast<T4f*>(mClothData.mCurParticles) + last;
+	T4f* prevIt = reinterpret_cast<T4f*>(mClothData.mPrevParticles) + first;
+
+	if (mClothData.mCompressedPrevParticles)
+		decodePrevParticles(curIt, curEnd, prevIt, mClothData.mCompressedPrevParticles + first,
+		                    mClothData.mPrevInvMasses + first);
 
 	if (!mState.mIsTurning)
 	{
@@ -526,7 +969,19 @@ void cloth::SwSolverKernel<T4f>::integrateParticles()
 {
 	NV_CLOTH_PROFILE_ZONE("cloth::SwSolverKernel::integrateParticles", /*ProfileContext::None*/ 0);
 
-	const T4f* startAccelIt = reinterpret_cast<const T4f*>(mClothData.mParticleAccelerations);
+	uint32_t numParticles = mClothData.mNumParticles;
+	if (!mClothData.mCompressedPrevParticles)
+		return integrateParticles(0, numParticles);
+
+	// decode the compressed history batch by batch and integrate it while it is in cache
+	for (uint32_t first = 0; first < numParticles; first += sParticleBatchSize)
+		integrateParticles(first, std::min(first + sParticleBatchSize, numParticles));
+}
+
+template <typename T4f>
+void cloth::SwSolverKernel<T4f>::integrateParticles(uint32_t first, uint32_t last)
+{
+	const float* startAccelIt = mClothData.mParticleAccelerations;
 
 	// dt^2 (todo: should this be the smoothed dt used for gravity?)
 	const T4f sqrIterDt = simd4f(sqr(mState.mIterDt)) & static_cast<T4f>(sMaskXYZ);
@@ -535,13 +990,21 @@ void cloth::SwSolverKernel<T4f>::integrateParticles()
 	{
 		// no per-particle accelerations, use a constant
 		ConstantIterator<T4f> accelIt(mState.mCurBias);
-		integrateParticles(accelIt, mState.mPrevBias);
+		integrateParticles(accelIt, mState.mPrevBias, first, last);
 	}
-	else
+	else if (!mCloth.mParticleAccelerationBuffer)
 	{
 		// iterator implicitly scales by dt^2 and adds gravity
-		ScaleBiasIterator<T4f, const T4f*> accelIt(startAccelIt, sqrIterDt, mState.mCurBias);
-		integrateParticles(accelIt, mState.mPrevBias);
+		ScaleBiasIterator<T4f, const T4f*> accelIt(reinterpret_cast<const T4f*>(startAccelIt) + first, sqrIterDt,
+		                                           mState.mCurBias);
+		integrateParticles(accelIt, mState.mPrevBias, first, last);
+	}
+	else
+	{
+		// caller buffers are read strided, integration never reads past the last particle
+		StridedIterator<T4f> baseIt(startAccelIt, mClothData.mParticleAccelerationStride, first);
+		ScaleBiasIterator<T4f, StridedIterator<T4f> > accelIt(baseIt, sqrIterDt, mState.mCurBias);
+		integrateParticles(accelIt, mState.mPrevBias, first, last);
 	}
 }
 
@@ -553,6 +1016,16 @@ void cloth::SwSolverKernel<T4f>::constrainTether()
 
 	NV_CLOTH_PROFILE_ZONE("cloth::SwSolverKernel::solveTethers", /*ProfileContext::None*/ 0);
 
+	if (mClothData.mQuantizedTethers)
+		constrainTether(mClothData.mQuantizedTethers);
+	else
+		constrainTether(mClothData.mTethers);
+}
+
+template <typename T4f>
+template <typename TetherType>
+void cloth::SwSolverKernel<T4f>::constrainTether(const TetherType* tethers)
+{
 	uint32_t numParticles = mClothData.mNumParticles;
 	uint32_t numTethers = mClothData.mNumTethers;
 	NV_CLOTH_ASSERT(0 == numTethers % numParticles); // the particles can have multiple tethers, but each particle has the same amount
@@ -563,14 +1036,14 @@ void cloth::SwSolverKernel<T4f>::constrainTether()
 	const float* __restrict curEnd = curIt + 4 * numParticles;
 
 	//Tether iterators
-	typedef const SwTether* __restrict TetherIter;
-	TetherIter tFirst = mClothData.mTethers;
+	typedef const TetherType* __restrict TetherIter;
+	TetherIter tFirst = tethers;
 	TetherIter tEnd = tFirst + numTethers;
 
 	//Tether properties
 	T4f stiffness =
 	    static_cast<T4f>(sMaskXYZ) & simd4f(numParticles * mClothData.mTetherConstraintStiffness / numTethers);
-	T4f scale = simd4f(mClothData.mTetherConstraintScale);
+	T4f scale = simd4f(mClothData.mTetherConstraintScale); // includes the quantization scale
 
 	//Loop through all particles
 	for (; curIt != curEnd; curIt += 4, ++tFirst)
@@ -588,8 +1061,7 @@ void cloth::SwSolverKernel<T4f>::constrainTether()
 			T4f delta = anchor - position;
 			T4f sqrLength = gSimd4fEpsilon + dot3(delta, delta);
 
-			T4f tetherLength = load(&tIt->mLength);
-			tetherLength = splat<0>(tetherLength);
+			T4f tetherLength = simd4f(float(tIt->mLength));
 
 			T4f radius = tetherLength * scale;
 			T4f slack = gSimd4fOne - radius * rsqrt(sqrLength);
@@ -602,10 +1074,21 @@ void cloth::SwSolverKernel<T4f>::constrainTether()
 }
 
 template <typename T4f>
+template <uint32_t Features>
 void cloth::SwSolverKernel<T4f>::solveFabric()
 {
 	NV_CLOTH_PROFILE_ZONE("cloth::SwSolverKernel::solveFabric", /*ProfileContext::None*/ 0);
 
+	if (mClothData.mQuantizedRestvalues)
+		solveFabric<Features>(mClothData.mQuantizedRestvalues, mClothData.mQuantizedStiffnessValues);
+	else
+		solveFabric<Features>(mClothData.mRestvalues, mClothData.mStiffnessValues);
+}
+
+template <typename T4f>
+template <uint32_t Features, typename RestvalueType, typename StiffnessType>
+void cloth::SwSolverKernel<T4f>::solveFabric(const RestvalueType* rBegin, const StiffnessType* stBegin)
+{
 	float* pIt = mClothData.mCurParticles;
 
 	//Phase configuration
@@ -613,32 +1096,64 @@ void cloth::SwSolverKernel<T4f>::solveFabric()
 	const PhaseConfig* cEnd = mClothData.mConfigEnd;
 
 	const uint32_t* pBegin = mClothData.mPhases;
-	const float* rBegin = mClothData.mRestvalues;
-	const float* stBegin = mClothData.mStiffnessValues;
+	const float* qBegin = mClothData.mQuantizationScales;
+	const float* ctBegin = mClothData.mConstraintCompliances;
 
 	const uint32_t* sBegin = mClothData.mSets;
 	const uint16_t* iBegin = mClothData.mIndices;
+	const float* kBegin = mClothData.mPackedConstraints;
 
 	uint32_t totalConstraints = 0;
 
 	T4f stiffnessExponent = simd4f(mCloth.mStiffnessFrequency * mState.mIterDt);
+	T4f invSqrIterDt = simd4f(1.0f / sqr(mState.mIterDt));
+
+	// the residual is only measured during the last iteration of the frame
+	float* phaseResiduals = mState.mRemainingIterations == 1 ? mClothData.mPhaseResiduals : nullptr;
+
+	// index of the current iteration within the frame
+	uint32_t iteration = uint32_t(1.0f / mState.mInvNumIterations + 0.5f) - mState.mRemainingIterations;
+	float totalResidual = 0.0f;
+	if (phaseResiduals)
+		memset(phaseResiduals, 0, mClothData.mNumPhases * sizeof(float));
 
 	//Loop through all phase configs
 	for (; cIt != cEnd; ++cIt)
 	{
 		//Get the set for this config
-		const uint32_t* sIt = sBegin + pBegin[cIt->mPhaseIndex];
+		uint32_t setIndex = pBegin[cIt->mPhaseIndex];
+		const uint32_t* sIt = sBegin + setIndex;
 
 		//Get rest value iterators from set
-		const float* rIt = rBegin + sIt[0];
-		const float* rEnd = rBegin + sIt[1]; //start of next set is the end of ours
-		const float* stIt = stBegin?stBegin + sIt[0]:nullptr;
+		const RestvalueType* rIt = rBegin + sIt[0];
+		const RestvalueType* rEnd = rBegin + sIt[1]; //start of next set is the end of ours
+		const StiffnessType* stIt = stBegin?stBegin + sIt[0]:nullptr;
+
+		// (rest value, stiffness) scale of quantized fabrics
+		T4f scales = qBegin ? static_cast<T4f>(simd4f(qBegin[setIndex * 2], qBegin[setIndex * 2 + 1], 0.0f, 0.0f))
+		                    : static_cast<T4f>(gSimd4fOne);
 
 		//Constraint particle indices
 		const uint16_t* iIt = iBegin + sIt[0] * 2; //x2 as we have 2 indices for every rest length
 
 		totalConstraints += uint32_t(rEnd - rIt);
 
+		// the portable solver reads the same batches from the packed stream if the fabric has one
+		const RestvalueType* kIt = rIt, *kEnd = rEnd;
+		const StiffnessType* kstIt = stIt;
+		const uint16_t* kiIt = iIt;
+		uint32_t recordSize = 4;
+		if (kBegin)
+		{
+			// only float rest values are packed
+			recordSize = mClothData.mPackedRecordSize;
+			const float* kFirst = kBegin + sIt[0] / 4 * recordSize;
+			kIt = reinterpret_cast<const RestvalueType*>(kFirst);
+			kEnd = reinterpret_cast<const RestvalueType*>(kBegin + sIt[1] / 4 * recordSize);
+			kstIt = stIt ? reinterpret_cast<const StiffnessType*>(kFirst + 8) : nullptr;
+			kiIt = reinterpret_cast<const uint16_t*>(kFirst + 4);
+		}
+
 		// (stiffness, multiplier, compressionLimit, stretchLimit)
 		T4f config = load(&cIt->mStiffness);
 		// stiffness specified as fraction of constraint error per-millisecond
@@ -647,28 +1162,81 @@ void cloth::SwSolverKernel<T4f>::solveFabric()
 
 		int neutralMultiplier = allEqual(sMaskYZW & stiffness, gSimd4fZero);
 
-#if NV_AVX
-		switch(sAvxSupport)
+		// compliant phases need the constraint multipliers, the other variants skip this branch
+		if ((Features & eCompliantConstraints) && cIt->mCompliance >= 0.0f)
 		{
-		case 2:
-#if _MSC_VER >= 1700
-			neutralMultiplier ? avx::solveConstraints<false, 2>(pIt, rIt, stIt, rEnd, iIt, stiffness, stiffnessExponent)
-			                  : avx::solveConstraints<true, 2>(pIt, rIt, stIt, rEnd, iIt, stiffness, stiffnessExponent);
-			break;
-#endif
-		case 1:
-			neutralMultiplier ? avx::solveConstraints<false, 1>(pIt, rIt, stIt, rEnd, iIt, stiffness, stiffnessExponent)
-			                  : avx::solveConstraints<true, 1>(pIt, rIt, stIt, rEnd, iIt, stiffness, stiffnessExponent);
-			break;
-		default:
-#endif
-			neutralMultiplier ? solveConstraints<false>(pIt, rIt, stIt, rEnd, iIt, stiffness, stiffnessExponent)
-			                  : solveConstraints<true>(pIt, rIt, stIt, rEnd, iIt, stiffness, stiffnessExponent);
-#if NV_AVX
-			break;
+			NV_CLOTH_ASSERT(mClothData.mConstraintMultipliers);
+			const float* ctIt = ctBegin ? ctBegin + sIt[0] : nullptr;
+			float* lIt = mClothData.mConstraintMultipliers + sIt[0];
+			T4f compliance = simd4f(cIt->mCompliance);
+			T4f residual = gSimd4fZero;
+			if (phaseResiduals)
+			{
+				neutralMultiplier ? solveCompliantConstraints<false, true>(pIt, rIt, ctIt, rEnd, iIt, lIt, scales,
+				                                                           stiffness, compliance, invSqrIterDt, residual)
+				                  : solveCompliantConstraints<true, true>(pIt, rIt, ctIt, rEnd, iIt, lIt, scales,
+				                                                          stiffness, compliance, invSqrIterDt, residual);
+
+				const float* r = array(residual);
+				float phaseResidual = r[0] + r[1] + r[2] + r[3];
+				totalResidual += phaseResidual;
+				if (rEnd != rIt)
+					phaseResiduals[cIt->mPhaseIndex] = phaseResidual / float(rEnd - rIt);
+			}
+			else
+			{
+				neutralMultiplier ? solveCompliantConstraints<false, false>(pIt, rIt, ctIt, rEnd, iIt, lIt, scales,
+				                                                            stiffness, compliance, invSqrIterDt, residual)
+				                  : solveCompliantConstraints<true, false>(pIt, rIt, ctIt, rEnd, iIt, lIt, scales,
+				                                                           stiffness, compliance, invSqrIterDt, residual);
+			}
+			continue;
+		}
+
+		// over-relax the uniform stiffness directly, per constraint stiffness needs the generic path
+		float relaxation = chebyshevRelaxation(cIt->mOverRelaxation, iteration);
+		stiffness = select(sMaskX, stiffness * simd4f(relaxation), stiffness);
+
+		if (phaseResiduals || (stIt && relaxation > 1.0f))
+		{
+			T4f relaxationPerConstraint = simd4f(relaxation);
+			T4f residual = gSimd4fZero;
+			if (phaseResiduals)
+			{
+				neutralMultiplier ? solveConstraints<false, true>(pIt, kIt, kstIt, kEnd, kiIt, recordSize, scales,
+				                                                  stiffness, stiffnessExponent, relaxationPerConstraint, residual)
+				                  : solveConstraints<true, true>(pIt, kIt, kstIt, kEnd, kiIt, recordSize, scales,
+				                                                 stiffness, stiffnessExponent, relaxationPerConstraint, residual);
+
+				const float* r = array(residual);
+				float phaseResidual = r[0] + r[1] + r[2] + r[3];
+				totalResidual += phaseResidual;
+				if (rEnd != rIt)
+					phaseResiduals[cIt->mPhaseIndex] = phaseResidual / float(rEnd - rIt);
+			}
+			else
+			{
+				neutralMultiplier ? solveConstraints<false, false>(pIt, kIt, kstIt, kEnd, kiIt, recordSize, scales,
+				                                                   stiffness, stiffnessExponent, relaxationPerConstraint, residual)
+				                  : solveConstraints<true, false>(pIt, kIt, kstIt, kEnd, kiIt, recordSize, scales,
+				                                                  stiffness, stiffnessExponent, relaxationPerConstraint, residual);
+			}
+			continue;
 		}
+
+#if NV_AVX
+		if (neutralMultiplier ? solveConstraintsAvx<false>(pIt, rIt, stIt, rEnd, iIt, stiffness, stiffnessExponent)
+		                      : solveConstraintsAvx<true>(pIt, rIt, stIt, rEnd, iIt, stiffness, stiffnessExponent))
+			continue;
 #endif
+		neutralMultiplier ? solveConstraints<false>(pIt, kIt, kstIt, kEnd, kiIt, recordSize, scales, stiffness,
+		                                            stiffnessExponent)
+		                  : solveConstraints<true>(pIt, kIt, kstIt, kEnd, kiIt, recordSize, scales, stiffness,
+		                                           stiffnessExponent);
 	}
+
+	if (phaseResiduals)
+		mClothData.mResidual = totalConstraints ? totalResidual / float(totalConstraints) : 0.0f;
 }
 
 template <typename T4f>
@@ -705,31 +1273,26 @@ void cloth::SwSolverKernel<T4f>::constrainMotion()
 
 	NV_CLOTH_PROFILE_ZONE("cloth::SwSolverKernel::constrainMotion", /*ProfileContext::None*/ 0);
 
-	T4f* curIt = reinterpret_cast<T4f*>(mClothData.mCurParticles);
-	T4f* curEnd = curIt + mClothData.mNumParticles;
+	if (mClothData.mMotionConstraintIndices)
+		constrainSparseMotion();
+	else
+		constrainMotion(0, mClothData.mNumParticles);
+}
 
-	const T4f* startIt = reinterpret_cast<const T4f*>(mClothData.mStartMotionConstraints);
-	const T4f* targetIt = reinterpret_cast<const T4f*>(mClothData.mTargetMotionConstraints);
+template <typename T4f>
+void cloth::SwSolverKernel<T4f>::constrainMotion(uint32_t first, uint32_t last)
+{
+	if (!mClothData.mStartMotionConstraints)
+		return;
 
 	T4f scaleBias = load(&mCloth.mMotionConstraintScale);
 	T4f stiffness = simd4f(mClothData.mMotionConstraintStiffness);
-	T4f scaleBiasStiffness = select(sMaskXYZ, scaleBias, stiffness);
+	MotionConstraintPass<T4f> pass(reinterpret_cast<T4f*>(mClothData.mCurParticles), nullptr,
+	                               select(sMaskXYZ, scaleBias, stiffness));
 
-	if (!mClothData.mTargetMotionConstraints)
-	{
-		// no interpolation, use the start positions
-		return ::constrainMotion(curIt, curEnd, startIt, scaleBiasStiffness);
-	}
-
-	if (mState.mRemainingIterations == 1)
-	{
-		// use the target positions on last iteration
-		return ::constrainMotion(curIt, curEnd, targetIt, scaleBiasStiffness);
-	}
-
-	// otherwise use an interpolating iterator
-	LerpIterator<T4f, const T4f*> interpolator(startIt, targetIt, mState.getCurrentAlpha());
-	::constrainMotion(curIt, curEnd, interpolator, scaleBiasStiffness);
+	::constrainParticles(pass, first, last, mClothData.mStartMotionConstraints, mClothData.mTargetMotionConstraints,
+	                     mClothData.mMotionConstraintStride, mClothData.mNumMotionConstraints,
+	                     mCloth.mMotionConstraints.mBuffer != nullptr, mState);
 }
 
 template <typename T4f>
@@ -740,34 +1303,88 @@ void cloth::SwSolverKernel<T4f>::constrainSeparation()
 
 	NV_CLOTH_PROFILE_ZONE("cloth::SwSolverKernel::constrainSeparation", /*ProfileContext::None*/ 0);
 
-	T4f* curIt = reinterpret_cast<T4f*>(mClothData.mCurParticles);
-	T4f* curEnd = curIt + mClothData.mNumParticles;
+	if (mClothData.mSeparationConstraintIndices)
+		constrainSparseSeparation();
+	else
+		constrainSeparation(0, mClothData.mNumParticles);
+}
+
+template <typename T4f>
+void cloth::SwSolverKernel<T4f>::constrainSeparation(uint32_t first, uint32_t last)
+{
+	SeparationConstraintPass<T4f> pass(reinterpret_cast<T4f*>(mClothData.mCurParticles), nullptr);
+
+	::constrainParticles(pass, first, last, mClothData.mStartSeparationConstraints,
+	                     mClothData.mTargetSeparationConstraints, mClothData.mSeparationConstraintStride,
+	                     mClothData.mNumSeparationConstraints, mCloth.mSeparationConstraints.mBuffer != nullptr, mState);
+}
+
+// only visits the particles listed in the constraint indices
+template <typename T4f>
+void cloth::SwSolverKernel<T4f>::constrainSparseMotion()
+{
+	T4f scaleBias = load(&mCloth.mMotionConstraintScale);
+	T4f stiffness = simd4f(mClothData.mMotionConstraintStiffness);
+	MotionConstraintPass<T4f> pass(reinterpret_cast<T4f*>(mClothData.mCurParticles),
+	                               mClothData.mMotionConstraintIndices, select(sMaskXYZ, scaleBias, stiffness));
+
+	::constrainParticles(pass, 0, mClothData.mNumMotionConstraintIndices, mClothData.mStartMotionConstraints,
+	                     mClothData.mTargetMotionConstraints, mClothData.mMotionConstraintStride,
+	                     mClothData.mNumMotionConstraints, mCloth.mMotionConstraints.mBuffer != nullptr, mState);
+}
+
+template <typename T4f>
+void cloth::SwSolverKernel<T4f>::constrainSparseSeparation()
+{
+	SeparationConstraintPass<T4f> pass(reinterpret_cast<T4f*>(mClothData.mCurParticles),
+	                                   mClothData.mSeparationConstraintIndices);
+
+	::constrainParticles(pass, 0, mClothData.mNumSeparationConstraintIndices, mClothData.mStartSeparationConstraints,
+	                     mClothData.mTargetSeparationConstraints, mClothData.mSeparationConstraintStride,
+	                     mClothData.mNumSeparationConstraints, mCloth.mSeparationConstraints.mBuffer != nullptr, mState);
+}
 
-	const T4f* startIt = reinterpret_cast<const T4f*>(mClothData.mStartSeparationConstraints);
-	const T4f* targetIt = reinterpret_cast<const T4f*>(mClothData.mTargetSeparationConstraints);
+// integration and motion constraints run back to back on batches of particles that stay in cache
+template <typename T4f>
+void cloth::SwSolverKernel<T4f>::integrateAndConstrainMotion()
+{
+	NV_CLOTH_PROFILE_ZONE("cloth::SwSolverKernel::integrateAndConstrainMotion", /*ProfileContext::None*/ 0);
 
-	if (!mClothData.mTargetSeparationConstraints)
+	uint32_t numParticles = mClothData.mNumParticles;
+	for (uint32_t first = 0; first < numParticles; first += sParticleBatchSize)
 	{
-		// no interpolation, use the start positions
-		return ::constrainSeparation(curIt, curEnd, startIt);
+		uint32_t last = std::min(first + sParticleBatchSize, numParticles);
+		integrateParticles(first, last);
+		constrainMotion(first, last);
 	}
+}
+
+// separation constraints and the particle pass of SwCollision::computeBounds(), batched like above
+template <typename T4f>
+void cloth::SwSolverKernel<T4f>::constrainSeparationAndComputeBounds()
+{
+	NV_CLOTH_PROFILE_ZONE("cloth::SwSolverKernel::constrainSeparationAndComputeBounds", /*ProfileContext::None*/ 0);
 
-	if (mState.mRemainingIterations == 1)
+	uint32_t numParticles = mClothData.mNumParticles;
+	for (uint32_t first = 0; first < numParticles; first += sParticleBatchSize)
 	{
-		// use the target positions on last iteration
-		return ::constrainSeparation(curIt, curEnd, targetIt);
+		uint32_t last = std::min(first + sParticleBatchSize, numParticles);
+		constrainSeparation(first, last);
+		mCollision.accumulateBounds(first, last);
 	}
-	// otherwise use an interpolating iterator
-	LerpIterator<T4f, const T4f*> interpolator(startIt, targetIt, mState.getCurrentAlpha());
-	::constrainSeparation(curIt, curEnd, interpolator);
 }
 
 template <typename T4f>
+template <uint32_t Features>
 void cloth::SwSolverKernel<T4f>::collideParticles()
 {
 	NV_CLOTH_PROFILE_ZONE("cloth::SwSolverKernel::collideParticles", /*ProfileContext::None*/ 0);
 
-	mCollision(mState);
+	typedef SwCollision<T4f> Collision;
+	mCollision.template collide<(Features & eSpheres ? uint32_t(Collision::eSpheres) : 0u) |
+	                            (Features & eConvexes ? uint32_t(Collision::eConvexes) : 0u) |
+	                            (Features & eTriangles ? uint32_t(Collision::eTriangles) : 0u) |
+	                            (Features & eFields ? uint32_t(Collision::eFields) : 0u)>(mState);
 }
 
 template <typename T4f>
@@ -803,6 +1420,34 @@ void cloth::SwSolverKernel<T4f>::updateSleepState()
 }
 
 template <typename T4f>
+uint32_t cloth::SwSolverKernel<T4f>::getFeatures() const
+{
+	uint32_t features = 0;
+	if (mClothData.mDragCoefficient != 0.0f || mClothData.mLiftCoefficient != 0.0f)
+		features |= eWind;
+	if (mClothData.mStartMotionConstraints)
+		features |= eMotionConstraints;
+	if (0.0f != mClothData.mTetherConstraintStiffness && mClothData.mNumTethers)
+		features |= eTethers;
+	if (mClothData.mStartSeparationConstraints)
+		features |= eSeparationConstraints;
+	if (std::min(mClothData.mSelfCollisionDistance, mClothData.mSelfCollisionStiffness) > 0.0f)
+		features |= eSelfCollision;
+	if (mClothData.mConstraintMultipliers)
+		features |= eCompliantConstraints;
+	if (mClothData.mNumSpheres)
+		features |= eSpheres;
+	if (mClothData.mNumConvexes)
+		features |= eConvexes;
+	if (mClothData.mNumCollisionTriangles)
+		features |= eTriangles;
+	if (mClothData.mNumSignedDistanceFields || mClothData.mNumHeightFields)
+		features |= eFields;
+	return features;
+}
+
+template <typename T4f>
+template <uint32_t Features>
 void cloth::SwSolverKernel<T4f>::iterateCloth()
 {
 	// note on invMass (stored in current/previous positions.w):
@@ -818,44 +1463,90 @@ void cloth::SwSolverKernel<T4f>::iterateCloth()
 	//   - previous.w: original invMass as set by user
 	//   - current.w: zeroed by motion constraints and mass-scaled by collision
 
-	// integrate positions
-	integrateParticles();
+	// passes not in Features are compiled out, the others still check at runtime
+	// so that a variant can run any subset of its features
+	if (!(Features & eMotionConstraints))
+	{
+		// integrate positions
+		integrateParticles();
+
+		// apply drag and lift
+		if (Features & eWind)
+			applyWind();
+	}
+	else if ((!(Features & eWind) || (mClothData.mDragCoefficient == 0.0f && mClothData.mLiftCoefficient == 0.0f)) &&
+	         !mClothData.mMotionConstraintIndices)
+	{
+		// integrate positions and apply motion constraints in one pass
+		integrateAndConstrainMotion();
+	}
+	else
+	{
+		// integrate positions
+		integrateParticles();
 
-	// apply drag and lift
-	applyWind();
+		// apply drag and lift
+		if (Features & eWind)
+			applyWind();
 
-	// motion constraints
-	constrainMotion();
+		// motion constraints, sparse ones only touch a few particles and are not worth fusing
+		constrainMotion();
+	}
 
 	// solve tether constraints
-	constrainTether();
+	if (Features & eTethers)
+		constrainTether();
 
 	// solve edge constraints
-	solveFabric();
+	solveFabric<Features>();
 
-	// separation constraints
-	constrainSeparation();
+	// separation constraints, in one pass with the collision bounds if nothing collides before them
+	if (Features & eSeparationConstraints)
+	{
+		if (mClothData.mStartSeparationConstraints && !mClothData.mSeparationConstraintIndices && mCollision.fuseBounds())
+			constrainSeparationAndComputeBounds();
+		else
+			constrainSeparation();
+	}
 
 	// perform character collision
-	collideParticles();
+	collideParticles<Features>();
 
 	// perform self collision
-	selfCollideParticles();
+	if (Features & eSelfCollision)
+		selfCollideParticles();
 
 	// test wake / sleep conditions
 	updateSleepState();
 }
 
 template <typename T4f>
+template <uint32_t Features>
 void cloth::SwSolverKernel<T4f>::simulateCloth()
 {
 	while (mState.mRemainingIterations)
 	{
-		iterateCloth();
+		iterateCloth<Features>();
+		mClothData.mCompressedPrevParticles = nullptr; // decoded by the first integration
 		mState.update();
 	}
 }
 
+template <typename T4f>
+void cloth::SwSolverKernel<T4f>::simulateCloth()
+{
+	// pick the variant once per frame, the common feature combinations get their own
+	uint32_t features = getFeatures();
+	if (!features)
+		simulateCloth<0>(); // integrate and fabric only
+	else if (features == eSpheres)
+		simulateCloth<eSpheres>(); // integrate, fabric and capsules
+	else if (!(features & ~uint32_t(eMotionConstraints | eTethers | eSpheres)))
+		simulateCloth<eMotionConstraints | eTethers | eSpheres>(); // skinned cloth
+	else
+		simulateCloth<eAllFeatures>();
+}
+
 // explicit template instantiation
 #if NV_SIMD_SIMD
 template class cloth::SwSolverKernel<Simd4f>;
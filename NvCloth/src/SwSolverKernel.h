@@ -55,16 +55,52 @@ class SwSolverKernel
 
   private:
 	void integrateParticles();
+	void integrateParticles(uint32_t first, uint32_t last);
 	void constrainTether();
+	template <typename TetherType>
+	void constrainTether(const TetherType*);
+	template <uint32_t Features>
 	void solveFabric();
+	template <uint32_t Features, typename RestvalueType, typename StiffnessType>
+	void solveFabric(const RestvalueType*, const StiffnessType*);
 	void applyWind();
 	void constrainMotion();
+	void constrainMotion(uint32_t first, uint32_t last);
 	void constrainSeparation();
+	void constrainSeparation(uint32_t first, uint32_t last);
+	void constrainSparseMotion();
+	void constrainSparseSeparation();
+
+	// particle local passes fused into one sweep over the particles
+	void integrateAndConstrainMotion();
+	void constrainSeparationAndComputeBounds();
+	template <uint32_t Features>
 	void collideParticles();
 	void selfCollideParticles();
 	void updateSleepState();
 
+	// optional passes of iterateCloth(), which is specialized for common combinations
+	enum
+	{
+		eWind = 1 << 0,
+		eMotionConstraints = 1 << 1,
+		eTethers = 1 << 2,
+		eSeparationConstraints = 1 << 3,
+		eSelfCollision = 1 << 4,
+		eCompliantConstraints = 1 << 5,
+		eSpheres = 1 << 6, // spheres and capsules
+		eConvexes = 1 << 7,
+		eTriangles = 1 << 8,
+		eFields = 1 << 9, // signed distance and height fields
+		eAllFeatures = (1 << 10) - 1
+	};
+
+	uint32_t getFeatures() const;
+
+	template <uint32_t Features>
 	void iterateCloth();
+	template <uint32_t Features>
+	void simulateCloth();
 	void simulateCloth();
 
 	SwCloth const& mCloth;
@@ -78,7 +114,7 @@ class SwSolverKernel
   private:
 	SwSolverKernel<T4f>& operator = (const SwSolverKernel<T4f>&);
 	template <typename AccelerationIterator>
-	void integrateParticles(AccelerationIterator& accelIt, const T4f&);
+	void integrateParticles(AccelerationIterator& accelIt, const T4f&, uint32_t first, uint32_t last);
 };
 
 //explicit template instantiation declaration
@@ -384,6 +384,157 @@ void CuCloth::setPhaseConfig(Range<const PhaseConfig> configs)
 	wakeUp();
 }
 
+// compliant constraints are not supported by the GPU solvers
+void CuCloth::setConstraintCompliances(Range<const float>)
+{
+}
+
+uint32_t CuCloth::getNumConstraintCompliances() const
+{
+	return 0;
+}
+
+void CuCloth::getConstraintMultipliers(Range<float> multipliers) const
+{
+	for (; !multipliers.empty(); multipliers.popFront())
+		multipliers.front() = 0.0f;
+}
+
+// signed distance field, height field and shared shape set collision is not supported by the GPU solvers
+void CuCloth::setSignedDistanceFields(Range<const SignedDistanceField* const>, Range<const physx::PxTransform>)
+{
+}
+
+uint32_t CuCloth::getNumSignedDistanceFields() const
+{
+	return 0;
+}
+
+void CuCloth::setHeightFields(Range<const HeightField* const>, Range<const physx::PxTransform>)
+{
+}
+
+uint32_t CuCloth::getNumHeightFields() const
+{
+	return 0;
+}
+
+void CuCloth::setCollisionShapeSet(const CollisionShapeSet*, uint32_t)
+{
+}
+
+const CollisionShapeSet* CuCloth::getCollisionShapeSet() const
+{
+	return nullptr;
+}
+
+uint32_t CuCloth::getCollisionShapeSetMask() const
+{
+	return 0xffffffff;
+}
+
+// bone driven collision spheres are not supported by the GPU solvers
+void CuCloth::setBoneSpheres(Range<const physx::PxVec4>, Range<const uint32_t>)
+{
+}
+
+uint32_t CuCloth::getNumBoneSpheres() const
+{
+	return 0;
+}
+
+void CuCloth::setBoneTransforms(Range<const physx::PxMat44>)
+{
+}
+
+uint32_t CuCloth::getNumBoneTransforms() const
+{
+	return 0;
+}
+
+// per particle collision masks are not supported by the GPU solvers
+void CuCloth::setParticleCollisionMasks(Range<const uint32_t>)
+{
+}
+
+uint32_t CuCloth::getNumParticleCollisionMasks() const
+{
+	return 0;
+}
+
+// sparse motion and separation constraints are not supported by the GPU solvers
+void CuCloth::setMotionConstraintIndices(Range<const uint32_t>)
+{
+}
+
+uint32_t CuCloth::getNumMotionConstraintIndices() const
+{
+	return 0;
+}
+
+void CuCloth::setSeparationConstraintIndices(Range<const uint32_t>)
+{
+}
+
+uint32_t CuCloth::getNumSeparationConstraintIndices() const
+{
+	return 0;
+}
+
+// caller owned input buffers are not supported by the GPU solvers
+void CuCloth::setMotionConstraintBuffer(const ParticleDataBuffer*)
+{
+}
+
+const ParticleDataBuffer* CuCloth::getMotionConstraintBuffer() const
+{
+	return nullptr;
+}
+
+void CuCloth::setSeparationConstraintBuffer(const ParticleDataBuffer*)
+{
+}
+
+const ParticleDataBuffer* CuCloth::getSeparationConstraintBuffer() const
+{
+	return nullptr;
+}
+
+void CuCloth::setParticleAccelerationBuffer(const ParticleDataBuffer*)
+{
+}
+
+const ParticleDataBuffer* CuCloth::getParticleAccelerationBuffer() const
+{
+	return nullptr;
+}
+
+// particle history compression is not supported by the GPU solvers
+void CuCloth::enableParticleHistoryCompression(bool)
+{
+}
+
+bool CuCloth::isParticleHistoryCompressionEnabled() const
+{
+	return false;
+}
+
+// cloth state snapshots are not supported by the GPU solvers
+uint32_t CuCloth::getStateSize() const
+{
+	return 0;
+}
+
+uint32_t CuCloth::saveState(Range<uint8_t>, Range<const uint8_t>) const
+{
+	return 0;
+}
+
+bool CuCloth::loadState(Range<const uint8_t>, Range<const uint8_t>)
+{
+	return false;
+}
+
 void CuCloth::setSelfCollisionIndices(Range<const uint32_t> indices)
 {
 	ContextLockType lock(mFactory);
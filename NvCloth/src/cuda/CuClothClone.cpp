@@ -55,6 +55,14 @@ Range<const uint32_t> getSelfCollisionIndices(const CuCloth& cloth)
 {
 	return makeRange(cloth.mSelfCollisionIndicesHost);
 }
+Range<const uint32_t> getMotionConstraintIndices(const CuCloth&)
+{
+	return Range<const uint32_t>();
+}
+Range<const uint32_t> getSeparationConstraintIndices(const CuCloth&)
+{
+	return Range<const uint32_t>();
+}
 
 Cloth* CuCloth::clone(Factory& factory) const
 {
@@ -208,3 +208,25 @@ void cloth::CuFabric::scaleTetherLengths(float scale)
 	// cloth instances won't pick this up until CuClothData is dirty!
 	mTetherLengthScale *= scale;
 }
+
+bool cloth::CuFabric::quantize()
+{
+	// device fabrics keep full precision
+	return false;
+}
+
+bool cloth::CuFabric::isQuantized() const
+{
+	return false;
+}
+
+bool cloth::CuFabric::packConstraints()
+{
+	// device fabrics have their own layout
+	return false;
+}
+
+bool cloth::CuFabric::hasPackedConstraints() const
+{
+	return false;
+}
@@ -77,6 +77,12 @@ class CuFabric : private CuContextLock, public Fabric
 	virtual void scaleRestvalues(float);
 	virtual void scaleTetherLengths(float);
 
+	virtual bool quantize();
+	virtual bool isQuantized() const;
+
+	virtual bool packConstraints();
+	virtual bool hasPackedConstraints() const;
+
 public:
 	CuFactory& mFactory;
 
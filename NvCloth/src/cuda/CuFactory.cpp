@@ -159,6 +159,22 @@ cloth::Cloth* cloth::CuFactory::createCloth(Range<const PxVec4> particles, Fabri
 	return NV_CLOTH_NEW(CuCloth)(*this, static_cast<CuFabric&>(fabric), particles);
 }
 
+// the device allocations dominate, cloths are created one by one
+void cloth::CuFactory::createCloths(Range<Cloth*> cloths, Range<const PxVec4> particles, Fabric& fabric)
+{
+	uint32_t numParticles = fabric.getNumParticles();
+	NV_CLOTH_ASSERT(particles.size() == cloths.size() * numParticles);
+
+	for (uint32_t i = 0; i < cloths.size(); ++i)
+		cloths[i] = createCloth(Range<const PxVec4>(particles.begin() + i * numParticles, particles.begin() + (i + 1) * numParticles), fabric);
+}
+
+void cloth::CuFactory::destroyCloths(Range<Cloth* const> cloths)
+{
+	for (; !cloths.empty(); cloths.popFront())
+		NV_CLOTH_DELETE(cloths.front());
+}
+
 cloth::Solver* cloth::CuFactory::createSolver()
 {
 	CuSolver* solver = NV_CLOTH_NEW(CuSolver)(*this);
@@ -402,6 +402,157 @@ void DxCloth::setPhaseConfig(Range<const PhaseConfig> configs)
 	wakeUp();
 }
 
+// compliant constraints are not supported by the GPU solvers
+void DxCloth::setConstraintCompliances(Range<const float>)
+{
+}
+
+uint32_t DxCloth::getNumConstraintCompliances() const
+{
+	return 0;
+}
+
+void DxCloth::getConstraintMultipliers(Range<float> multipliers) const
+{
+	for (; !multipliers.empty(); multipliers.popFront())
+		multipliers.front() = 0.0f;
+}
+
+// signed distance field, height field and shared shape set collision is not supported by the GPU solvers
+void DxCloth::setSignedDistanceFields(Range<const SignedDistanceField* const>, Range<const physx::PxTransform>)
+{
+}
+
+uint32_t DxCloth::getNumSignedDistanceFields() const
+{
+	return 0;
+}
+
+void DxCloth::setHeightFields(Range<const HeightField* const>, Range<const physx::PxTransform>)
+{
+}
+
+uint32_t DxCloth::getNumHeightFields() const
+{
+	return 0;
+}
+
+void DxCloth::setCollisionShapeSet(const CollisionShapeSet*, uint32_t)
+{
+}
+
+const CollisionShapeSet* DxCloth::getCollisionShapeSet() const
+{
+	return nullptr;
+}
+
+uint32_t DxCloth::getCollisionShapeSetMask() const
+{
+	return 0xffffffff;
+}
+
+// bone driven collision spheres are not supported by the GPU solvers
+void DxCloth::setBoneSpheres(Range<const physx::PxVec4>, Range<const uint32_t>)
+{
+}
+
+uint32_t DxCloth::getNumBoneSpheres() const
+{
+	return 0;
+}
+
+void DxCloth::setBoneTransforms(Range<const physx::PxMat44>)
+{
+}
+
+uint32_t DxCloth::getNumBoneTransforms() const
+{
+	return 0;
+}
+
+// per particle collision masks are not supported by the GPU solvers
+void DxCloth::setParticleCollisionMasks(Range<const uint32_t>)
+{
+}
+
+uint32_t DxCloth::getNumParticleCollisionMasks() const
+{
+	return 0;
+}
+
+// sparse motion and separation constraints are not supported by the GPU solvers
+void DxCloth::setMotionConstraintIndices(Range<const uint32_t>)
+{
+}
+
+uint32_t DxCloth::getNumMotionConstraintIndices() const
+{
+	return 0;
+}
+
+void DxCloth::setSeparationConstraintIndices(Range<const uint32_t>)
+{
+}
+
+uint32_t DxCloth::getNumSeparationConstraintIndices() const
+{
+	return 0;
+}
+
+// caller owned input buffers are not supported by the GPU solvers
+void DxCloth::setMotionConstraintBuffer(const ParticleDataBuffer*)
+{
+}
+
+const ParticleDataBuffer* DxCloth::getMotionConstraintBuffer() const
+{
+	return nullptr;
+}
+
+void DxCloth::setSeparationConstraintBuffer(const ParticleDataBuffer*)
+{
+}
+
+const ParticleDataBuffer* DxCloth::getSeparationConstraintBuffer() const
+{
+	return nullptr;
+}
+
+void DxCloth::setParticleAccelerationBuffer(const ParticleDataBuffer*)
+{
+}
+
+const ParticleDataBuffer* DxCloth::getParticleAccelerationBuffer() const
+{
+	return nullptr;
+}
+
+// particle history compression is not supported by the GPU solvers
+void DxCloth::enableParticleHistoryCompression(bool)
+{
+}
+
+bool DxCloth::isParticleHistoryCompressionEnabled() const
+{
+	return false;
+}
+
+// cloth state snapshots are not supported by the GPU solvers
+uint32_t DxCloth::getStateSize() const
+{
+	return 0;
+}
+
+uint32_t DxCloth::saveState(Range<uint8_t>, Range<const uint8_t>) const
+{
+	return 0;
+}
+
+bool DxCloth::loadState(Range<const uint8_t>, Range<const uint8_t>)
+{
+	return false;
+}
+
 void DxCloth::setSelfCollisionIndices(Range<const uint32_t> indices)
 {
 	ContextLockType lock(mFactory);
@@ -113,8 +113,39 @@ class DxCloth : protected DxContextLock, public ClothImpl<DxCloth>
 	MappedRange<physx::PxVec4> getPreviousParticles();
 	MappedRange<const physx::PxVec4> getPreviousParticles() const;
 	GpuParticles getGpuParticles();
+	void enableParticleHistoryCompression(bool enable);
+	bool isParticleHistoryCompressionEnabled() const;
+	uint32_t getStateSize() const;
+	uint32_t saveState(Range<uint8_t> buffer, Range<const uint8_t> reference) const;
+	bool loadState(Range<const uint8_t> buffer, Range<const uint8_t> reference);
 
 	void setPhaseConfig(Range<const PhaseConfig> configs);
+	void setConstraintCompliances(Range<const float> compliances);
+	uint32_t getNumConstraintCompliances() const;
+	void getConstraintMultipliers(Range<float> multipliers) const;
+	void setSignedDistanceFields(Range<const SignedDistanceField* const> fields, Range<const physx::PxTransform> poses);
+	uint32_t getNumSignedDistanceFields() const;
+	void setHeightFields(Range<const HeightField* const> heightFields, Range<const physx::PxTransform> poses);
+	uint32_t getNumHeightFields() const;
+	void setCollisionShapeSet(const CollisionShapeSet* shapeSet, uint32_t sphereMask);
+	const CollisionShapeSet* getCollisionShapeSet() const;
+	uint32_t getCollisionShapeSetMask() const;
+	void setBoneSpheres(Range<const physx::PxVec4> localSpheres, Range<const uint32_t> boneIndices);
+	uint32_t getNumBoneSpheres() const;
+	void setBoneTransforms(Range<const physx::PxMat44> transforms);
+	uint32_t getNumBoneTransforms() const;
+	void setParticleCollisionMasks(Range<const uint32_t> masks);
+	uint32_t getNumParticleCollisionMasks() const;
+	void setMotionConstraintIndices(Range<const uint32_t> indices);
+	uint32_t getNumMotionConstraintIndices() const;
+	void setSeparationConstraintIndices(Range<const uint32_t> indices);
+	uint32_t getNumSeparationConstraintIndices() const;
+	void setMotionConstraintBuffer(const ParticleDataBuffer* buffer);
+	const ParticleDataBuffer* getMotionConstraintBuffer() const;
+	void setSeparationConstraintBuffer(const ParticleDataBuffer* buffer);
+	const ParticleDataBuffer* getSeparationConstraintBuffer() const;
+	void setParticleAccelerationBuffer(const ParticleDataBuffer* buffer);
+	const ParticleDataBuffer* getParticleAccelerationBuffer() const;
 	void setSelfCollisionIndices(Range<const uint32_t> indices);
 	uint32_t getNumVirtualParticles() const;
 	Range<physx::PxVec4> getParticleAccelerations();
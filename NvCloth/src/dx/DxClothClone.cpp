@@ -57,6 +57,14 @@ Range<const uint32_t> getSelfCollisionIndices(const DxCloth& cloth)
 {
 	return makeRange(cloth.mSelfCollisionIndicesHost);
 }
+Range<const uint32_t> getMotionConstraintIndices(const DxCloth&)
+{
+	return Range<const uint32_t>();
+}
+Range<const uint32_t> getSeparationConstraintIndices(const DxCloth&)
+{
+	return Range<const uint32_t>();
+}
 
 Cloth* DxCloth::clone(Factory& factory) const
 {
@@ -217,4 +217,26 @@ void cloth::DxFabric::scaleTetherLengths(float scale)
 	mTetherLengthScale *= scale;
 }
 
+bool cloth::DxFabric::quantize()
+{
+	// device fabrics keep full precision
+	return false;
+}
+
+bool cloth::DxFabric::isQuantized() const
+{
+	return false;
+}
+
+bool cloth::DxFabric::packConstraints()
+{
+	// device fabrics have their own layout
+	return false;
+}
+
+bool cloth::DxFabric::hasPackedConstraints() const
+{
+	return false;
+}
+
 #endif // NV_CLOTH_ENABLE_DX11
@@ -70,6 +70,12 @@ class DxFabric : private DxContextLock, public Fabric
 	virtual void scaleRestvalues(float);
 	virtual void scaleTetherLengths(float);
 
+	virtual bool quantize();
+	virtual bool isQuantized() const;
+
+	virtual bool packConstraints();
+	virtual bool hasPackedConstraints() const;
+
 public:
 	DxFactory& mFactory;
 
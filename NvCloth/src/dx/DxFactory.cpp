@@ -144,6 +144,22 @@ cloth::Cloth* cloth::DxFactory::createCloth(Range<const PxVec4> particles, Fabri
 	return NV_CLOTH_NEW(DxCloth)(*this, static_cast<DxFabric&>(fabric), particles);
 }
 
+// the device allocations dominate, cloths are created one by one
+void cloth::DxFactory::createCloths(Range<Cloth*> cloths, Range<const PxVec4> particles, Fabric& fabric)
+{
+	uint32_t numParticles = fabric.getNumParticles();
+	NV_CLOTH_ASSERT(particles.size() == cloths.size() * numParticles);
+
+	for (uint32_t i = 0; i < cloths.size(); ++i)
+		cloths[i] = createCloth(Range<const PxVec4>(particles.begin() + i * numParticles, particles.begin() + (i + 1) * numParticles), fabric);
+}
+
+void cloth::DxFactory::destroyCloths(Range<Cloth* const> cloths)
+{
+	for (; !cloths.empty(); cloths.popFront())
+		NV_CLOTH_DELETE(cloths.front());
+}
+
 cloth::Solver* cloth::DxFactory::createSolver()
 {
 	CompileComputeShaders(); //Make sure our compute shaders are ready
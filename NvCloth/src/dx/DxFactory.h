@@ -78,6 +78,10 @@ protected:
 
 	virtual Cloth* createCloth(Range<const physx::PxVec4> particles, Fabric& fabric);
 
+	virtual void createCloths(Range<Cloth*> cloths, Range<const physx::PxVec4> particles, Fabric& fabric);
+
+	virtual void destroyCloths(Range<Cloth* const> cloths);
+
 	virtual Solver* createSolver();
 
 	virtual Cloth* clone(const Cloth& cloth);
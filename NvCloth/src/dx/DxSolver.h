@@ -101,6 +101,26 @@ class DxSolver : private DxContextLock, public Solver
 		mInterCollisionFilter = filter;
 	}
 
+	// the frame time budget is not supported, all cloths are simulated in a single kernel launch
+	virtual void setFrameTimeBudget(float)
+	{
+	}
+	virtual float getFrameTimeBudget() const
+	{
+		return 0.0f;
+	}
+	virtual void setClothBudgetWeight(Cloth*, float)
+	{
+	}
+	virtual float getClothBudgetWeight(const Cloth*) const
+	{
+		return 1.0f;
+	}
+	virtual Range<const BudgetAllocation> getBudgetAllocations() const
+	{
+		return Range<const BudgetAllocation>();
+	}
+
   private:
 	// add cloth helper functions
 	void addClothAppend(Cloth* cloth);